@@ -7,6 +7,8 @@
 
 #include "../dxbc/dxbc_util.h"
 
+constexpr static uint32_t MaxIdleStagingFlushes = 16;
+
 namespace dxvk {
   
   D3D11DeviceContext::D3D11DeviceContext(
@@ -18,6 +20,7 @@ namespace dxvk {
     m_annotation(this),
     m_multithread(this, false),
     m_device    (Device),
+    m_staging   (Device),
     m_csFlags   (CsFlags),
     m_csChunk   (AllocCsChunk()),
     m_cmdData   (nullptr) {
@@ -1172,7 +1175,9 @@ namespace dxvk {
         Map(pDstResource, 0, mapType, 0, &mappedSr);
         std::memcpy(reinterpret_cast<char*>(mappedSr.pData) + offset, pSrcData, size);
         Unmap(pDstResource, 0);
-      } else {
+      } else if ((size <= MaxInlineUpdateSize) && !(size & 0x3) && !(offset & 0x3)) {
+        // Small updates are recorded inline by the
+        // backend, so a staging buffer does not help
         DxvkDataSlice dataSlice = AllocUpdateBufferSlice(size);
         std::memcpy(dataSlice.ptr(), pSrcData, size);
         
@@ -1186,6 +1191,20 @@ namespace dxvk {
             cBufferSlice.length(),
             cDataBuffer.ptr());
         });
+      } else {
+        DxvkBufferSlice stagingSlice = AllocStagingBuffer(size);
+        std::memcpy(stagingSlice.mapPtr(0), pSrcData, size);
+        
+        EmitCs([
+          cStagingSlice = std::move(stagingSlice),
+          cBufferSlice  = bufferSlice.subSlice(offset, size)
+        ] (DxvkContext* ctx) {
+          ctx->updateBuffer(
+            cBufferSlice.buffer(),
+            cBufferSlice.offset(),
+            cBufferSlice.length(),
+            cStagingSlice);
+        });
       }
     } else {
       const D3D11CommonTexture* textureInfo = GetCommonTexture(pDstResource);
@@ -1233,34 +1252,52 @@ namespace dxvk {
       const VkDeviceSize bytesPerLayer = regionExtent.height * bytesPerRow;
       const VkDeviceSize bytesTotal    = regionExtent.depth  * bytesPerLayer;
       
-      DxvkDataSlice imageDataBuffer = AllocUpdateBufferSlice(bytesTotal);
-      
-      util::packImageData(imageDataBuffer.ptr(), pSrcData,
-        regionExtent, formatInfo->elementSize,
-        SrcRowPitch, SrcDepthPitch);
-      
-      EmitCs([
-        cDstImage         = textureInfo->GetImage(),
-        cDstLayers        = layers,
-        cDstOffset        = offset,
-        cDstExtent        = extent,
-        cSrcData          = std::move(imageDataBuffer),
-        cSrcBytesPerRow   = bytesPerRow,
-        cSrcBytesPerLayer = bytesPerLayer,
-        cPackedFormat     = packedFormat
-      ] (DxvkContext* ctx) {
-        if (cDstLayers.aspectMask != (VK_IMAGE_ASPECT_DEPTH_BIT | VK_IMAGE_ASPECT_STENCIL_BIT)) {
-          ctx->updateImage(cDstImage, cDstLayers,
-            cDstOffset, cDstExtent, cSrcData.ptr(),
-            cSrcBytesPerRow, cSrcBytesPerLayer);
-        } else {
+      if (layers.aspectMask != (VK_IMAGE_ASPECT_DEPTH_BIT | VK_IMAGE_ASPECT_STENCIL_BIT)) {
+        // Pack the data straight into a staging buffer so
+        // that the CS thread only needs to record the copy
+        DxvkBufferSlice stagingSlice = AllocStagingBuffer(bytesTotal);
+        
+        util::packImageData(stagingSlice.mapPtr(0), pSrcData,
+          regionExtent, formatInfo->elementSize,
+          SrcRowPitch, SrcDepthPitch);
+        
+        EmitCs([
+          cDstImage         = textureInfo->GetImage(),
+          cDstLayers        = layers,
+          cDstOffset        = offset,
+          cDstExtent        = extent,
+          cStagingSlice     = std::move(stagingSlice)
+        ] (DxvkContext* ctx) {
+          ctx->copyBufferToImage(cDstImage, cDstLayers,
+            cDstOffset, cDstExtent,
+            cStagingSlice.buffer(),
+            cStagingSlice.offset(),
+            VkExtent2D { 0u, 0u });
+        });
+      } else {
+        DxvkDataSlice imageDataBuffer = AllocUpdateBufferSlice(bytesTotal);
+        
+        util::packImageData(imageDataBuffer.ptr(), pSrcData,
+          regionExtent, formatInfo->elementSize,
+          SrcRowPitch, SrcDepthPitch);
+        
+        EmitCs([
+          cDstImage         = textureInfo->GetImage(),
+          cDstLayers        = layers,
+          cDstOffset        = offset,
+          cDstExtent        = extent,
+          cSrcData          = std::move(imageDataBuffer),
+          cSrcBytesPerRow   = bytesPerRow,
+          cSrcBytesPerLayer = bytesPerLayer,
+          cPackedFormat     = packedFormat
+        ] (DxvkContext* ctx) {
           ctx->updateDepthStencilImage(cDstImage, cDstLayers,
             VkOffset2D { cDstOffset.x,     cDstOffset.y      },
             VkExtent2D { cDstExtent.width, cDstExtent.height },
             cSrcData.ptr(), cSrcBytesPerRow, cSrcBytesPerLayer,
             cPackedFormat);
-        }
-      });
+        });
+      }
 
       if (textureInfo->CanUpdateMappedBufferEarly())
         UpdateMappedBuffer(textureInfo, subresource);
@@ -4254,6 +4291,21 @@ namespace dxvk {
   }
   
   
+  DxvkBufferSlice D3D11DeviceContext::AllocStagingBuffer(VkDeviceSize Size) {
+    m_stagingIdleFlushes = 0;
+    return m_staging.alloc(CACHE_LINE_SIZE, Size);
+  }
+  
+  
+  void D3D11DeviceContext::TrimStagingBuffers() {
+    // Release staging memory once the app stopped uploading data
+    // for a while. Buffers still used by pending commands stay
+    // alive until those commands have completed.
+    if (++m_stagingIdleFlushes == MaxIdleStagingFlushes)
+      m_staging.trim();
+  }
+  
+  
   DxvkCsChunkRef D3D11DeviceContext::AllocCsChunk() {
     return m_parent->AllocCsChunk(m_csFlags);
   }
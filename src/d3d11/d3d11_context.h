@@ -709,6 +709,8 @@ namespace dxvk {
     
     Rc<DxvkDevice>              m_device;
     Rc<DxvkDataBuffer>          m_updateBuffer;
+    DxvkStagingDataAlloc        m_staging;
+    uint32_t                    m_stagingIdleFlushes = 0;
     
     DxvkCsChunkFlags            m_csFlags;
     DxvkCsChunkRef              m_csChunk;
@@ -895,6 +897,10 @@ namespace dxvk {
     
     DxvkDataSlice AllocUpdateBufferSlice(size_t Size);
     
+    DxvkBufferSlice AllocStagingBuffer(VkDeviceSize Size);
+    
+    void TrimStagingBuffers();
+    
     DxvkCsChunkRef AllocCsChunk();
     
     static void InitDefaultPrimitiveTopology(
@@ -160,6 +160,7 @@ namespace dxvk {
 
     FinalizeQueries();
     FlushCsChunk();
+    TrimStagingBuffers();
     
     if (ppCommandList != nullptr)
       *ppCommandList = m_commandList.ref();
@@ -271,10 +272,12 @@ namespace dxvk {
     pMapEntry->RowPitch     = pBuffer->Desc()->ByteWidth;
     pMapEntry->DepthPitch   = pBuffer->Desc()->ByteWidth;
     
-    if (likely(pBuffer->Desc()->Usage == D3D11_USAGE_DYNAMIC && m_csFlags.test(DxvkCsChunkFlag::SingleUse))) {
-      // For resources that cannot be written by the GPU,
-      // we may write to the buffer resource directly and
-      // just swap in the buffer slice as needed.
+    if (likely(m_csFlags.test(DxvkCsChunkFlag::SingleUse))) {
+      // The command list is executed exactly once, so we
+      // may write to the buffer resource directly and just
+      // swap in the buffer slice at execution time. This is
+      // also safe for GPU-writable buffers since any GPU
+      // writes before execution get discarded anyway.
       auto bufferSlice = pBuffer->AllocSlice();
       pMapEntry->MapPointer = bufferSlice.mapPtr;
 
@@ -284,9 +287,26 @@ namespace dxvk {
       ] (DxvkContext* ctx) {
         ctx->invalidateBuffer(cDstBuffer, cPhysSlice);
       });
+    } else if (likely(pBuffer->Desc()->Usage == D3D11_USAGE_DYNAMIC)) {
+      // The command list may be executed any number of times,
+      // so the slice is owned by the command and gets swapped
+      // in again on each execution. Since the GPU cannot write
+      // to the buffer, the slice contents will remain intact.
+      auto bufferSlice = pBuffer->AllocSlice();
+      pMapEntry->MapPointer = bufferSlice.mapPtr;
+
+      EmitCs([
+        cSliceRef = DxvkBufferSliceRef(pBuffer->GetBuffer(), bufferSlice)
+      ] (DxvkContext* ctx) {
+        cSliceRef.buffer()->acquireSlice(cSliceRef.handle());
+        ctx->invalidateBuffer(cSliceRef.buffer(), cSliceRef.handle());
+      });
     } else {
-      // For GPU-writable resources, we need a data slice
-      // to perform the update operation at execution time.
+      // GPU-writable resources may be modified between two
+      // executions of the command list, so we need a data
+      // slice that keeps the mapped data intact. D3D11 only
+      // allows discarding dynamic resources on deferred
+      // contexts, so this is only hit by invalid API usage.
       auto dataSlice = AllocUpdateBufferSlice(pBuffer->Desc()->ByteWidth);
       pMapEntry->MapPointer = dataSlice.ptr();
 
@@ -164,6 +164,7 @@ namespace dxvk {
       });
       
       FlushCsChunk();
+      TrimStagingBuffers();
       
       // Reset flush timer used for implicit flushes
       m_lastFlush = dxvk::high_resolution_clock::now();
@@ -1987,14 +1987,17 @@ namespace dxvk {
     if (FAILED(hr))
       return hr;
 
-    auto shader = commonShader.GetShader();
+    // Shaders that are still being translated on a worker thread
+    // cannot be validated here without blocking the application.
+    // The translation task performs the same checks instead.
+    if (!commonShader.IsTranslated()) {
+      *pShaderModule = std::move(commonShader);
+      return S_OK;
+    }
 
-    if (shader->flags().test(DxvkShaderFlag::ExportsStencilRef)
-     && !m_dxvkDevice->extensions().extShaderStencilExport)
-      return E_INVALIDARG;
+    auto shader = commonShader.GetShader();
 
-    if (shader->flags().test(DxvkShaderFlag::ExportsViewportIndexLayerFromVertexStage)
-     && !m_dxvkDevice->extensions().extShaderViewportIndexLayer)
+    if (shader == nullptr || !IsShaderSupported(shader.ptr()))
       return E_INVALIDARG;
 
     *pShaderModule = std::move(commonShader);
@@ -2002,6 +2005,20 @@ namespace dxvk {
   }
 
 
+  BOOL D3D11Device::IsShaderSupported(
+    const DxvkShader*             pShader) const {
+    if (pShader->flags().test(DxvkShaderFlag::ExportsStencilRef)
+     && !m_dxvkDevice->extensions().extShaderStencilExport)
+      return FALSE;
+
+    if (pShader->flags().test(DxvkShaderFlag::ExportsViewportIndexLayerFromVertexStage)
+     && !m_dxvkDevice->extensions().extShaderViewportIndexLayer)
+      return FALSE;
+
+    return TRUE;
+  }
+
+
   HRESULT D3D11Device::GetFormatSupportFlags(DXGI_FORMAT Format, UINT* pFlags1, UINT* pFlags2) const {
     const DXGI_VK_FORMAT_INFO fmtMapping = LookupFormat(Format, DXGI_VK_FORMAT_MODE_ANY);
 
@@ -419,6 +419,9 @@ namespace dxvk {
     D3D10Device* GetD3D10Interface() const {
       return m_d3d10Device;
     }
+
+    BOOL IsShaderSupported(
+      const DxvkShader*             pShader) const;
     
     static bool CheckFeatureLevelSupport(
       const Rc<DxvkInstance>& instance,
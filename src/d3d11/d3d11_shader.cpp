@@ -7,6 +7,11 @@ namespace dxvk {
   D3D11CommonShader::~D3D11CommonShader() { }
   
   
+  D3D11CommonShader::D3D11CommonShader(
+          D3D11ShaderTask* pTask)
+  : m_task(pTask) { }
+  
+  
   D3D11CommonShader::D3D11CommonShader(
           D3D11Device*    pDevice,
     const DxvkShaderKey*  pShaderKey,
@@ -14,14 +19,21 @@ namespace dxvk {
     const void*           pShaderBytecode,
           size_t          BytecodeLength) {
     const std::string name = pShaderKey->toString();
-    Logger::debug(str::format("Compiling shader ", name));
+    
+    // Check whether the translated shader is already stored in
+    // the on-disk shader cache before invoking the compiler.
+    Rc<DxvkShaderCache> shaderCache = pDevice->GetDXVKDevice()->getShaderCache();
+    
+    DxvkShaderCacheKey cacheKey;
+    cacheKey.shader  = *pShaderKey;
+    cacheKey.options = GetOptionsHash(pDxbcModuleInfo);
+    
+    DxvkShaderCacheEntryData cacheData;
     
     DxbcReader reader(
       reinterpret_cast<const char*>(pShaderBytecode),
       BytecodeLength);
     
-    DxbcModule module(reader);
-    
     // If requested by the user, dump both the raw DXBC
     // shader and the compiled SPIR-V module to a file.
     const std::string dumpPath = env::getEnvVar("DXVK_SHADER_DUMP_PATH");
@@ -31,15 +43,29 @@ namespace dxvk {
         std::ios_base::binary | std::ios_base::trunc));
     }
     
-    // Decide whether we need to create a pass-through
-    // geometry shader for vertex shader stream output
-    bool passthroughShader = pDxbcModuleInfo->xfb != nullptr
-      && module.programInfo().type() != DxbcProgramType::GeometryShader;
+    if (shaderCache != nullptr && shaderCache->lookup(cacheKey, cacheData))
+      m_shader = DxvkShader::deserialize(cacheData);
+    
+    if (m_shader == nullptr) {
+      Logger::debug(str::format("Compiling shader ", name));
+      
+      DxbcModule module(reader);
+      
+      // Decide whether we need to create a pass-through
+      // geometry shader for vertex shader stream output
+      bool passthroughShader = pDxbcModuleInfo->xfb != nullptr
+        && module.programInfo().type() != DxbcProgramType::GeometryShader;
 
-    m_shader = passthroughShader
-      ? module.compilePassthroughShader(*pDxbcModuleInfo, name)
-      : module.compile                 (*pDxbcModuleInfo, name);
-    m_shader->setShaderKey(*pShaderKey);
+      m_shader = passthroughShader
+        ? module.compilePassthroughShader(*pDxbcModuleInfo, name)
+        : module.compile                 (*pDxbcModuleInfo, name);
+      
+      if (shaderCache != nullptr) {
+        cacheData = DxvkShaderCacheEntryData();
+        m_shader->serialize(cacheData);
+        shaderCache->insert(cacheKey, std::move(cacheData));
+      }
+    }
     
     if (dumpPath.size() != 0) {
       std::ofstream dumpStream(
@@ -49,6 +75,8 @@ namespace dxvk {
       m_shader->dump(dumpStream);
     }
     
+    m_shader->setShaderKey(*pShaderKey);
+    
     // Create shader constant buffer if necessary
     if (m_shader->shaderConstants().data() != nullptr) {
       DxvkBufferCreateInfo info;
@@ -71,10 +99,107 @@ namespace dxvk {
 
     pDevice->GetDXVKDevice()->registerShader(m_shader);
   }
+  
+  
+  std::string D3D11CommonShader::GetName() const {
+    const Rc<DxvkShader>& shader = GetModule().m_shader;
+    
+    // Shaders whose deferred translation failed have no module
+    if (unlikely(shader == nullptr))
+      return m_task != nullptr ? m_task->GetName() : std::string();
+    
+    return shader->debugName();
+  }
+  
+  
+  void D3D11CommonShader::FinishTranslation() const {
+    if (m_task != nullptr)
+      m_task->wait();
+  }
+  
+  
+  uint64_t D3D11CommonShader::GetOptionsHash(
+    const DxbcModuleInfo* pDxbcModuleInfo) {
+    // Stream output info is already part of the shader key
+    DxvkHashState hash;
+    hash.add(pDxbcModuleInfo->options.hash());
+    
+    if (pDxbcModuleInfo->tess != nullptr)
+      hash.add(uint32_t(pDxbcModuleInfo->tess->maxTessFactor));
+    
+    return hash;
+  }
 
   
+  D3D11ShaderTask::D3D11ShaderTask(
+          D3D11Device*    pDevice,
+    const DxvkShaderKey*  pShaderKey,
+    const DxbcModuleInfo* pDxbcModuleInfo,
+    const void*           pShaderBytecode,
+          size_t          BytecodeLength)
+  : m_device    (pDevice),
+    m_shaderKey (*pShaderKey),
+    m_moduleInfo(*pDxbcModuleInfo),
+    m_bytecode  (BytecodeLength) {
+    std::memcpy(m_bytecode.data(), pShaderBytecode, BytecodeLength);
+    
+    // The tessellation info is owned by the caller
+    if (pDxbcModuleInfo->tess != nullptr) {
+      m_tessInfo = *pDxbcModuleInfo->tess;
+      m_moduleInfo.tess = &m_tessInfo;
+    }
+  }
+  
+  
+  D3D11ShaderTask::~D3D11ShaderTask() {
+    
+  }
+  
+  
+  bool D3D11ShaderTask::run() {
+    bool success = true;
+    
+    try {
+      m_module = D3D11CommonShader(m_device, &m_shaderKey,
+        &m_moduleInfo, m_bytecode.data(), m_bytecode.size());
+      
+      // Creating the shader already returned S_OK, so a shader
+      // that requires unsupported features must never be bound
+      Rc<DxvkShader> shader = m_module.GetShader();
+      
+      if (shader != nullptr && !m_device->IsShaderSupported(shader.ptr())) {
+        Logger::err(str::format("D3D11: ", GetName(), " requires unsupported features"));
+        m_module = D3D11CommonShader();
+        success  = false;
+      }
+    } catch (const DxvkError& e) {
+      Logger::err(e.message());
+      
+      // Leaves the shader unbound rather than
+      // exposing a partially created module
+      m_module = D3D11CommonShader();
+      success  = false;
+    }
+    
+    m_bytecode = std::vector<char>();
+    return success;
+  }
+  
+  
+  void D3D11ShaderTask::WaitForModule() {
+    m_device->GetDXVKDevice()->waitForShaderTask(this);
+  }
+  
+  
   D3D11ShaderModuleSet:: D3D11ShaderModuleSet() { }
-  D3D11ShaderModuleSet::~D3D11ShaderModuleSet() { }
+  
+  
+  D3D11ShaderModuleSet::~D3D11ShaderModuleSet() {
+    // Translation tasks keep a pointer to the device, so
+    // they need to finish before the device is destroyed
+    for (const auto& pair : m_modules)
+      pair.second.FinishTranslation();
+  }
   
   
   HRESULT D3D11ShaderModuleSet::GetShaderModule(
@@ -94,6 +219,32 @@ namespace dxvk {
       }
     }
     
+    // Stream output info references memory owned by the
+    // application, so we cannot defer translation for it
+    if (pDevice->GetDXVKDevice()->config().enableAsyncShaders
+     && pDxbcModuleInfo->xfb == nullptr) {
+      Rc<D3D11ShaderTask> task = new D3D11ShaderTask(pDevice,
+        pShaderKey, pDxbcModuleInfo, pShaderBytecode, BytecodeLength);
+      
+      D3D11CommonShader module(task.ptr());
+      
+      // Insert the module before queueing the task, so that
+      // we never translate the same shader more than once
+      { std::unique_lock<std::mutex> lock(m_mutex);
+        
+        auto status = m_modules.insert({ *pShaderKey, module });
+        if (!status.second) {
+          *pShader = status.first->second;
+          return S_OK;
+        }
+      }
+      
+      pDevice->GetDXVKDevice()->queueShaderTask(task);
+      
+      *pShader = std::move(module);
+      return S_OK;
+    }
+    
     // This shader has not been compiled yet, so we have to create a
     // new module. This takes a while, so we won't lock the structure.
     D3D11CommonShader module;
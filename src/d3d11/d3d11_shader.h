@@ -18,6 +18,7 @@
 namespace dxvk {
   
   class D3D11Device;
+  class D3D11ShaderTask;
   
   /**
    * \brief Common shader object
@@ -37,28 +38,112 @@ namespace dxvk {
       const DxbcModuleInfo* pDxbcModuleInfo,
       const void*           pShaderBytecode,
             size_t          BytecodeLength);
+    D3D11CommonShader(
+            D3D11ShaderTask* pTask);
     ~D3D11CommonShader();
 
     Rc<DxvkShader> GetShader() const {
-      return m_shader;
+      return GetModule().m_shader;
     }
 
     Rc<DxvkBuffer> GetIcb() const {
-      return m_buffer;
+      return GetModule().m_buffer;
     }
     
-    std::string GetName() const {
-      return m_shader->debugName();
-    }
+    std::string GetName() const;
+    
+    /**
+     * \brief Checks whether the shader is translated
+     * 
+     * If this returns \c false, the shader is still being
+     * translated on a worker thread, and any method that
+     * accesses the translated shader will block.
+     * \returns \c true if the shader can be used
+     */
+    bool IsTranslated() const;
+    
+    /**
+     * \brief Waits for pending translation
+     * 
+     * Unlike the accessor methods, this does not
+     * count as a stall in the device statistics.
+     */
+    void FinishTranslation() const;
     
   private:
     
     Rc<DxvkShader> m_shader;
     Rc<DxvkBuffer> m_buffer;
     
+    Rc<D3D11ShaderTask> m_task;
+    
+    const D3D11CommonShader& GetModule() const;
+    
+    static uint64_t GetOptionsHash(
+      const DxbcModuleInfo* pDxbcModuleInfo);
+    
+  };
+  
+  
+  /**
+   * \brief Shader translation task
+   * 
+   * Translates a shader on a worker thread. Owns a copy
+   * of the bytecode and module info, so that the shader
+   * creation call can return before the shader is ready.
+   */
+  class D3D11ShaderTask : public DxvkShaderTask {
+    
+  public:
+    
+    D3D11ShaderTask(
+            D3D11Device*    pDevice,
+      const DxvkShaderKey*  pShaderKey,
+      const DxbcModuleInfo* pDxbcModuleInfo,
+      const void*           pShaderBytecode,
+            size_t          BytecodeLength);
+    ~D3D11ShaderTask();
+    
+    const D3D11CommonShader& GetModule() {
+      if (unlikely(!isDone()))
+        WaitForModule();
+      
+      return m_module;
+    }
+    
+    std::string GetName() const {
+      return m_shaderKey.toString();
+    }
+    
+  protected:
+    
+    bool run();
+    
+  private:
+    
+    D3D11Device*      m_device;
+    DxvkShaderKey     m_shaderKey;
+    DxbcModuleInfo    m_moduleInfo;
+    DxbcTessInfo      m_tessInfo;
+    std::vector<char> m_bytecode;
+    
+    D3D11CommonShader m_module;
+    
+    void WaitForModule();
+    
   };
   
   
+  inline const D3D11CommonShader& D3D11CommonShader::GetModule() const {
+    return likely(m_task == nullptr) ? *this : m_task->GetModule();
+  }
+  
+  
+  inline bool D3D11CommonShader::IsTranslated() const {
+    return m_task == nullptr || m_task->isDone();
+  }
+  
+  
   /**
    * \brief Common shader interface
    * 
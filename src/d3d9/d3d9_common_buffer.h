@@ -42,7 +42,7 @@ namespace dxvk {
     D3D9Range(uint32_t min, uint32_t max)
       : min(min), max(max) { }
 
-    bool IsDegenerate() { return min == max; }
+    bool IsDegenerate() const { return min == max; }
 
     void Conjoin(D3D9Range range) {
       if (IsDegenerate())
@@ -53,7 +53,7 @@ namespace dxvk {
       }
     }
 
-    bool Overlaps(D3D9Range range) {
+    bool Overlaps(D3D9Range range) const {
       if (IsDegenerate())
         return false;
 
@@ -66,6 +66,135 @@ namespace dxvk {
     uint32_t max = 0;
   };
 
+  /**
+   * \brief Set of disjoint ranges
+   *
+   * Stores up to \c MaxRanges sorted, non-overlapping
+   * ranges. Adjacent ranges are merged, and if the set
+   * runs out of space, the two ranges with the smallest
+   * gap between them get merged.
+   */
+  class D3D9RangeSet {
+    static constexpr uint32_t MaxRanges = 16;
+  public:
+
+    bool IsEmpty() const { return m_count == 0; }
+
+    const D3D9Range* begin() const { return &m_ranges[0]; }
+    const D3D9Range* end()   const { return &m_ranges[m_count]; }
+
+    void Conjoin(D3D9Range range) {
+      if (range.IsDegenerate())
+        return;
+
+      // Find the first range that ends at or after the new
+      // range, and merge all ranges that touch the new one
+      uint32_t first = 0;
+
+      while (first < m_count && m_ranges[first].max < range.min)
+        first++;
+
+      uint32_t last = first;
+
+      while (last < m_count && m_ranges[last].min <= range.max) {
+        range.min = std::min(range.min, m_ranges[last].min);
+        range.max = std::max(range.max, m_ranges[last].max);
+        last++;
+      }
+
+      if (first == last) {
+        if (m_count == MaxRanges) {
+          MergeClosest(range);
+          return;
+        }
+
+        for (uint32_t i = m_count; i > first; i--)
+          m_ranges[i] = m_ranges[i - 1];
+
+        m_count += 1;
+      } else {
+        for (uint32_t i = last; i < m_count; i++)
+          m_ranges[first + 1 + i - last] = m_ranges[i];
+
+        m_count -= last - first - 1;
+      }
+
+      m_ranges[first] = range;
+    }
+
+    void Conjoin(const D3D9RangeSet& set) {
+      for (const auto& range : set)
+        Conjoin(range);
+    }
+
+    bool Overlaps(D3D9Range range) const {
+      for (const auto& r : *this) {
+        if (r.min >= range.max)
+          break;
+
+        if (r.Overlaps(range))
+          return true;
+      }
+
+      return false;
+    }
+
+    void Clear() { m_count = 0; }
+
+  private:
+
+    std::array<D3D9Range, MaxRanges> m_ranges;
+    uint32_t                         m_count = 0;
+
+    void MergeClosest(D3D9Range range) {
+      // The set is full and the new range does not touch
+      // any existing range, so merge it with its closest
+      // neighbour or merge two existing ranges, whichever
+      // adds the fewest bytes.
+      D3D9Range merged = m_ranges[0];
+      uint32_t  index  = 0;
+      uint32_t  minGap = ~0u;
+
+      for (uint32_t i = 1; i < m_count; i++) {
+        uint32_t gap = m_ranges[i].min - m_ranges[i - 1].max;
+
+        if (gap < minGap) {
+          minGap = gap;
+          index  = i - 1;
+        }
+      }
+
+      for (const auto& r : *this) {
+        uint32_t gap = r.min > range.max
+          ? r.min - range.max
+          : range.min - r.max;
+
+        if (gap < minGap) {
+          // Merge the new range into an existing one
+          merged.min = std::min(r.min, range.min);
+          merged.max = std::max(r.max, range.max);
+          m_count -= 1;
+
+          for (uint32_t i = uint32_t(&r - begin()); i < m_count; i++)
+            m_ranges[i] = m_ranges[i + 1];
+
+          Conjoin(merged);
+          return;
+        }
+      }
+
+      // Merge two existing ranges to make room
+      m_ranges[index].max = m_ranges[index + 1].max;
+      m_count -= 1;
+
+      for (uint32_t i = index + 1; i < m_count; i++)
+        m_ranges[i] = m_ranges[i + 1];
+
+      Conjoin(range);
+    }
+
+  };
+
   class D3D9CommonBuffer {
     static constexpr VkDeviceSize BufferSliceAlignment = 64;
   public:
@@ -139,8 +268,8 @@ namespace dxvk {
 
     static HRESULT ValidateBufferProperties(const D3D9_BUFFER_DESC* pDesc);
 
-    D3D9Range& LockRange()  { return m_lockRange; }
-    D3D9Range& DirtyRange() { return m_dirtyRange; }
+    D3D9RangeSet& LockRange()  { return m_lockRange; }
+    D3D9RangeSet& DirtyRange() { return m_dirtyRange; }
 
     bool GetReadLocked() const     { return m_readLocked; }
     void SetReadLocked(bool state) { m_readLocked = state; }
@@ -190,8 +319,8 @@ namespace dxvk {
 
     DxvkBufferSliceHandle       m_sliceHandle;
 
-    D3D9Range                   m_lockRange;
-    D3D9Range                   m_dirtyRange;
+    D3D9RangeSet                m_lockRange;
+    D3D9RangeSet                m_dirtyRange;
 
     uint32_t                    m_lockCount = 0;
 
@@ -264,6 +264,12 @@ namespace dxvk {
     // in no way affect the default image layout
     imageInfo.usage |= EnableMetaCopyUsage(imageInfo.format, imageInfo.tiling);
 
+    // Let the backend generate mip maps with a compute shader
+    // rather than one render pass per level if possible. This
+    // must not affect the default image layout either.
+    if (m_desc.Usage & D3DUSAGE_AUTOGENMIPMAP)
+      imageInfo.usage |= EnableMipGenUsage(&imageInfo);
+
     // Check if we can actually create the image
     if (!CheckImageSupport(&imageInfo, imageInfo.tiling)) {
       throw DxvkError(str::format(
@@ -292,6 +298,24 @@ namespace dxvk {
   }
 
 
+  Rc<DxvkImageView> D3D9CommonTexture::CreateVideoConversionView(UINT Subresource) const {
+    VkImageAspectFlags aspect = imageFormatInfo(m_image->info().format)->aspectMask;
+    VkImageSubresource subresource = GetSubresourceFromIndex(aspect, Subresource);
+
+    DxvkImageViewCreateInfo viewInfo;
+    viewInfo.type      = VK_IMAGE_VIEW_TYPE_2D;
+    viewInfo.format    = m_image->info().format;
+    viewInfo.usage     = VK_IMAGE_USAGE_STORAGE_BIT;
+    viewInfo.aspect    = aspect;
+    viewInfo.minLevel  = subresource.mipLevel;
+    viewInfo.numLevels = 1;
+    viewInfo.minLayer  = subresource.arrayLayer;
+    viewInfo.numLayers = 1;
+
+    return m_device->GetDXVKDevice()->createImageView(m_image, viewInfo);
+  }
+
+
   void D3D9CommonTexture::RecreateSampledView(UINT Lod) {
     // This will be a no-op for SYSTEMMEM types given we
     // don't expose the cap to allow texturing with them.
@@ -337,6 +361,26 @@ namespace dxvk {
   }
 
 
+  VkImageUsageFlags D3D9CommonTexture::EnableMipGenUsage(
+    const DxvkImageCreateInfo*  pImageInfo) const {
+    VkFormatProperties properties = m_device->GetDXVKDevice()->adapter()->formatProperties(pImageInfo->format);
+
+    VkFormatFeatureFlags features = pImageInfo->tiling == VK_IMAGE_TILING_OPTIMAL
+      ? properties.optimalTilingFeatures
+      : properties.linearTilingFeatures;
+
+    if (!(features & VK_FORMAT_FEATURE_STORAGE_IMAGE_BIT))
+      return 0;
+
+    DxvkImageCreateInfo imageInfo = *pImageInfo;
+    imageInfo.usage |= VK_IMAGE_USAGE_STORAGE_BIT;
+
+    return CheckImageSupport(&imageInfo, imageInfo.tiling)
+      ? VK_IMAGE_USAGE_STORAGE_BIT
+      : 0;
+  }
+
+
   VkImageUsageFlags D3D9CommonTexture::EnableMetaCopyUsage(
           VkFormat              Format,
           VkImageTiling         Tiling) const {
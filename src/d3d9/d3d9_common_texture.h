@@ -159,6 +159,22 @@ namespace dxvk {
       return m_resolveImage;
     }
 
+    /**
+     * \brief Storage view for video format conversion
+     *
+     * Lazily creates a storage image view of the given
+     * subresource, which can be reused for every upload
+     * of video format data into that subresource.
+     * \param [in] Subresource Subresource index
+     * \returns Storage image view
+     */
+    const Rc<DxvkImageView>& GetVideoConversionView(UINT Subresource) {
+      if (unlikely(m_videoViews[Subresource] == nullptr))
+        m_videoViews[Subresource] = CreateVideoConversionView(Subresource);
+
+      return m_videoViews[Subresource];
+    }
+
     Rc<DxvkBuffer> GetBuffer(UINT Subresource) {
       return m_buffers[Subresource];
     }
@@ -353,6 +369,8 @@ namespace dxvk {
     D3D9SubresourceArray<DWORD>   m_lockFlags;
 
     D3D9ViewSet                   m_views;
+    D3D9SubresourceArray<
+      Rc<DxvkImageView>>          m_videoViews;
 
     D3D9_VK_FORMAT_MAPPING        m_mapping;
 
@@ -380,12 +398,17 @@ namespace dxvk {
 
     Rc<DxvkImage> CreateResolveImage() const;
 
+    Rc<DxvkImageView> CreateVideoConversionView(UINT Subresource) const;
+
     BOOL DetermineShadowState() const;
 
     BOOL CheckImageSupport(
       const DxvkImageCreateInfo*  pImageInfo,
             VkImageTiling         Tiling) const;
 
+    VkImageUsageFlags EnableMipGenUsage(
+      const DxvkImageCreateInfo*  pImageInfo) const;
+
     VkImageUsageFlags EnableMetaCopyUsage(
             VkFormat              Format,
             VkImageTiling         Tiling) const;
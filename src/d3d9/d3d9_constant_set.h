@@ -42,6 +42,17 @@ namespace dxvk {
     Rc<DxvkBuffer>            buffer;
     const DxsoShaderMetaInfo* meta  = nullptr;
     bool                      dirty = true;
+
+    // Upper bound of float and int registers that have
+    // ever been written. All registers above are zero.
+    uint32_t                  maxChangedConstF = 0;
+    uint32_t                  maxChangedConstI = 0;
+
+    // Constant data is sub-allocated linearly from the
+    // buffer, which only gets renamed once it is full.
+    DxvkBufferSliceHandle     slice  = { };
+    VkDeviceSize              offset = 0;
+    VkDeviceSize              alignment = 0;
   };
 
 }
\ No newline at end of file
@@ -77,6 +77,9 @@ namespace dxvk {
 
     CreateConstantBuffers();
 
+    m_flags.set(D3D9DeviceFlag::DirtyFFWorldView);
+    m_ffDirtyBlendMatrices.set();
+
     if (!(BehaviorFlags & D3DCREATE_FPU_PRESERVE))
       SetupFPU();
 
@@ -95,6 +98,10 @@ namespace dxvk {
     delete m_initializer;
     delete m_converter;
 
+    // Finish any shader translation tasks
+    // while the device is still fully intact
+    m_shaderModules = nullptr;
+
     m_dxvkDevice->waitForIdle(); // Sync Device
   }
 
@@ -1448,7 +1455,7 @@ namespace dxvk {
 
     m_state.transforms[idx] = ConvertMatrix(pMatrix) * m_state.transforms[idx];
 
-    m_flags.set(D3D9DeviceFlag::DirtyFFVertexData);
+    MarkTransformDirty(idx);
 
     return D3D_OK;
   }
@@ -3516,10 +3523,7 @@ namespace dxvk {
 
     m_state.transforms[idx] = ConvertMatrix(pMatrix);
 
-    m_flags.set(D3D9DeviceFlag::DirtyFFVertexData);
-
-    if (idx == GetTransformIndex(D3DTS_VIEW) || idx >= GetTransformIndex(D3DTS_WORLD))
-      m_flags.set(D3D9DeviceFlag::DirtyFFVertexBlend);
+    MarkTransformDirty(idx);
 
     return D3D_OK;
   }
@@ -4041,10 +4045,15 @@ namespace dxvk {
       });
     } 
     else {
-      m_converter->ConvertVideoFormat(
-        videoFormat,
-        image, subresourceLayers,
-        copyBuffer);
+      EmitCs([
+        cConverter   = m_converter,
+        cVideoFormat = videoFormat,
+        cDstView     = pResource->GetVideoConversionView(Subresource),
+        cSrcBuffer   = copyBuffer
+      ] (DxvkContext* ctx) {
+        cConverter->ConvertVideoFormat(ctx,
+          cVideoFormat, cDstView, cSrcBuffer);
+      });
     }
 
     return D3D_OK;
@@ -4105,6 +4114,12 @@ namespace dxvk {
     const bool quickRead   = ((Flags & D3DLOCK_READONLY) && !pResource->GetReadLocked());
     const bool boundsCheck = IsPoolManaged(desc.Pool) && !quickRead;
 
+    // Only MANAGED buffers get their written ranges tracked. DEFAULT
+    // and SYSTEMMEM pool buffers are accessed directly on native, so
+    // games may write outside of the locked range, and we always have
+    // to upload the whole buffer when it gets unlocked.
+    D3D9Range lockRange;
+
     if (boundsCheck) {
       // We can only respect this for these cases -- otherwise R/W OOB still get copied on native
       // and some stupid games depend on that.
@@ -4116,7 +4131,8 @@ namespace dxvk {
       uint32_t offset = respectUserBounds ? OffsetToLock : 0;
       uint32_t size   = respectUserBounds ? SizeToLock   : desc.Size;
 
-      pResource->LockRange().Conjoin(D3D9Range(offset, offset + size));
+      lockRange = D3D9Range(offset, offset + size);
+      pResource->LockRange().Conjoin(lockRange);
     }
 
     Rc<DxvkBuffer> mappingBuffer = pResource->GetBuffer<D3D9_COMMON_BUFFER_TYPE_MAPPING>();
@@ -4143,9 +4159,10 @@ namespace dxvk {
 
       // If we are respecting the bounds ie. (MANAGED) we can test overlap
       // of our bounds, otherwise we just ignore this and go for it all the time.
+      // Ranges locked previously have already been tested when locking them.
       const bool skipWait = (Flags & D3DLOCK_NOOVERWRITE) ||
                             quickRead                     ||
-                            (boundsCheck && !pResource->DirtyRange().Overlaps(pResource->LockRange()));
+                            (boundsCheck && !pResource->DirtyRange().Overlaps(lockRange));
 
       if (!skipWait) {
         if (!(Flags & D3DLOCK_DONOTWAIT)) {
@@ -4192,16 +4209,30 @@ namespace dxvk {
     auto dstBuffer = pResource->GetBufferSlice<D3D9_COMMON_BUFFER_TYPE_REAL>();
     auto srcBuffer = pResource->GetBufferSlice<D3D9_COMMON_BUFFER_TYPE_STAGING>();
 
+    // Only upload the ranges that have been locked since the last
+    // upload, or the entire buffer if we do not know what changed.
+    D3D9RangeSet ranges = pResource->LockRange();
+
+    if (ranges.IsEmpty())
+      ranges.Conjoin(D3D9Range(0, pResource->Desc()->Size));
+
     EmitCs([
       cDstSlice = dstBuffer,
-      cSrcSlice = srcBuffer
+      cSrcSlice = srcBuffer,
+      cRanges   = ranges
     ] (DxvkContext* ctx) {
-      ctx->copyBuffer(
-        cDstSlice.buffer(),
-        cDstSlice.offset(),
-        cSrcSlice.buffer(),
-        cSrcSlice.offset(),
-        cSrcSlice.length());
+      for (const auto& range : cRanges) {
+        // Lock ranges are not clamped to the buffer size
+        VkDeviceSize min = std::min<VkDeviceSize>(range.min, cSrcSlice.length());
+        VkDeviceSize max = std::min<VkDeviceSize>(range.max, cSrcSlice.length());
+
+        ctx->copyBuffer(
+          cDstSlice.buffer(),
+          cDstSlice.offset() + min,
+          cSrcSlice.buffer(),
+          cSrcSlice.offset() + min,
+          max - min);
+      }
     });
 
     pResource->DirtyRange().Conjoin(pResource->LockRange());
@@ -4349,13 +4380,29 @@ namespace dxvk {
     VkMemoryPropertyFlags memoryFlags = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT
                                       | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT;
 
+    // Constant buffers are used as a ring and bound with
+    // dynamic offsets, so make them large enough to hold
+    // data for a decent number of draws before renaming.
+    const VkDeviceSize uboAlignment = m_dxvkDevice->adapter()->deviceProperties().limits.minUniformBufferOffsetAlignment;
+    const VkDeviceSize uboRingSize  = 1 << 20;
+
+    auto CreateConstantRing = [&] (
+      DxsoProgramType           shaderStage,
+      const D3D9ConstantLayout& layout) {
+      D3D9ConstantSets& constSet = m_consts[shaderStage];
+
+      info.size = std::max(uboRingSize, 4 * align(VkDeviceSize(layout.totalSize()), uboAlignment));
+      constSet.buffer    = m_dxvkDevice->createBuffer(info, memoryFlags);
+      constSet.slice     = constSet.buffer->getSliceHandle();
+      constSet.offset    = 0;
+      constSet.alignment = uboAlignment;
+    };
+
     info.stages = VK_PIPELINE_STAGE_VERTEX_SHADER_BIT;
-    info.size   = m_vsLayout.totalSize();
-    m_consts[DxsoProgramTypes::VertexShader].buffer = m_dxvkDevice->createBuffer(info, memoryFlags);
+    CreateConstantRing(DxsoProgramTypes::VertexShader, m_vsLayout);
 
     info.stages = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
-    info.size   = m_psLayout.totalSize();
-    m_consts[DxsoProgramTypes::PixelShader].buffer  = m_dxvkDevice->createBuffer(info, memoryFlags);
+    CreateConstantRing(DxsoProgramTypes::PixelShader, m_psLayout);
 
     info.stages = VK_PIPELINE_STAGE_VERTEX_SHADER_BIT;
     info.size = caps::MaxClipPlanes * sizeof(D3D9ClipPlane);
@@ -4396,12 +4443,10 @@ namespace dxvk {
       });
     };
 
-    BindConstantBuffer(DxsoProgramTypes::VertexShader, m_consts[DxsoProgramTypes::VertexShader].buffer, DxsoConstantBuffers::VSConstantBuffer);
     BindConstantBuffer(DxsoProgramTypes::VertexShader, m_vsClipPlanes,                                  DxsoConstantBuffers::VSClipPlanes);
     BindConstantBuffer(DxsoProgramTypes::VertexShader, m_vsFixedFunction,                               DxsoConstantBuffers::VSFixedFunction);
     BindConstantBuffer(DxsoProgramTypes::VertexShader, m_vsVertexBlend,                                 DxsoConstantBuffers::VSVertexBlendData);
 
-    BindConstantBuffer(DxsoProgramTypes::PixelShader,  m_consts[DxsoProgramTypes::PixelShader].buffer,  DxsoConstantBuffers::PSConstantBuffer);
     BindConstantBuffer(DxsoProgramTypes::PixelShader,  m_psFixedFunction,                               DxsoConstantBuffers::PSFixedFunction);
     BindConstantBuffer(DxsoProgramTypes::PixelShader,  m_psShared,                                      DxsoConstantBuffers::PSShared);
     
@@ -4410,6 +4455,19 @@ namespace dxvk {
   }
 
 
+  template <typename T>
+  inline void CopyConstantRange(T* pDst, const T* pSrc, uint32_t Count, uint32_t ChangedCount) {
+    // Registers that were never written are known to be zero,
+    // so we don't need to read them from the app-side state
+    const uint32_t copyCount = std::min(Count, ChangedCount);
+
+    std::memcpy(pDst, pSrc, copyCount * sizeof(T));
+
+    if (copyCount < Count)
+      std::memset(pDst + copyCount, 0, (Count - copyCount) * sizeof(T));
+  }
+
+
   template <DxsoProgramType ShaderStage, typename HardwareLayoutType, typename SoftwareLayoutType, typename ShaderType>
   inline void D3D9DeviceEx::UploadHardwareConstantSet(void* pData, const SoftwareLayoutType& Src, const ShaderType& Shader) {
     const D3D9ConstantSets& constSet = m_consts[ShaderStage];
@@ -4417,9 +4475,9 @@ namespace dxvk {
     auto* dst = reinterpret_cast<HardwareLayoutType*>(pData);
 
     if (constSet.meta->maxConstIndexF)
-      std::memcpy(dst->fConsts, Src.fConsts, constSet.meta->maxConstIndexF * sizeof(Vector4));
+      CopyConstantRange(dst->fConsts, Src.fConsts, constSet.meta->maxConstIndexF, constSet.maxChangedConstF);
     if (constSet.meta->maxConstIndexI)
-      std::memcpy(dst->iConsts, Src.iConsts, constSet.meta->maxConstIndexI * sizeof(Vector4i));
+      CopyConstantRange(dst->iConsts, Src.iConsts, constSet.meta->maxConstIndexI, constSet.maxChangedConstI);
     if (constSet.meta->maxConstIndexB)
       dst->bConsts[0] = Src.bConsts[0];
   }
@@ -4432,9 +4490,9 @@ namespace dxvk {
     auto dst = reinterpret_cast<uint8_t*>(pData);
 
     if (constSet.meta->maxConstIndexF)
-      std::memcpy(dst + Layout.floatOffset(),   Src.fConsts, constSet.meta->maxConstIndexF * sizeof(Vector4));
+      CopyConstantRange(reinterpret_cast<Vector4*> (dst + Layout.floatOffset()), Src.fConsts, constSet.meta->maxConstIndexF, constSet.maxChangedConstF);
     if (constSet.meta->maxConstIndexI)
-      std::memcpy(dst + Layout.intOffset(),     Src.iConsts, constSet.meta->maxConstIndexI * sizeof(Vector4i));
+      CopyConstantRange(reinterpret_cast<Vector4i*>(dst + Layout.intOffset()),   Src.iConsts, constSet.meta->maxConstIndexI, constSet.maxChangedConstI);
     if (constSet.meta->maxConstIndexB)
       std::memcpy(dst + Layout.bitmaskOffset(), Src.bConsts, Layout.bitmaskSize());
   }
@@ -4449,24 +4507,68 @@ namespace dxvk {
 
     constSet.dirty = false;
 
-    DxvkBufferSliceHandle slice = constSet.buffer->allocSlice();
+    // Only the part of the buffer that the shader can
+    // actually access needs to be allocated and written
+    VkDeviceSize usedSize = 0;
+
+    if (constSet.meta->maxConstIndexF)
+      usedSize = Layout.floatOffset() + constSet.meta->maxConstIndexF * sizeof(Vector4);
+    if (constSet.meta->maxConstIndexI)
+      usedSize = Layout.intOffset()   + constSet.meta->maxConstIndexI * sizeof(Vector4i);
+    if (constSet.meta->maxConstIndexB)
+      usedSize = Layout.bitmaskOffset() + Layout.bitmaskSize();
+
+    // The bound range always covers the entire layout so that
+    // updating the offset does not require a new descriptor set
+    const VkDeviceSize bindSize = Layout.totalSize();
+
+    if (constSet.offset + bindSize > constSet.buffer->info().size) {
+      constSet.slice  = constSet.buffer->allocSlice();
+      constSet.offset = 0;
+
+      EmitCs([
+        cBuffer = constSet.buffer,
+        cSlice  = constSet.slice
+      ] (DxvkContext* ctx) {
+        ctx->invalidateBuffer(cBuffer, cSlice);
+      });
+    }
+
+    // Every upload goes to a range the GPU has never seen with the
+    // current constants, so it has to contain the full used range.
+    // Copying only the changed registers would require knowing what
+    // a recycled range last held, and doing that bookkeeping per draw
+    // costs about as much as the copy it would save.
+    const VkDeviceSize offset = constSet.offset;
+    constSet.offset = align(offset + std::max(usedSize, VkDeviceSize(1)), constSet.alignment);
+
+    const uint32_t slotId = computeResourceSlotId(
+      ShaderStage, DxsoBindingType::ConstantBuffer,
+      ShaderStage == DxsoProgramType::VertexShader
+        ? DxsoConstantBuffers::VSConstantBuffer
+        : DxsoConstantBuffers::PSConstantBuffer);
 
     EmitCs([
+      cSlotId = slotId,
       cBuffer = constSet.buffer,
-      cSlice  = slice
+      cOffset = offset,
+      cLength = bindSize
     ] (DxvkContext* ctx) {
-      ctx->invalidateBuffer(cBuffer, cSlice);
+      ctx->bindResourceBuffer(cSlotId,
+        DxvkBufferSlice(cBuffer, cOffset, cLength));
     });
 
+    void* mapPtr = reinterpret_cast<char*>(constSet.slice.mapPtr) + offset;
+
     if constexpr (ShaderStage == DxsoProgramType::PixelShader)
-      UploadHardwareConstantSet<ShaderStage, HardwareLayoutType>(slice.mapPtr, Src, Shader);
+      UploadHardwareConstantSet<ShaderStage, HardwareLayoutType>(mapPtr, Src, Shader);
     else if (likely(!CanSWVP()))
-      UploadHardwareConstantSet<ShaderStage, HardwareLayoutType>(slice.mapPtr, Src, Shader);
+      UploadHardwareConstantSet<ShaderStage, HardwareLayoutType>(mapPtr, Src, Shader);
     else
-      UploadSoftwareConstantSet(slice.mapPtr, Src, Layout, Shader);
+      UploadSoftwareConstantSet(mapPtr, Src, Layout, Shader);
 
     if (constSet.meta->needsConstantCopies) {
-      Vector4* data = reinterpret_cast<Vector4*>(slice.mapPtr);
+      Vector4* data = reinterpret_cast<Vector4*>(mapPtr);
 
       auto& shaderConsts = GetCommonShader(Shader)->GetConstants();
 
@@ -5160,69 +5262,78 @@ namespace dxvk {
       samplerInfo.first, DxsoBindingType::DepthImage,
       samplerInfo.second);
 
-    EmitCs([this,
-      cColorSlot = colorSlot,
-      cDepthSlot = depthSlot,
-      cKey       = key
-    ] (DxvkContext* ctx) {
-      auto pair = m_samplers.find(cKey);
-      if (pair != m_samplers.end()) {
-        ctx->bindResourceSampler(cColorSlot, pair->second.color);
-        ctx->bindResourceSampler(cDepthSlot, pair->second.depth);
-        return;
-      }
+    auto mipFilter = DecodeMipFilter(key.MipFilter);
+
+    DxvkSamplerCreateInfo colorInfo;
+    colorInfo.addressModeU   = DecodeAddressMode(key.AddressU);
+    colorInfo.addressModeV   = DecodeAddressMode(key.AddressV);
+    colorInfo.addressModeW   = DecodeAddressMode(key.AddressW);
+    colorInfo.compareToDepth = VK_FALSE;
+    colorInfo.compareOp      = VK_COMPARE_OP_NEVER;
+    colorInfo.magFilter      = DecodeFilter(key.MagFilter);
+    colorInfo.minFilter      = DecodeFilter(key.MinFilter);
+    colorInfo.mipmapMode     = mipFilter.MipFilter;
+    colorInfo.maxAnisotropy  = float(key.MaxAnisotropy);
+    colorInfo.useAnisotropy  = IsAnisotropic(key.MinFilter)
+                            || IsAnisotropic(key.MagFilter);
+    colorInfo.mipmapLodBias  = key.MipmapLodBias;
+    colorInfo.mipmapLodMin   = mipFilter.MipsEnabled ? float(key.MaxMipLevel) : 0;
+    colorInfo.mipmapLodMax   = mipFilter.MipsEnabled ? FLT_MAX                : 0;
+    colorInfo.usePixelCoord  = VK_FALSE;
+    for (uint32_t i = 0; i < 4; i++)
+      colorInfo.borderColor.float32[i] = key.BorderColor[i];
 
-      auto mipFilter = DecodeMipFilter(cKey.MipFilter);
-
-      DxvkSamplerCreateInfo colorInfo;
-      colorInfo.addressModeU   = DecodeAddressMode(cKey.AddressU);
-      colorInfo.addressModeV   = DecodeAddressMode(cKey.AddressV);
-      colorInfo.addressModeW   = DecodeAddressMode(cKey.AddressW);
-      colorInfo.compareToDepth = VK_FALSE;
-      colorInfo.compareOp      = VK_COMPARE_OP_NEVER;
-      colorInfo.magFilter      = DecodeFilter(cKey.MagFilter);
-      colorInfo.minFilter      = DecodeFilter(cKey.MinFilter);
-      colorInfo.mipmapMode     = mipFilter.MipFilter;
-      colorInfo.maxAnisotropy  = float(cKey.MaxAnisotropy);
-      colorInfo.useAnisotropy  = IsAnisotropic(cKey.MinFilter)
-                              || IsAnisotropic(cKey.MagFilter);
-      colorInfo.mipmapLodBias  = cKey.MipmapLodBias;
-      colorInfo.mipmapLodMin   = mipFilter.MipsEnabled ? float(cKey.MaxMipLevel) : 0;
-      colorInfo.mipmapLodMax   = mipFilter.MipsEnabled ? FLT_MAX                 : 0;
-      colorInfo.usePixelCoord  = VK_FALSE;
-      for (uint32_t i = 0; i < 4; i++)
-        colorInfo.borderColor.float32[i] = cKey.BorderColor[i];
-
-      // HACK: Let's get OPAQUE_WHITE border color over
-      // TRANSPARENT_BLACK if the border RGB is white.
-      if (colorInfo.borderColor.float32[0] == 1.0f
-       && colorInfo.borderColor.float32[1] == 1.0f
-       && colorInfo.borderColor.float32[2] == 1.0f) {
-        // Then set the alpha to 1.
-        colorInfo.borderColor.float32[3] = 1.0f;
-      }
+    // HACK: Let's get OPAQUE_WHITE border color over
+    // TRANSPARENT_BLACK if the border RGB is white.
+    if (colorInfo.borderColor.float32[0] == 1.0f
+     && colorInfo.borderColor.float32[1] == 1.0f
+     && colorInfo.borderColor.float32[2] == 1.0f) {
+      // Then set the alpha to 1.
+      colorInfo.borderColor.float32[3] = 1.0f;
+    }
 
-      DxvkSamplerCreateInfo depthInfo = colorInfo;
-      depthInfo.compareToDepth = VK_TRUE;
-      depthInfo.compareOp      = VK_COMPARE_OP_LESS_OR_EQUAL;
-      depthInfo.magFilter      = VK_FILTER_LINEAR;
-      depthInfo.minFilter      = VK_FILTER_LINEAR;
+    // Samplers are cached by the device, so looking them up here
+    // is cheap and keeps sampler creation off the CS thread. The
+    // depth compare variant is only needed for shadow textures.
+    D3D9CommonTexture* commonTex =
+      GetCommonTexture(m_state.textures[Sampler]);
 
-      try {
-        D3D9SamplerPair pair;
+    Rc<DxvkSampler> colorSampler;
+    Rc<DxvkSampler> depthSampler;
 
-        pair.color = m_dxvkDevice->createSampler(colorInfo);
-        pair.depth = m_dxvkDevice->createSampler(depthInfo);
+    try {
+      colorSampler = m_dxvkDevice->createSampler(colorInfo);
 
-        m_samplerCount++;
+      if (commonTex != nullptr && commonTex->IsShadow()) {
+        DxvkSamplerCreateInfo depthInfo = colorInfo;
+        depthInfo.compareToDepth = VK_TRUE;
+        depthInfo.compareOp      = VK_COMPARE_OP_LESS_OR_EQUAL;
+        depthInfo.magFilter      = VK_FILTER_LINEAR;
+        depthInfo.minFilter      = VK_FILTER_LINEAR;
 
-        m_samplers.insert(std::make_pair(cKey, pair));
-        ctx->bindResourceSampler(cColorSlot, pair.color);
-        ctx->bindResourceSampler(cDepthSlot, pair.depth);
-      }
-      catch (const DxvkError& e) {
-        Logger::err(e.message());
+        depthSampler = m_dxvkDevice->createSampler(depthInfo);
       }
+    }
+    catch (const DxvkError& e) {
+      Logger::err(e.message());
+      return;
+    }
+
+    if (depthSampler != nullptr)
+      m_depthSamplers |=   1u << Sampler;
+    else
+      m_depthSamplers &= ~(1u << Sampler);
+
+    EmitCs([
+      cColorSlot    = colorSlot,
+      cDepthSlot    = depthSlot,
+      cColorSampler = std::move(colorSampler),
+      cDepthSampler = std::move(depthSampler)
+    ] (DxvkContext* ctx) {
+      ctx->bindResourceSampler(cColorSlot, cColorSampler);
+
+      if (cDepthSampler != nullptr)
+        ctx->bindResourceSampler(cDepthSlot, cDepthSampler);
     });
   }
 
@@ -5266,6 +5377,11 @@ namespace dxvk {
       return;
     }
 
+    // Depth compare samplers are created lazily, so make
+    // sure one gets bound before drawing with a shadow texture
+    if (commonTex->IsShadow() && !(m_depthSamplers & (1u << StateSampler)))
+      m_dirtySamplerStates |= 1u << StateSampler;
+
     EmitCs([
       cColorSlot = colorSlot,
       cDepthSlot = depthSlot,
@@ -5730,6 +5846,11 @@ namespace dxvk {
 
     m_consts[ProgramType].dirty |= StartRegister < maxCount;
 
+    if constexpr (ConstantType == D3D9ConstantType::Float)
+      m_consts[ProgramType].maxChangedConstF = std::max(m_consts[ProgramType].maxChangedConstF, StartRegister + Count);
+    else if constexpr (ConstantType == D3D9ConstantType::Int)
+      m_consts[ProgramType].maxChangedConstI = std::max(m_consts[ProgramType].maxChangedConstI, StartRegister + Count);
+
     UpdateStateConstants<ProgramType, ConstantType, T>(
       &m_state,
       StartRegister,
@@ -5741,6 +5862,28 @@ namespace dxvk {
   }
 
 
+  void D3D9DeviceEx::MarkTransformDirty(uint32_t idx) {
+    m_flags.set(D3D9DeviceFlag::DirtyFFVertexData);
+
+    const uint32_t viewIdx  = GetTransformIndex(D3DTS_VIEW);
+    const uint32_t worldIdx = GetTransformIndex(D3DTS_WORLD);
+
+    if (idx == viewIdx || idx == worldIdx)
+      m_flags.set(D3D9DeviceFlag::DirtyFFWorldView);
+
+    // Changing the view matrix affects all blend matrices,
+    // changing a world matrix only affects its own one
+    if (idx == viewIdx)
+      m_ffDirtyBlendMatrices.set();
+    else if (idx >= worldIdx)
+      m_ffDirtyBlendMatrices.set(idx - worldIdx);
+    else
+      return;
+
+    m_flags.set(D3D9DeviceFlag::DirtyFFVertexBlend);
+  }
+
+
   void D3D9DeviceEx::UpdateFixedFunctionVS() {
     // Shader...
     bool hasPositionT = m_state.vertexDecl != nullptr ? m_state.vertexDecl->TestFlag(D3D9VertexDeclFlag::HasPositionT) : false;
@@ -5891,12 +6034,16 @@ namespace dxvk {
         ctx->invalidateBuffer(cBuffer, cSlice);
       });
 
-      auto WorldView    = m_state.transforms[GetTransformIndex(D3DTS_VIEW)] * m_state.transforms[GetTransformIndex(D3DTS_WORLD)];
-      auto NormalMatrix = inverse(WorldView);
+      if (m_flags.test(D3D9DeviceFlag::DirtyFFWorldView)) {
+        m_flags.clr(D3D9DeviceFlag::DirtyFFWorldView);
+
+        m_ffWorldView    = m_state.transforms[GetTransformIndex(D3DTS_VIEW)] * m_state.transforms[GetTransformIndex(D3DTS_WORLD)];
+        m_ffNormalMatrix = inverse(m_ffWorldView);
+      }
 
       D3D9FixedFunctionVS* data = reinterpret_cast<D3D9FixedFunctionVS*>(slice.mapPtr);
-      data->WorldView    = WorldView;
-      data->NormalMatrix = NormalMatrix;
+      data->WorldView    = m_ffWorldView;
+      data->NormalMatrix = m_ffNormalMatrix;
       data->Projection   = m_state.transforms[GetTransformIndex(D3DTS_PROJECTION)];
 
       for (uint32_t i = 0; i < data->TexcoordMatrices.size(); i++)
@@ -5931,9 +6078,18 @@ namespace dxvk {
         ctx->invalidateBuffer(cBuffer, cSlice);
       });
 
+      // The buffer gets renamed, so we need to write all matrices,
+      // but only the ones that actually changed are recomputed.
+      // Matrices beyond the ones used keep their dirty bit.
       auto UploadVertexBlendData = [&](auto data) {
-        for (uint32_t i = 0; i < countof(data->WorldView); i++)
-          data->WorldView[i] = m_state.transforms[GetTransformIndex(D3DTS_VIEW)] * m_state.transforms[GetTransformIndex(D3DTS_WORLDMATRIX(i))];
+        for (uint32_t i = 0; i < countof(data->WorldView); i++) {
+          if (m_ffDirtyBlendMatrices.test(i)) {
+            m_ffDirtyBlendMatrices.reset(i);
+            m_ffBlendWorldView[i] = m_state.transforms[GetTransformIndex(D3DTS_VIEW)] * m_state.transforms[GetTransformIndex(D3DTS_WORLDMATRIX(i))];
+          }
+
+          data->WorldView[i] = m_ffBlendWorldView[i];
+        }
       };
 
       (m_isSWVP && indexedVertexBlend)
@@ -61,6 +61,7 @@ namespace dxvk {
 
     DirtyFFVertexData,
     DirtyFFVertexBlend,
+    DirtyFFWorldView,
     DirtyFFVertexShader,
     DirtyFFPixelShader,
     DirtyFFViewport,
@@ -81,11 +82,6 @@ namespace dxvk {
     uint32_t instanceCount;
   };
 
-  struct D3D9SamplerPair {
-    Rc<DxvkSampler> color;
-    Rc<DxvkSampler> depth;
-  };
-
   struct D3D9UPBufferSlice {
     DxvkBufferSlice slice = {};
     void*           mapPtr = nullptr;
@@ -877,13 +873,14 @@ namespace dxvk {
     HRESULT InitialReset(D3DPRESENT_PARAMETERS* pPresentationParameters, D3DDISPLAYMODEEX* pFullscreenDisplayMode);
 
     UINT GetSamplerCount() const {
-      return m_samplerCount.load();
+      return m_dxvkDevice->getStatCounters().getCtr(DxvkStatCounter::SamplerCount);
     }
 
   private:
 
     D3D9DeviceFlags                 m_flags;
     uint32_t                        m_dirtySamplerStates = 0;
+    uint32_t                        m_depthSamplers      = 0;
 
     D3D9Adapter*                    m_adapter;
     Rc<DxvkDevice>                  m_dxvkDevice;
@@ -964,6 +961,13 @@ namespace dxvk {
     Rc<DxvkBuffer>                  m_psFixedFunction;
     Rc<DxvkBuffer>                  m_psShared;
 
+    // Cached View * World products, so that we only need
+    // to recompute the ones whose transforms have changed
+    Matrix4                         m_ffWorldView;
+    Matrix4                         m_ffNormalMatrix;
+    std::array<Matrix4, 256>        m_ffBlendWorldView;
+    std::bitset<256>                m_ffDirtyBlendMatrices;
+
     D3D9UPBufferSlice               m_upBuffer;
 
     const D3D9Options               m_d3d9Options;
@@ -981,12 +985,6 @@ namespace dxvk {
       Com<D3D9SwapChainEx,
       false>>                       m_swapchains;
 
-    std::unordered_map<
-      D3D9SamplerKey,
-      D3D9SamplerPair,
-      D3D9SamplerKeyHash,
-      D3D9SamplerKeyEq>             m_samplers;
-
     std::unordered_map<
       DWORD,
       Com<D3D9VertexDecl>> m_fvfTable;
@@ -1009,7 +1007,6 @@ namespace dxvk {
     D3D9ViewportInfo                m_viewportInfo;
 
     std::atomic<int64_t>            m_availableMemory = 0;
-    std::atomic<int32_t>            m_samplerCount = 0;
 
     bool                            m_amdATOC         = false;
     bool                            m_nvATOC          = false;
@@ -1133,6 +1130,8 @@ namespace dxvk {
         : GetHelper(m_state.psConsts);
     }
 
+    void MarkTransformDirty(uint32_t idx);
+
     void UpdateFixedFunctionVS();
 
     void UpdateFixedFunctionPS();
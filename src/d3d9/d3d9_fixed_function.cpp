@@ -12,8 +12,9 @@
 
 namespace dxvk {
 
-  D3D9FixedFunctionOptions::D3D9FixedFunctionOptions(const D3D9Options* options) {
-    invariantPosition = options->invariantPosition;
+  D3D9FixedFunctionOptions::D3D9FixedFunctionOptions(const Rc<DxvkDevice>& device, const D3D9Options* options) {
+    invariantPosition    = options->invariantPosition;
+    enableSpirvOptimizer = device->config().enableSpirvOptimizer;
   }
 
   uint32_t DoFixedFunctionFog(SpirvModule& spvModule, const D3D9FogContext& fogCtx) {
@@ -690,6 +691,7 @@ namespace dxvk {
       m_entryPointInterfaces.data());
 
     DxvkShaderOptions shaderOptions = { };
+    shaderOptions.disableOptimizer = !m_options.enableSpirvOptimizer;
 
     DxvkShaderConstData constData = { };
 
@@ -2148,7 +2150,7 @@ namespace dxvk {
     D3D9FFShaderCompiler compiler(
       pDevice->GetDXVKDevice(),
       Key, name,
-      pDevice->GetOptions());
+      D3D9FixedFunctionOptions(pDevice->GetDXVKDevice(), pDevice->GetOptions()));
 
     m_shader = compiler.compile();
     m_isgn   = compiler.isgn();
@@ -2171,7 +2173,7 @@ namespace dxvk {
     D3D9FFShaderCompiler compiler(
       pDevice->GetDXVKDevice(),
       Key, name,
-      pDevice->GetOptions());
+      D3D9FixedFunctionOptions(pDevice->GetDXVKDevice(), pDevice->GetOptions()));
 
     m_shader = compiler.compile();
     m_isgn   = compiler.isgn();
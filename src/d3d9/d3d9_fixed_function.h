@@ -14,6 +14,7 @@
 namespace dxvk {
 
   class D3D9DeviceEx;
+  class DxvkDevice;
   class SpirvModule;
 
   struct D3D9Options;
@@ -32,9 +33,10 @@ namespace dxvk {
   };
 
   struct D3D9FixedFunctionOptions {
-    D3D9FixedFunctionOptions(const D3D9Options* options);
+    D3D9FixedFunctionOptions(const Rc<DxvkDevice>& device, const D3D9Options* options);
 
     bool invariantPosition;
+    bool enableSpirvOptimizer;
   };
 
   // Returns new oFog if VS
@@ -1,63 +1,47 @@
 #include "d3d9_format_helpers.h"
+#include "d3d9_state.h"
 
 #include <d3d9_convert_yuy2_uyvy.h>
 
 namespace dxvk {
 
-  D3D9FormatHelper::D3D9FormatHelper(const Rc<DxvkDevice>& device)
-    : m_device(device), m_context(m_device->createContext()) {
-    m_context->beginRecording(
-      m_device->createCommandList());
+  static_assert(sizeof(D3D9RenderStateInfo) <= 48,
+    "Video conversion push constants overlap render state info");
+
 
+  D3D9FormatHelper::D3D9FormatHelper(const Rc<DxvkDevice>& device)
+    : m_device(device) {
     InitShaders();
   }
 
 
   void D3D9FormatHelper::ConvertVideoFormat(
+          DxvkContext*             ctx,
           D3D9_VIDEO_FORMAT_INFO   videoFormat,
-    const Rc<DxvkImage>&           dstImage,
-          VkImageSubresourceLayers dstSubresource,
-    const Rc<DxvkBuffer>&          srcBuffer) {
-    DxvkImageViewCreateInfo imageViewInfo;
-    imageViewInfo.type      = VK_IMAGE_VIEW_TYPE_2D;
-    imageViewInfo.format    = dstImage->info().format;
-    imageViewInfo.usage     = VK_IMAGE_USAGE_STORAGE_BIT;
-    imageViewInfo.aspect    = dstSubresource.aspectMask;
-    imageViewInfo.minLevel  = dstSubresource.mipLevel;
-    imageViewInfo.numLevels = 1;
-    imageViewInfo.minLayer  = dstSubresource.baseArrayLayer;
-    imageViewInfo.numLayers = dstSubresource.layerCount;
-    auto tmpImageView = m_device->createImageView(dstImage, imageViewInfo);
-
-    VkExtent3D imageExtent = dstImage->mipLevelExtent(dstSubresource.mipLevel);
+    const Rc<DxvkImageView>&       dstView,
+    const Rc<DxvkBuffer>&          srcBuffer) const {
+    VkExtent3D imageExtent = dstView->mipLevelExtent(0);
     imageExtent = VkExtent3D{ imageExtent.width  / videoFormat.MacroPixelSize.width,
                               imageExtent.height / videoFormat.MacroPixelSize.height,
                               1 };
 
-    DxvkBufferViewCreateInfo bufferViewInfo;
-    bufferViewInfo.format      = VK_FORMAT_R32_UINT;
-    bufferViewInfo.rangeOffset = 0;
-    bufferViewInfo.rangeLength = srcBuffer->info().size;
-    auto tmpBufferView = m_device->createBufferView(srcBuffer, bufferViewInfo);
-
-    if (videoFormat.FormatType == D3D9VideoFormat_UYVY
-     || videoFormat.FormatType == D3D9VideoFormat_YUY2) {
-      m_context->setSpecConstant(VK_PIPELINE_BIND_POINT_COMPUTE, 0, videoFormat.FormatType == D3D9VideoFormat_UYVY);
-    }
-
-    m_context->bindResourceView(BindingIds::Image,  tmpImageView, nullptr);
-    m_context->bindResourceView(BindingIds::Buffer, nullptr,     tmpBufferView);
-    m_context->bindShader(VK_SHADER_STAGE_COMPUTE_BIT, m_shaders[videoFormat.FormatType]);
-    m_context->pushConstants(0, sizeof(VkExtent2D), &imageExtent);
-    m_context->dispatch(
-      (imageExtent.width  / 8) + (imageExtent.width  % 8),
-      (imageExtent.height / 8) + (imageExtent.height % 8),
+    // D3D9 does not use compute spec constants otherwise,
+    // so there is no need to reset this after the dispatch
+    ctx->setSpecConstant(VK_PIPELINE_BIND_POINT_COMPUTE, 0,
+      videoFormat.FormatType == D3D9VideoFormat_UYVY);
+
+    ctx->bindResourceView(BindingIds::Image, dstView, nullptr);
+    ctx->bindResourceBuffer(BindingIds::Buffer, DxvkBufferSlice(srcBuffer));
+    ctx->bindShader(VK_SHADER_STAGE_COMPUTE_BIT, m_shaders[videoFormat.FormatType]);
+    ctx->pushConstants(PushConstantOffset, sizeof(VkExtent2D), &imageExtent);
+    ctx->dispatch(
+      (imageExtent.width  + 7) / 8,
+      (imageExtent.height + 7) / 8,
       1);
 
-    // Reset the spec constants used...
-    m_context->setSpecConstant(VK_PIPELINE_BIND_POINT_COMPUTE, 0, 0);
-    
-    m_context->flushCommandList();
+    // Don't keep the source buffer alive any longer than necessary
+    ctx->bindResourceView(BindingIds::Image, nullptr, nullptr);
+    ctx->bindResourceBuffer(BindingIds::Buffer, DxvkBufferSlice());
   }
 
 
@@ -73,10 +57,19 @@ namespace dxvk {
       { BindingIds::Buffer, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_IMAGE_VIEW_TYPE_1D },
     } };
 
+    // The shader uses indices into the slot array as binding
+    // IDs, so that the actual slots are only defined once
+    for (auto ins : code) {
+      if (ins.opCode() == spv::OpDecorate
+       && ins.arg(2) == spv::DecorationBinding
+       && ins.arg(3) < resourceSlots.size())
+        ins.setArg(3, resourceSlots[ins.arg(3)].slot);
+    }
+
     return m_device->createShader(
       VK_SHADER_STAGE_COMPUTE_BIT,
       resourceSlots.size(), resourceSlots.data(),
-      { 0u, 0u, 0u, sizeof(VkExtent2D) }, code);
+      { 0u, 0u, PushConstantOffset, sizeof(VkExtent2D) }, code);
   }
 
 }
\ No newline at end of file
@@ -13,25 +13,43 @@ namespace dxvk {
 
     D3D9FormatHelper(const Rc<DxvkDevice>& device);
 
+    /**
+     * \brief Converts video format data into an image
+     *
+     * Records a compute dispatch on the device's main
+     * context, so that conversions are ordered with and
+     * batched into the regular command stream. Must only
+     * be called from the CS thread.
+     * \param [in] ctx The device's context
+     * \param [in] videoFormat Source video format
+     * \param [in] dstView Storage view of the destination subresource
+     * \param [in] srcBuffer Buffer containing the video data
+     */
     void ConvertVideoFormat(
+            DxvkContext*             ctx,
             D3D9_VIDEO_FORMAT_INFO   videoFormat,
-      const Rc<DxvkImage>&           dstImage,
-            VkImageSubresourceLayers dstSubresource,
-      const Rc<DxvkBuffer>&          srcBuffer);
+      const Rc<DxvkImageView>&       dstView,
+      const Rc<DxvkBuffer>&          srcBuffer) const;
 
   private:
 
+    // The conversion shaders share the main context with the
+    // D3D9 shaders, so their resource slots and push constants
+    // must not overlap with anything those shaders use. The
+    // highest slot used by D3D9 is the depth view of pixel
+    // shader sampler 16, see computeResourceSlotId.
     enum BindingIds : uint32_t {
-      Image  = 0,
-      Buffer = 1,
+      Image  = 49,
+      Buffer = 50,
     };
 
+    static constexpr uint32_t PushConstantOffset = 48;
+
     void InitShaders();
 
     Rc<DxvkShader> InitShader(SpirvCodeBuffer code);
 
     Rc<DxvkDevice>    m_device;
-    Rc<DxvkContext>   m_context;
 
     std::array<Rc<DxvkShader>, D3D9VideoFormat_Count> m_shaders;
 
@@ -7,6 +7,10 @@ namespace dxvk {
 
   D3D9CommonShader::D3D9CommonShader() {}
 
+  D3D9CommonShader::D3D9CommonShader(
+            D3D9ShaderTask*       pTask)
+    : m_task( pTask ) { }
+
   D3D9CommonShader::D3D9CommonShader(
             D3D9DeviceEx*         pDevice,
             VkShaderStageFlagBits ShaderStage,
@@ -22,8 +26,21 @@ namespace dxvk {
     DxvkShaderKey shaderKey = { ShaderStage, *pHash };
 
     const std::string name = shaderKey.toString();
-    Logger::debug(str::format("Compiling shader ", name));
-    
+
+    const D3D9ConstantLayout& constantLayout = ShaderStage == VK_SHADER_STAGE_VERTEX_BIT
+      ? pDevice->GetVertexConstantLayout()
+      : pDevice->GetPixelConstantLayout();
+
+    // Check whether the translated shader is already stored in
+    // the on-disk shader cache before invoking the compiler.
+    Rc<DxvkShaderCache> shaderCache = pDevice->GetDXVKDevice()->getShaderCache();
+
+    DxvkShaderCacheKey cacheKey;
+    cacheKey.shader  = shaderKey;
+    cacheKey.options = GetOptionsHash(pDxsoModuleInfo, constantLayout);
+
+    DxvkShaderCacheEntryData cacheData;
+
     // If requested by the user, dump both the raw DXBC
     // shader and the compiled SPIR-V module to a file.
     const std::string dumpPath = env::getEnvVar("DXVK_SHADER_DUMP_PATH");
@@ -50,30 +67,28 @@ namespace dxvk {
           blob->GetBufferSize());
       }
     }
-    
-    // Decide whether we need to create a pass-through
-    // geometry shader for vertex shader stream output
-
-    const D3D9ConstantLayout& constantLayout = ShaderStage == VK_SHADER_STAGE_VERTEX_BIT
-      ? pDevice->GetVertexConstantLayout()
-      : pDevice->GetPixelConstantLayout();
 
-    m_shaders      = pModule->compile(*pDxsoModuleInfo, name, AnalysisInfo, constantLayout);
-    m_isgn         = pModule->isgn();
-    m_usedSamplers = pModule->usedSamplers();
-    m_usedRTs      = pModule->usedRTs();
+    if (shaderCache == nullptr
+     || !shaderCache->lookup(cacheKey, cacheData)
+     || !Deserialize(cacheData)) {
+      Logger::debug(str::format("Compiling shader ", name));
 
-    m_info      = pModule->info();
-    m_meta      = pModule->meta();
-    m_constants = pModule->constants();
+      m_shaders      = pModule->compile(*pDxsoModuleInfo, name, AnalysisInfo, constantLayout);
+      m_isgn         = pModule->isgn();
+      m_usedSamplers = pModule->usedSamplers();
+      m_usedRTs      = pModule->usedRTs();
 
-    m_shaders[0]->setShaderKey(shaderKey);
+      m_info      = pModule->info();
+      m_meta      = pModule->meta();
+      m_constants = pModule->constants();
 
-    if (m_shaders[1] != nullptr) {
-      // Lets lie about the shader key type for the state cache.
-      m_shaders[1]->setShaderKey({ VK_SHADER_STAGE_TESSELLATION_CONTROL_BIT, *pHash });
+      if (shaderCache != nullptr) {
+        cacheData = DxvkShaderCacheEntryData();
+        Serialize(cacheData);
+        shaderCache->insert(cacheKey, std::move(cacheData));
+      }
     }
-    
+
     if (dumpPath.size() != 0) {
       std::ofstream dumpStream(
         str::format(dumpPath, "/", name, ".spv"),
@@ -82,6 +97,13 @@ namespace dxvk {
       m_shaders[0]->dump(dumpStream);
     }
 
+    m_shaders[0]->setShaderKey(shaderKey);
+
+    if (m_shaders[1] != nullptr) {
+      // Lets lie about the shader key type for the state cache.
+      m_shaders[1]->setShaderKey({ VK_SHADER_STAGE_TESSELLATION_CONTROL_BIT, *pHash });
+    }
+
     pDevice->GetDXVKDevice()->registerShader(m_shaders[0]);
 
     if (m_shaders[1] != nullptr)
@@ -89,6 +111,228 @@ namespace dxvk {
   }
 
 
+  std::string D3D9CommonShader::GetName() const {
+    const auto& shader = GetModule().m_shaders[D3D9ShaderPermutations::None];
+
+    // Shaders whose deferred translation failed have no module
+    if (unlikely(shader == nullptr))
+      return m_task != nullptr ? m_task->GetName() : std::string();
+
+    return shader->debugName();
+  }
+
+
+  void D3D9CommonShader::FinishTranslation() const {
+    if (m_task != nullptr)
+      m_task->wait();
+  }
+
+
+  void D3D9CommonShader::Serialize(DxvkShaderCacheEntryData& Data) const {
+    uint32_t shaderMask = 0;
+
+    for (uint32_t i = 0; i < m_shaders.size(); i++) {
+      if (m_shaders[i] != nullptr)
+        shaderMask |= 1u << i;
+    }
+
+    Data.write(shaderMask);
+
+    for (uint32_t i = 0; i < m_shaders.size(); i++) {
+      if (m_shaders[i] != nullptr)
+        m_shaders[i]->serialize(Data);
+    }
+
+    Data.write(m_isgn.elemCount);
+
+    for (uint32_t i = 0; i < m_isgn.elemCount; i++) {
+      const DxsoIsgnEntry& elem = m_isgn.elems[i];
+
+      uint8_t mask = 0;
+
+      for (uint32_t j = 0; j < 4; j++)
+        mask |= elem.mask[j] ? (1u << j) : 0u;
+
+      Data.write(elem.regNumber);
+      Data.write(elem.slot);
+      Data.write(elem.semantic.usage);
+      Data.write(elem.semantic.usageIndex);
+      Data.write(mask);
+      Data.write(elem.centroid);
+    }
+
+    Data.write(m_usedSamplers);
+    Data.write(m_usedRTs);
+    Data.write(m_info.type());
+    Data.write(m_info.minorVersion());
+    Data.write(m_info.majorVersion());
+    Data.write(m_meta.needsConstantCopies);
+    Data.write(m_meta.maxConstIndexF);
+    Data.write(m_meta.maxConstIndexI);
+    Data.write(m_meta.maxConstIndexB);
+    Data.write(uint32_t(m_constants.size()));
+
+    for (const auto& constant : m_constants) {
+      Data.write(constant.uboIdx);
+
+      for (uint32_t i = 0; i < 4; i++)
+        Data.write(constant.float32[i]);
+    }
+  }
+
+
+  bool D3D9CommonShader::Deserialize(DxvkShaderCacheEntryData& Data) {
+    uint32_t shaderMask = 0;
+
+    if (!Data.read(shaderMask) || !(shaderMask & 1))
+      return false;
+
+    for (uint32_t i = 0; i < m_shaders.size(); i++) {
+      if (shaderMask & (1u << i)) {
+        m_shaders[i] = DxvkShader::deserialize(Data);
+
+        if (m_shaders[i] == nullptr)
+          return false;
+      }
+    }
+
+    if (!Data.read(m_isgn.elemCount)
+     || m_isgn.elemCount > m_isgn.elems.size())
+      return false;
+
+    for (uint32_t i = 0; i < m_isgn.elemCount; i++) {
+      DxsoIsgnEntry& elem = m_isgn.elems[i];
+
+      uint8_t mask = 0;
+
+      if (!Data.read(elem.regNumber)
+       || !Data.read(elem.slot)
+       || !Data.read(elem.semantic.usage)
+       || !Data.read(elem.semantic.usageIndex)
+       || !Data.read(mask)
+       || !Data.read(elem.centroid))
+        return false;
+
+      elem.mask = DxsoRegMask(mask);
+    }
+
+    DxsoProgramType programType = DxsoProgramType(0);
+    uint32_t        minorVersion = 0;
+    uint32_t        majorVersion = 0;
+    uint32_t        constantCount = 0;
+
+    if (!Data.read(m_usedSamplers)
+     || !Data.read(m_usedRTs)
+     || !Data.read(programType)
+     || !Data.read(minorVersion)
+     || !Data.read(majorVersion)
+     || !Data.read(m_meta.needsConstantCopies)
+     || !Data.read(m_meta.maxConstIndexF)
+     || !Data.read(m_meta.maxConstIndexI)
+     || !Data.read(m_meta.maxConstIndexB)
+     || !Data.read(constantCount))
+      return false;
+
+    m_info = DxsoProgramInfo(programType, minorVersion, majorVersion);
+
+    // Each constant takes up 20 bytes, this avoids
+    // allocating excessive amounts of memory for bad data
+    if (constantCount > (Data.size() - Data.readOffset()) / 20)
+      return false;
+
+    m_constants.resize(constantCount);
+
+    for (auto& constant : m_constants) {
+      if (!Data.read(constant.uboIdx))
+        return false;
+
+      for (uint32_t i = 0; i < 4; i++) {
+        if (!Data.read(constant.float32[i]))
+          return false;
+      }
+    }
+
+    return true;
+  }
+
+
+  uint64_t D3D9CommonShader::GetOptionsHash(
+    const DxsoModuleInfo*       pDxsoModuleInfo,
+    const D3D9ConstantLayout&   ConstantLayout) {
+    DxvkHashState hash;
+    hash.add(pDxsoModuleInfo->options.hash());
+    hash.add(ConstantLayout.floatCount);
+    hash.add(ConstantLayout.intCount);
+    hash.add(ConstantLayout.boolCount);
+    hash.add(ConstantLayout.bitmaskCount);
+    return hash;
+  }
+
+
+  D3D9ShaderTask::D3D9ShaderTask(
+            D3D9DeviceEx*         pDevice,
+            VkShaderStageFlagBits ShaderStage,
+      const Sha1Hash*             pHash,
+      const DxsoModuleInfo*       pDxsoModuleInfo,
+      const void*                 pShaderBytecode,
+      const DxsoAnalysisInfo&     AnalysisInfo)
+    : m_device     ( pDevice )
+    , m_stage      ( ShaderStage )
+    , m_hash       ( *pHash )
+    , m_moduleInfo ( *pDxsoModuleInfo )
+    , m_analysis   ( AnalysisInfo )
+    , m_bytecode   ( AnalysisInfo.bytecodeByteLength ) {
+    std::memcpy(m_bytecode.data(), pShaderBytecode, m_bytecode.size());
+  }
+
+
+  D3D9ShaderTask::~D3D9ShaderTask() {
+
+  }
+
+
+  bool D3D9ShaderTask::run() {
+    // The header was already parsed when the task got created
+    DxsoReader reader(
+      reinterpret_cast<const char*>(m_bytecode.data()));
+
+    DxsoModule module(reader);
+
+    try {
+      m_module = D3D9CommonShader(
+        m_device, m_stage, &m_hash,
+        &m_moduleInfo, m_bytecode.data(),
+        m_analysis, &module);
+    } catch (const DxvkError& e) {
+      Logger::err(e.message());
+
+      // The creation call has already succeeded, so keep
+      // what the application can still query. The shader
+      // itself stays null and will not be bound.
+      m_module = D3D9CommonShader();
+      m_module.m_info     = module.info();
+      m_module.m_bytecode = std::move(m_bytecode);
+      return false;
+    }
+
+    m_bytecode = std::vector<uint8_t>();
+    return true;
+  }
+
+
+  void D3D9ShaderTask::WaitForModule() {
+    m_device->GetDXVKDevice()->waitForShaderTask(this);
+  }
+
+
+  D3D9ShaderModuleSet::~D3D9ShaderModuleSet() {
+    // Translation tasks keep a pointer to the device, so
+    // they need to finish before the device is destroyed
+    for (const auto& pair : m_modules)
+      pair.second.FinishTranslation();
+  }
+
+
   D3D9CommonShader D3D9ShaderModuleSet::GetShaderModule(
             D3D9DeviceEx*         pDevice,
             VkShaderStageFlagBits ShaderStage,
@@ -120,6 +364,27 @@ namespace dxvk {
         return entry->second;
     }
     
+    if (pDevice->GetDXVKDevice()->config().enableAsyncShaders) {
+      Rc<D3D9ShaderTask> task = new D3D9ShaderTask(
+        pDevice, ShaderStage, &hash,
+        pDxbcModuleInfo, pShaderBytecode,
+        info);
+
+      D3D9CommonShader commonShader(task.ptr());
+
+      // Insert the module before queueing the task, so that
+      // we never translate the same shader more than once
+      { std::unique_lock<std::mutex> lock(m_mutex);
+
+        auto status = m_modules.insert({ lookupKey, commonShader });
+        if (!status.second)
+          return status.first->second;
+      }
+
+      pDevice->GetDXVKDevice()->queueShaderTask(task);
+      return commonShader;
+    }
+
     // This shader has not been compiled yet, so we have to create a
     // new module. This takes a while, so we won't lock the structure.
     D3D9CommonShader commonShader(
@@ -9,6 +9,7 @@
 
 namespace dxvk {
 
+  class D3D9ShaderTask;
 
   /**
    * \brief Common shader object
@@ -18,7 +19,7 @@ namespace dxvk {
    * used to identify the shader.
    */
   class D3D9CommonShader {
-
+    friend class D3D9ShaderTask;
   public:
 
     D3D9CommonShader();
@@ -32,35 +33,44 @@ namespace dxvk {
       const DxsoAnalysisInfo&     AnalysisInfo,
             DxsoModule*           pModule);
 
+    D3D9CommonShader(
+            D3D9ShaderTask*       pTask);
+
 
     Rc<DxvkShader> GetShader(D3D9ShaderPermutation Permutation) const {
-      return m_shaders[Permutation];
+      return GetModule().m_shaders[Permutation];
     }
 
-    std::string GetName() const {
-      return m_shaders[D3D9ShaderPermutations::None]->debugName();
-    }
+    std::string GetName() const;
 
     const std::vector<uint8_t>& GetBytecode() const {
-      return m_bytecode;
+      return GetModule().m_bytecode;
     }
 
     const DxsoIsgn& GetIsgn() const {
-      return m_isgn;
+      return GetModule().m_isgn;
     }
 
-    const DxsoShaderMetaInfo& GetMeta() const { return m_meta; }
-    const DxsoDefinedConstants& GetConstants() const { return m_constants; }
+    const DxsoShaderMetaInfo& GetMeta() const { return GetModule().m_meta; }
+    const DxsoDefinedConstants& GetConstants() const { return GetModule().m_constants; }
+
+    D3D9ShaderMasks GetShaderMask() const { return D3D9ShaderMasks{ GetModule().m_usedSamplers, GetModule().m_usedRTs }; }
 
-    D3D9ShaderMasks GetShaderMask() const { return D3D9ShaderMasks{ m_usedSamplers, m_usedRTs }; }
+    const DxsoProgramInfo& GetInfo() const { return GetModule().m_info; }
 
-    const DxsoProgramInfo& GetInfo() const { return m_info; }
+    /**
+     * \brief Waits for pending translation
+     *
+     * Unlike the accessor methods, this does not
+     * count as a stall in the device statistics.
+     */
+    void FinishTranslation() const;
 
   private:
 
     DxsoIsgn              m_isgn;
-    uint32_t              m_usedSamplers;
-    uint32_t              m_usedRTs;
+    uint32_t              m_usedSamplers = 0;
+    uint32_t              m_usedRTs      = 0;
 
     DxsoProgramInfo       m_info;
     DxsoShaderMetaInfo    m_meta;
@@ -70,8 +80,75 @@ namespace dxvk {
 
     std::vector<uint8_t>  m_bytecode;
 
+    Rc<D3D9ShaderTask>    m_task;
+
+    const D3D9CommonShader& GetModule() const;
+
+    void Serialize(DxvkShaderCacheEntryData& Data) const;
+
+    bool Deserialize(DxvkShaderCacheEntryData& Data);
+
+    static uint64_t GetOptionsHash(
+      const DxsoModuleInfo*       pDxsoModuleInfo,
+      const D3D9ConstantLayout&   ConstantLayout);
+
   };
 
+  /**
+   * \brief Shader translation task
+   *
+   * Translates a shader on a worker thread. Owns a copy
+   * of the bytecode, so that the shader creation call
+   * can return before the shader is ready.
+   */
+  class D3D9ShaderTask : public DxvkShaderTask {
+
+  public:
+
+    D3D9ShaderTask(
+            D3D9DeviceEx*         pDevice,
+            VkShaderStageFlagBits ShaderStage,
+      const Sha1Hash*             pHash,
+      const DxsoModuleInfo*       pDxsoModuleInfo,
+      const void*                 pShaderBytecode,
+      const DxsoAnalysisInfo&     AnalysisInfo);
+
+    ~D3D9ShaderTask();
+
+    const D3D9CommonShader& GetModule() {
+      if (unlikely(!isDone()))
+        WaitForModule();
+
+      return m_module;
+    }
+
+    std::string GetName() const {
+      return DxvkShaderKey(m_stage, m_hash).toString();
+    }
+
+  protected:
+
+    bool run();
+
+  private:
+
+    D3D9DeviceEx*         m_device;
+    VkShaderStageFlagBits m_stage;
+    Sha1Hash              m_hash;
+    DxsoModuleInfo        m_moduleInfo;
+    DxsoAnalysisInfo      m_analysis;
+    std::vector<uint8_t>  m_bytecode;
+
+    D3D9CommonShader      m_module;
+
+    void WaitForModule();
+
+  };
+
+  inline const D3D9CommonShader& D3D9CommonShader::GetModule() const {
+    return likely(m_task == nullptr) ? *this : m_task->GetModule();
+  }
+
   /**
    * \brief Common shader interface
    * 
@@ -170,6 +247,8 @@ namespace dxvk {
     
   public:
     
+    ~D3D9ShaderModuleSet();
+
     D3D9CommonShader GetShaderModule(
             D3D9DeviceEx*         pDevice,
             VkShaderStageFlagBits ShaderStage,
@@ -272,7 +272,7 @@ namespace dxvk {
       }
     }
 
-    Rc<DxvkShader> finalize() {
+    Rc<DxvkShader> finalize(const DxvkShaderOptions& shaderOptions) {
       m_module.opReturn();
       m_module.functionEnd();
 
@@ -290,7 +290,7 @@ namespace dxvk {
         m_resourceSlots.data(),
         m_interfaceSlots,
         m_module.compile(),
-        DxvkShaderOptions(),
+        shaderOptions,
         std::move(constData));
     }
 
@@ -327,7 +327,11 @@ namespace dxvk {
     // new module. This takes a while, so we won't lock the structure.
     D3D9SWVPEmulatorGenerator generator(name);
     generator.compile(pDecl);
-    Rc<DxvkShader> shader = generator.finalize();
+
+    DxvkShaderOptions shaderOptions = { };
+    shaderOptions.disableOptimizer = !pDevice->GetDXVKDevice()->config().enableSpirvOptimizer;
+
+    Rc<DxvkShader> shader = generator.finalize(shaderOptions);
 
     shader->setShaderKey(key);
     pDevice->GetDXVKDevice()->registerShader(shader);
@@ -244,6 +244,7 @@ namespace dxvk {
     m_module.setDebugName(m_entryPointId, "main");
 
     DxvkShaderOptions shaderOptions = { };
+    shaderOptions.disableOptimizer = !m_moduleInfo.options.enableSpirvOptimizer;
 
     if (m_moduleInfo.xfb != nullptr) {
       shaderOptions.rasterizedStream = m_moduleInfo.xfb->rasterizedStream;
@@ -357,4 +357,74 @@ namespace dxvk {
     }
   }
   
+  
+  DxbcInstructionList::DxbcInstructionList(DxbcCodeSlice code) {
+    DxbcDecodeContext decoder;
+    
+    std::vector<OperandOffsets> offsets;
+    std::vector<IndexFixup>     fixups;
+    
+    while (!code.atEnd()) {
+      decoder.decodeInstruction(code);
+      
+      this->addInstruction(
+        decoder.getInstruction(),
+        offsets, fixups);
+    }
+    
+    // The arrays do not grow anymore, so we can safely
+    // resolve all offsets into pointers at this point.
+    for (size_t i = 0; i < m_instructions.size(); i++) {
+      m_instructions[i].dst = m_registers.data()  + offsets[i].dst;
+      m_instructions[i].src = m_registers.data()  + offsets[i].src;
+      m_instructions[i].imm = m_immediates.data() + offsets[i].imm;
+    }
+    
+    for (const auto& fixup : fixups) {
+      m_registers[fixup.regId].idx[fixup.idxId].relReg
+        = &m_registers[fixup.relRegId];
+    }
+  }
+  
+  
+  void DxbcInstructionList::addInstruction(
+    const DxbcShaderInstruction&        ins,
+          std::vector<OperandOffsets>&  offsets,
+          std::vector<IndexFixup>&      fixups) {
+    OperandOffsets operands;
+    operands.dst = m_registers.size();
+    operands.src = operands.dst + ins.dstCount;
+    operands.imm = m_immediates.size();
+    
+    // Destination and source operands must be stored
+    // in contiguous ranges, so we need to add any
+    // relative index registers after both of them.
+    m_registers.insert(m_registers.end(), ins.dst, ins.dst + ins.dstCount);
+    m_registers.insert(m_registers.end(), ins.src, ins.src + ins.srcCount);
+    m_immediates.insert(m_immediates.end(), ins.imm, ins.imm + ins.immCount);
+    
+    for (uint32_t i = 0; i < ins.dstCount + ins.srcCount; i++)
+      this->addRelativeIndices(operands.dst + i, fixups);
+    
+    m_instructions.push_back(ins);
+    offsets.push_back(operands);
+  }
+  
+  
+  void DxbcInstructionList::addRelativeIndices(
+          uint32_t                      regId,
+          std::vector<IndexFixup>&      fixups) {
+    for (uint32_t i = 0; i < m_registers[regId].idxDim; i++) {
+      const DxbcRegister* relReg = m_registers[regId].idx[i].relReg;
+      
+      if (relReg != nullptr) {
+        uint32_t relRegId = m_registers.size();
+        m_registers.push_back(*relReg);
+        
+        fixups.push_back({ regId, i, relRegId });
+        this->addRelativeIndices(relRegId, fixups);
+      }
+    }
+  }
+  
 }
\ No newline at end of file
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <array>
+#include <vector>
 
 #include "dxbc_common.h"
 #include "dxbc_decoder.h"
@@ -497,4 +498,75 @@ namespace dxvk {
     
   };
   
+  
+  /**
+   * \brief Decoded instruction stream
+   * 
+   * Decodes an entire code slice in a single pass and
+   * stores the instructions, their operands and their
+   * immediates in flat arrays. Unlike the instructions
+   * returned by a \ref DxbcDecodeContext, these remain
+   * valid for as long as the list and the underlying
+   * code slice are alive, so that the instructions can
+   * be processed multiple times without re-decoding.
+   */
+  class DxbcInstructionList {
+    
+  public:
+    
+    DxbcInstructionList(DxbcCodeSlice code);
+    
+    DxbcInstructionList             (const DxbcInstructionList&) = delete;
+    DxbcInstructionList& operator = (const DxbcInstructionList&) = delete;
+    
+    /**
+     * \brief Number of instructions
+     * \returns Instruction count
+     */
+    size_t size() const {
+      return m_instructions.size();
+    }
+    
+    /**
+     * \brief Retrieves an instruction
+     * 
+     * \param [in] id Instruction index
+     * \returns The decoded instruction
+     */
+    const DxbcShaderInstruction& operator [] (size_t id) const {
+      return m_instructions[id];
+    }
+    
+    auto begin() const { return m_instructions.cbegin(); }
+    auto end()   const { return m_instructions.cend(); }
+    
+  private:
+    
+    struct OperandOffsets {
+      uint32_t dst;
+      uint32_t src;
+      uint32_t imm;
+    };
+    
+    struct IndexFixup {
+      uint32_t regId;
+      uint32_t idxId;
+      uint32_t relRegId;
+    };
+    
+    std::vector<DxbcShaderInstruction> m_instructions;
+    std::vector<DxbcRegister>          m_registers;
+    std::vector<DxbcImmediate>         m_immediates;
+    
+    void addInstruction(
+      const DxbcShaderInstruction&        ins,
+            std::vector<OperandOffsets>&  offsets,
+            std::vector<IndexFixup>&      fixups);
+    
+    void addRelativeIndices(
+            uint32_t                      regId,
+            std::vector<IndexFixup>&      fixups);
+    
+  };
+  
 }
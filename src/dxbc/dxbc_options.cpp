@@ -40,6 +40,7 @@ namespace dxvk {
     enableRtOutputNanFixup   = options.enableRtOutputNanFixup;
     zeroInitWorkgroupMemory  = options.zeroInitWorkgroupMemory;
     dynamicIndexedConstantBufferAsSsbo = options.constantBufferRangeCheck;
+    enableSpirvOptimizer     = device->config().enableSpirvOptimizer;
     
     // Disable early discard on RADV (with LLVM) due to GPU hangs
     // Disable early discard on Nvidia because it may hurt performance
@@ -57,4 +58,21 @@ namespace dxvk {
     applyTristate(useSubgroupOpsForEarlyDiscard, device->config().useEarlyDiscard);
   }
   
+  
+  size_t DxbcOptions::hash() const {
+    DxvkHashState hash;
+    hash.add(useDepthClipWorkaround);
+    hash.add(useStorageImageReadWithoutFormat);
+    hash.add(useSubgroupOpsForAtomicCounters);
+    hash.add(useDemoteToHelperInvocation);
+    hash.add(useSubgroupOpsForEarlyDiscard);
+    hash.add(useSdivForBufferIndex);
+    hash.add(enableRtOutputNanFixup);
+    hash.add(dynamicIndexedConstantBufferAsSsbo);
+    hash.add(zeroInitWorkgroupMemory);
+    hash.add(size_t(minSsboAlignment));
+    hash.add(enableSpirvOptimizer);
+    return hash;
+  }
+  
 }
\ No newline at end of file
@@ -10,6 +10,15 @@ namespace dxvk {
     DxbcOptions();
     DxbcOptions(const Rc<DxvkDevice>& device, const D3D11Options& options);
 
+    /**
+     * \brief Computes hash of all options
+     *
+     * Used to identify translated shaders
+     * in the on-disk shader cache.
+     * \returns Hash value
+     */
+    size_t hash() const;
+
     // Clamp oDepth in fragment shaders if the depth
     // clip device feature is not supported
     bool useDepthClipWorkaround = false;
@@ -44,6 +53,9 @@ namespace dxvk {
 
     /// Minimum storage buffer alignment
     VkDeviceSize minSsboAlignment = 0;
+
+    /// Run the SPIR-V optimizer on the generated code
+    bool enableSpirvOptimizer = true;
   };
   
 }
\ No newline at end of file
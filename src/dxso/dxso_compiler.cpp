@@ -231,6 +231,8 @@ namespace dxvk {
 
   Rc<DxvkShader> DxsoCompiler::compileShader() {
     DxvkShaderOptions shaderOptions = { };
+    shaderOptions.disableOptimizer = !m_moduleInfo.options.enableSpirvOptimizer;
+
     DxvkShaderConstData constData = { };
 
     return new DxvkShader(
@@ -37,6 +37,22 @@ namespace dxvk {
     shaderModel          = options.shaderModel;
 
     invariantPosition    = options.invariantPosition;
+
+    enableSpirvOptimizer = device->config().enableSpirvOptimizer;
+  }
+
+
+  size_t DxsoOptions::hash() const {
+    DxvkHashState hash;
+    hash.add(useDemoteToHelperInvocation);
+    hash.add(useSubgroupOpsForEarlyDiscard);
+    hash.add(strictConstantCopies);
+    hash.add(d3d9FloatEmulation);
+    hash.add(strictPow);
+    hash.add(shaderModel);
+    hash.add(invariantPosition);
+    hash.add(enableSpirvOptimizer);
+    return hash;
   }
 
 }
\ No newline at end of file
@@ -11,6 +11,15 @@ namespace dxvk {
     DxsoOptions();
     DxsoOptions(const Rc<DxvkDevice>& device, const D3D9Options& options);
 
+    /**
+     * \brief Computes hash of all options
+     *
+     * Used to identify translated shaders
+     * in the on-disk shader cache.
+     * \returns Hash value
+     */
+    size_t hash() const;
+
     /// Use a SPIR-V extension to implement D3D-style discards
     bool useDemoteToHelperInvocation = false;
 
@@ -37,6 +46,9 @@ namespace dxvk {
     /// Work around a NV driver quirk
     /// Fixes flickering/z-fighting in some games.
     bool invariantPosition;
+
+    /// Run the SPIR-V optimizer on the generated code
+    bool enableSpirvOptimizer = true;
   };
 
 }
\ No newline at end of file
@@ -17,9 +17,10 @@ namespace dxvk {
     // Align slices so that we don't violate any alignment
     // requirements imposed by the Vulkan device/driver
     VkDeviceSize sliceAlignment = computeSliceAlignment();
-    m_physSliceLength = createInfo.size;
-    m_physSliceStride = align(createInfo.size, sliceAlignment);
-    m_physSliceCount  = std::max<VkDeviceSize>(1, 256 / m_physSliceStride);
+    m_physSliceLength    = createInfo.size;
+    m_physSliceStride    = align(createInfo.size, sliceAlignment);
+    m_physSliceCount     = std::max<VkDeviceSize>(1, 256 / m_physSliceStride);
+    m_physSliceBaseCount = m_physSliceCount;
 
     // Limit size of multi-slice buffers to reduce fragmentation
     constexpr VkDeviceSize MaxBufferSize = 4 << 20;
@@ -43,12 +44,87 @@ namespace dxvk {
 
 
   DxvkBuffer::~DxvkBuffer() {
+    if (m_trimRegistered)
+      m_device->m_objects.bufferTrimList().unregisterBuffer(this);
+
     auto vkd = m_device->vkd();
 
     for (const auto& buffer : m_buffers)
-      vkd->vkDestroyBuffer(vkd->device(), buffer.buffer, nullptr);
+      vkd->vkDestroyBuffer(vkd->device(), buffer.handle.buffer, nullptr);
     vkd->vkDestroyBuffer(vkd->device(), m_buffer.buffer, nullptr);
   }
+
+
+  bool DxvkBuffer::trim(uint32_t frameId) {
+    std::vector<DxvkBufferHandle> handles;
+    bool hasBuffers;
+
+    { std::unique_lock<sync::Spinlock> freeLock(m_freeMutex);
+      std::unique_lock<sync::Spinlock> swapLock(m_swapMutex);
+
+      if (m_buffers.empty())
+        return false;
+
+      // A backing buffer is idle if all of its slices are
+      // free and none of them have been allocated since
+      // the last time the buffer has been trimmed.
+      for (auto i = m_buffers.begin(); i != m_buffers.end(); ) {
+        bool idle = !i->used && i->freeCount == i->allocCount;
+        i->used = false;
+
+        if (!idle)
+          i->idleFrameId = NotIdle;
+        else if (i->idleFrameId == NotIdle)
+          i->idleFrameId = frameId;
+
+        if (i->idleFrameId == NotIdle
+         || frameId - i->idleFrameId < MaxIdleFrames) {
+          i++;
+          continue;
+        }
+
+        // Remove all slices of the buffer from the free lists
+        VkBuffer handle = i->handle.buffer;
+
+        auto isTrimmed = [handle] (const DxvkBufferSliceHandle& slice) {
+          return slice.handle == handle;
+        };
+
+        m_freeSlices.erase(std::remove_if(m_freeSlices.begin(),
+          m_freeSlices.end(), isTrimmed), m_freeSlices.end());
+        m_nextSlices.erase(std::remove_if(m_nextSlices.begin(),
+          m_nextSlices.end(), isTrimmed), m_nextSlices.end());
+
+        handles.push_back(std::move(i->handle));
+        i = m_buffers.erase(i);
+      }
+
+      if (!handles.empty()) {
+        // Grow the buffer from its remaining size
+        // the next time we run out of slices
+        VkDeviceSize sliceCount = m_physSliceBaseCount;
+
+        for (const auto& buffer : m_buffers)
+          sliceCount += buffer.sliceCount;
+
+        m_physSliceCount = std::min(sliceCount, m_physSliceMaxCount);
+        m_trimCount += 1;
+      }
+
+      hasBuffers = !m_buffers.empty();
+    }
+
+    // Destroy the buffers outside of the locked
+    // region, the memory will be freed implicitly
+    auto vkd = m_device->vkd();
+
+    for (const auto& handle : handles) {
+      m_memAlloc->recordTrim(handle.memory);
+      vkd->vkDestroyBuffer(vkd->device(), handle.buffer, nullptr);
+    }
+
+    return hasBuffers;
+  }
   
   
   DxvkBufferHandle DxvkBuffer::allocBuffer(VkDeviceSize sliceCount) const {
@@ -150,6 +226,27 @@ namespace dxvk {
   }
 
 
+  bool DxvkBuffer::isHandleValid(VkBuffer handle, uint32_t trimCount) {
+    std::unique_lock<sync::Spinlock> freeLock(m_freeMutex);
+
+    if (handle == m_buffer.buffer)
+      return true;
+
+    for (const auto& buffer : m_buffers) {
+      if (buffer.handle.buffer == handle)
+        return buffer.trimCount <= trimCount;
+    }
+
+    return false;
+  }
+
+
+  void DxvkBuffer::registerTrim() {
+    m_device->m_objects.bufferTrimList().registerBuffer(this);
+    m_trimRegistered.store(true);
+  }
+
+
 
   
   DxvkBufferView::DxvkBufferView(
@@ -158,7 +255,8 @@ namespace dxvk {
     const DxvkBufferViewCreateInfo& info)
   : m_vkd(vkd), m_info(info), m_buffer(buffer),
     m_bufferSlice (getSliceHandle()),
-    m_bufferView  (createBufferView(m_bufferSlice)) {
+    m_bufferView  (createBufferView(m_bufferSlice)),
+    m_trimCount   (buffer->getTrimCount()) {
     
   }
   
@@ -204,7 +302,7 @@ namespace dxvk {
 
   void DxvkBufferView::updateBufferView(
     const DxvkBufferSliceHandle& slice) {
-    if (m_views.empty())
+    if (m_views.empty() && m_bufferView != VK_NULL_HANDLE)
       m_views.insert({ m_bufferSlice, m_bufferView });
     
     m_bufferSlice = slice;
@@ -219,6 +317,36 @@ namespace dxvk {
   }
   
   
+  void DxvkBufferView::purgeBufferViews(
+          uint32_t              trimCount) {
+    // Destroy views of freed backing buffers. This must happen
+    // before looking up any view since the Vulkan handles of
+    // newly created backing buffers may be the same.
+    if (m_bufferView != VK_NULL_HANDLE
+     && !m_buffer->isHandleValid(m_bufferSlice.handle, m_trimCount)) {
+      if (m_views.empty()) {
+        m_vkd->vkDestroyBufferView(
+          m_vkd->device(), m_bufferView, nullptr);
+      }
+
+      m_bufferSlice = DxvkBufferSliceHandle();
+      m_bufferView  = VK_NULL_HANDLE;
+    }
+
+    for (auto e = m_views.begin(); e != m_views.end(); ) {
+      if (!m_buffer->isHandleValid(e->first.handle, m_trimCount)) {
+        m_vkd->vkDestroyBufferView(
+          m_vkd->device(), e->second, nullptr);
+        e = m_views.erase(e);
+      } else {
+        e++;
+      }
+    }
+
+    m_trimCount = trimCount;
+  }
+  
+  
   DxvkBufferTracker:: DxvkBufferTracker() { }
   DxvkBufferTracker::~DxvkBufferTracker() { }
   
@@ -235,4 +363,35 @@ namespace dxvk {
     m_entries.clear();
   }
   
-}
\ No newline at end of file
+  
+  DxvkBufferTrimList:: DxvkBufferTrimList() { }
+  DxvkBufferTrimList::~DxvkBufferTrimList() { }
+
+
+  void DxvkBufferTrimList::registerBuffer(DxvkBuffer* buffer) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_buffers.insert(buffer);
+  }
+
+
+  void DxvkBufferTrimList::unregisterBuffer(DxvkBuffer* buffer) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_buffers.erase(buffer);
+  }
+
+
+  void DxvkBufferTrimList::trimBuffers(uint32_t frameId) {
+    if (m_frameId.exchange(frameId) == frameId)
+      return;
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    for (auto i = m_buffers.begin(); i != m_buffers.end(); ) {
+      if (!(*i)->trim(frameId))
+        i = m_buffers.erase(i);
+      else
+        i++;
+    }
+  }
+
+}
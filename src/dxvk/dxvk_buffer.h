@@ -1,6 +1,8 @@
 #pragma once
 
+#include <mutex>
 #include <unordered_map>
+#include <unordered_set>
 #include <vector>
 
 #include "dxvk_descriptor.h"
@@ -102,6 +104,10 @@ namespace dxvk {
   class DxvkBuffer : public DxvkResource {
     friend class DxvkBufferView;
   public:
+
+    /// Number of frames for which all slices of a
+    /// backing buffer must be unused before it is freed
+    constexpr static uint32_t MaxIdleFrames = 16;
     
     DxvkBuffer(
             DxvkDevice*           device,
@@ -243,15 +249,26 @@ namespace dxvk {
 
       // If there are still no slices available, create a new
       // backing buffer and add all slices to the free list.
+      bool newBuffer = false;
+
       if (unlikely(m_freeSlices.empty())) {
         if (likely(!m_lazyAlloc)) {
-          DxvkBufferHandle handle = allocBuffer(m_physSliceCount);
+          BackingBuffer buffer;
+          buffer.handle     = allocBuffer(m_physSliceCount);
+          buffer.sliceCount = m_physSliceCount;
+          buffer.trimCount  = m_trimCount.load();
 
           for (uint32_t i = 0; i < m_physSliceCount; i++)
-            pushSlice(handle, i);
+            pushSlice(buffer.handle, i);
+
+          // The free path looks up backing buffers as well
+          { std::unique_lock<sync::Spinlock> swapLock(m_swapMutex);
+            m_buffers.push_back(std::move(buffer));
+          }
 
-          m_buffers.push_back(std::move(handle));
           m_physSliceCount = std::min(m_physSliceCount * 2, m_physSliceMaxCount);
+
+          newBuffer = true;
         } else {
           for (uint32_t i = 1; i < m_physSliceCount; i++)
             pushSlice(m_buffer, i);
@@ -263,6 +280,21 @@ namespace dxvk {
       // Take the first slice from the queue
       DxvkBufferSliceHandle result = m_freeSlices.back();
       m_freeSlices.pop_back();
+
+      // Keep the backing buffer alive while it is in use
+      for (auto& buffer : m_buffers) {
+        if (buffer.handle.buffer == result.handle) {
+          buffer.allocCount += 1;
+          buffer.used = true;
+          break;
+        }
+      }
+
+      freeLock.unlock();
+
+      if (unlikely(newBuffer))
+        this->registerTrim();
+
       return result;
     }
     
@@ -277,11 +309,95 @@ namespace dxvk {
     void freeSlice(const DxvkBufferSliceHandle& slice) {
       // Add slice to a separate free list to reduce lock contention.
       std::unique_lock<sync::Spinlock> swapLock(m_swapMutex);
+
+      // Slices with additional references must stay alive
+      if (unlikely(!m_sliceRefs.empty())) {
+        auto entry = m_sliceRefs.find(slice);
+
+        if (entry != m_sliceRefs.end()) {
+          if (!(--entry->second))
+            m_sliceRefs.erase(entry);
+          return;
+        }
+      }
+
       m_nextSlices.push_back(slice);
+
+      for (auto& buffer : m_buffers) {
+        if (buffer.handle.buffer == slice.handle) {
+          buffer.freeCount += 1;
+          break;
+        }
+      }
     }
+
+    /**
+     * \brief Adds a reference to a buffer slice
+     * 
+     * The slice will only be returned to the free list
+     * once \ref freeSlice has been called one additional
+     * time for each call to this method. This allows a
+     * slice to be used to invalidate the buffer multiple
+     * times without having to copy its contents.
+     * \param [in] slice The buffer slice
+     */
+    void acquireSlice(const DxvkBufferSliceHandle& slice) {
+      std::unique_lock<sync::Spinlock> swapLock(m_swapMutex);
+      m_sliceRefs[slice] += 1;
+    }
+
+    /**
+     * \brief Frees unused backing buffers
+     * 
+     * Releases backing buffers that were allocated for
+     * renaming once none of their slices have been used
+     * for \c MaxIdleFrames frames. Must not be called
+     * more than once per frame.
+     * \param [in] frameId Current frame ID
+     * \returns \c true if the buffer still owns backing
+     *    buffers that may be trimmed at a later point
+     */
+    bool trim(uint32_t frameId);
+
+    /**
+     * \brief Number of freed backing buffers
+     * 
+     * Buffer views use this to detect whether any
+     * of their cached views have become invalid.
+     * \returns Number of freed backing buffers
+     */
+    uint32_t getTrimCount() const {
+      return m_trimCount.load();
+    }
+
+    /**
+     * \brief Checks whether a buffer handle is still valid
+     * 
+     * Since Vulkan handles of freed backing buffers may be
+     * reused, a handle is only considered valid if the
+     * backing buffer existed when the caller last checked.
+     * \param [in] handle Buffer handle
+     * \param [in] trimCount Trim count at the time
+     *    the caller last validated its handles
+     * \returns \c true if the handle still refers to
+     *    the same backing buffer as before
+     */
+    bool isHandleValid(VkBuffer handle, uint32_t trimCount);
     
   private:
 
+    constexpr static uint32_t NotIdle = ~0u;
+
+    struct BackingBuffer {
+      DxvkBufferHandle  handle;
+      VkDeviceSize      sliceCount  = 0;
+      uint64_t          allocCount  = 0;
+      uint64_t          freeCount   = 0;
+      uint32_t          trimCount   = 0;
+      uint32_t          idleFrameId = NotIdle;
+      bool              used        = false;
+    };
+
     DxvkDevice*             m_device;
     DxvkBufferCreateInfo    m_info;
     DxvkMemoryAllocator*    m_memAlloc;
@@ -296,14 +412,22 @@ namespace dxvk {
     sync::Spinlock m_freeMutex;
     sync::Spinlock m_swapMutex;
     
-    std::vector<DxvkBufferHandle>        m_buffers;
+    std::vector<BackingBuffer>           m_buffers;
     std::vector<DxvkBufferSliceHandle>   m_freeSlices;
     std::vector<DxvkBufferSliceHandle>   m_nextSlices;
+
+    std::unordered_map<
+      DxvkBufferSliceHandle, uint32_t,
+      DxvkHash, DxvkEq>                  m_sliceRefs;
+
+    std::atomic<uint32_t>                m_trimCount = { 0u };
+    std::atomic<bool>                    m_trimRegistered = { false };
     
-    VkDeviceSize m_physSliceLength   = 0;
-    VkDeviceSize m_physSliceStride   = 0;
-    VkDeviceSize m_physSliceCount    = 1;
-    VkDeviceSize m_physSliceMaxCount = 1;
+    VkDeviceSize m_physSliceLength    = 0;
+    VkDeviceSize m_physSliceStride    = 0;
+    VkDeviceSize m_physSliceCount     = 1;
+    VkDeviceSize m_physSliceBaseCount = 1;
+    VkDeviceSize m_physSliceMaxCount  = 1;
 
     void pushSlice(const DxvkBufferHandle& handle, uint32_t index) {
       DxvkBufferSliceHandle slice;
@@ -318,10 +442,81 @@ namespace dxvk {
             VkDeviceSize          sliceCount) const;
 
     VkDeviceSize computeSliceAlignment() const;
+
+    void registerTrim();
     
   };
   
   
+  /**
+   * \brief Buffer slice reference
+   * 
+   * Owns a slice that has been allocated from a buffer
+   * and frees it once the reference is destroyed. Any
+   * code that uses the slice to invalidate the buffer
+   * must add a reference to the slice beforehand.
+   */
+  class DxvkBufferSliceRef {
+
+  public:
+
+    DxvkBufferSliceRef() { }
+
+    DxvkBufferSliceRef(
+      const Rc<DxvkBuffer>&             buffer,
+      const DxvkBufferSliceHandle&      slice)
+    : m_buffer(buffer), m_slice(slice) { }
+
+    DxvkBufferSliceRef(DxvkBufferSliceRef&& other)
+    : m_buffer(std::move(other.m_buffer)),
+      m_slice (other.m_slice) {
+      other.m_buffer = nullptr;
+    }
+
+    DxvkBufferSliceRef& operator = (DxvkBufferSliceRef&& other) {
+      this->release();
+      m_buffer = std::move(other.m_buffer);
+      m_slice  = other.m_slice;
+      other.m_buffer = nullptr;
+      return *this;
+    }
+
+    DxvkBufferSliceRef             (const DxvkBufferSliceRef&) = delete;
+    DxvkBufferSliceRef& operator = (const DxvkBufferSliceRef&) = delete;
+
+    ~DxvkBufferSliceRef() {
+      this->release();
+    }
+
+    /**
+     * \brief Buffer that owns the slice
+     * \returns The buffer
+     */
+    const Rc<DxvkBuffer>& buffer() const {
+      return m_buffer;
+    }
+
+    /**
+     * \brief Slice handle
+     * \returns Slice handle
+     */
+    const DxvkBufferSliceHandle& handle() const {
+      return m_slice;
+    }
+
+  private:
+
+    Rc<DxvkBuffer>        m_buffer = nullptr;
+    DxvkBufferSliceHandle m_slice  = { };
+
+    void release() {
+      if (m_buffer != nullptr)
+        m_buffer->freeSlice(m_slice);
+    }
+
+  };
+
+
   /**
    * \brief Buffer slice
    * 
@@ -616,6 +811,13 @@ namespace dxvk {
     void updateView() {
       DxvkBufferSliceHandle slice = getSliceHandle();
 
+      // Read the trim count after the slice so that the
+      // slice's backing buffer is never newer than that
+      uint32_t trimCount = m_buffer->getTrimCount();
+
+      if (unlikely(m_trimCount != trimCount))
+        this->purgeBufferViews(trimCount);
+
       if (!m_bufferSlice.eq(slice))
         this->updateBufferView(slice);
     }
@@ -628,6 +830,7 @@ namespace dxvk {
 
     DxvkBufferSliceHandle     m_bufferSlice;
     VkBufferView              m_bufferView;
+    uint32_t                  m_trimCount;
 
     std::unordered_map<
       DxvkBufferSliceHandle,
@@ -640,6 +843,9 @@ namespace dxvk {
     void updateBufferView(
       const DxvkBufferSliceHandle& slice);
     
+    void purgeBufferViews(
+            uint32_t              trimCount);
+    
   };
   
   
@@ -685,4 +891,52 @@ namespace dxvk {
     
   };
   
+  
+  /**
+   * \brief Buffer trim list
+   * 
+   * Stores buffers that have allocated additional
+   * backing buffers for renaming, so that backing
+   * buffers which are no longer needed can be freed.
+   */
+  class DxvkBufferTrimList {
+
+  public:
+
+    DxvkBufferTrimList();
+    ~DxvkBufferTrimList();
+
+    /**
+     * \brief Adds a buffer to the list
+     * \param [in] buffer The buffer
+     */
+    void registerBuffer(DxvkBuffer* buffer);
+
+    /**
+     * \brief Removes a buffer from the list
+     * 
+     * Must be called before the buffer is destroyed.
+     * \param [in] buffer The buffer
+     */
+    void unregisterBuffer(DxvkBuffer* buffer);
+
+    /**
+     * \brief Trims all buffers
+     * 
+     * Does nothing if buffers have already been
+     * trimmed during the given frame. Buffers which
+     * no longer have any additional backing buffers
+     * will be removed from the list.
+     * \param [in] frameId Current frame ID
+     */
+    void trimBuffers(uint32_t frameId);
+
+  private:
+
+    std::mutex                      m_mutex;
+    std::atomic<uint32_t>           m_frameId = { 0u };
+    std::unordered_set<DxvkBuffer*> m_buffers;
+
+  };
+
 }
\ No newline at end of file
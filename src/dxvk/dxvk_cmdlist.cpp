@@ -160,6 +160,9 @@ namespace dxvk {
   
   
   void DxvkCommandList::endRecording() {
+    m_statCounters.addCtr(DxvkStatCounter::CmdTrackCalls,       m_resources.trackCount());
+    m_statCounters.addCtr(DxvkStatCounter::CmdTrackedResources, m_resources.resourceCount());
+
     if (m_vkd->vkEndCommandBuffer(m_execBuffer) != VK_SUCCESS
      || m_vkd->vkEndCommandBuffer(m_initBuffer) != VK_SUCCESS
      || m_vkd->vkEndCommandBuffer(m_sdmaBuffer) != VK_SUCCESS)
@@ -35,24 +35,31 @@ namespace dxvk {
   VkPipeline DxvkComputePipeline::getPipelineHandle(
     const DxvkComputePipelineStateInfo& state) {
     DxvkComputePipelineInstance* instance = nullptr;
+    VkPipeline pipeline = VK_NULL_HANDLE;
+    bool firstUse = false;
 
     { std::lock_guard<sync::Spinlock> lock(m_mutex);
 
       instance = this->findInstance(state);
 
-      if (instance)
-        return instance->pipeline();
-    
       // If no pipeline instance exists with the given state
       // vector, create a new one and add it to the list.
-      instance = this->createInstance(state);
+      if (!instance)
+        instance = this->createInstance(state);
+
+      if (!instance)
+        return VK_NULL_HANDLE;
+
+      pipeline = instance->pipeline();
+      firstUse = instance->markUsed();
     }
-    
-    if (!instance)
-      return VK_NULL_HANDLE;
 
-    this->writePipelineStateToCache(state);
-    return instance->pipeline();
+    // Also write instances that were compiled ahead of
+    // time, so that the state cache can track usage
+    if (firstUse)
+      this->writePipelineStateToCache(state);
+
+    return pipeline;
   }
 
 
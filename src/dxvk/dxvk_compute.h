@@ -68,10 +68,21 @@ namespace dxvk {
       return m_pipeline;
     }
 
+    /**
+     * \brief Marks the pipeline as used
+     * 
+     * Must be called with the pipeline lock held.
+     * \returns \c true if this is the first use
+     */
+    bool markUsed() {
+      return !std::exchange(m_used, true);
+    }
+
   private:
 
     DxvkComputePipelineStateInfo m_stateVector;
     VkPipeline                   m_pipeline;
+    bool                         m_used = false;
 
   };
   
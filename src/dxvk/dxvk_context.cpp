@@ -33,6 +33,10 @@ namespace dxvk {
     // Mark all resources as untracked
     m_vbTracked.clear();
     m_rcTracked.clear();
+
+    // Descriptor sets from previous command lists
+    // may get reset once those lists complete
+    m_descCache.reset();
     
     // The current state of the internal command buffer is
     // undefined, so we have to bind and set up everything
@@ -1570,101 +1574,10 @@ namespace dxvk {
     if (imageView->info().numLevels <= 1)
       return;
     
-    this->spillRenderPass();
-
-    m_execBarriers.recordCommands(m_cmd);
-    
-    // Create the a set of framebuffers and image views
-    const Rc<DxvkMetaMipGenRenderPass> mipGenerator
-      = new DxvkMetaMipGenRenderPass(m_device->vkd(), imageView);
-    
-    // Common descriptor set properties that we use to
-    // bind the source image view to the fragment shader
-    VkDescriptorImageInfo descriptorImage;
-    descriptorImage.sampler     = m_common->metaBlit().getSampler(VK_FILTER_LINEAR);
-    descriptorImage.imageView   = VK_NULL_HANDLE;
-    descriptorImage.imageLayout = imageView->imageInfo().layout;
-    
-    VkWriteDescriptorSet descriptorWrite;
-    descriptorWrite.sType            = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-    descriptorWrite.pNext            = nullptr;
-    descriptorWrite.dstSet           = VK_NULL_HANDLE;
-    descriptorWrite.dstBinding       = 0;
-    descriptorWrite.dstArrayElement  = 0;
-    descriptorWrite.descriptorCount  = 1;
-    descriptorWrite.descriptorType   = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
-    descriptorWrite.pImageInfo       = &descriptorImage;
-    descriptorWrite.pBufferInfo      = nullptr;
-    descriptorWrite.pTexelBufferView = nullptr;
-    
-    // Common render pass info
-    VkRenderPassBeginInfo passInfo;
-    passInfo.sType            = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
-    passInfo.pNext            = nullptr;
-    passInfo.renderPass       = mipGenerator->renderPass();
-    passInfo.framebuffer      = VK_NULL_HANDLE;
-    passInfo.renderArea       = VkRect2D { };
-    passInfo.clearValueCount  = 0;
-    passInfo.pClearValues     = nullptr;
-    
-    // Retrieve a compatible pipeline to use for rendering
-    DxvkMetaBlitPipeline pipeInfo = m_common->metaBlit().getPipeline(
-      mipGenerator->viewType(), imageView->info().format, VK_SAMPLE_COUNT_1_BIT);
-    
-    for (uint32_t i = 0; i < mipGenerator->passCount(); i++) {
-      DxvkMetaBlitPass pass = mipGenerator->pass(i);
-      
-      // Width, height and layer count for the current pass
-      VkExtent3D passExtent = mipGenerator->passExtent(i);
-      
-      // Create descriptor set with the current source view
-      descriptorImage.imageView = pass.srcView;
-      descriptorWrite.dstSet = allocateDescriptorSet(pipeInfo.dsetLayout);
-      m_cmd->updateDescriptorSets(1, &descriptorWrite);
-      
-      // Set up viewport and scissor rect
-      VkViewport viewport;
-      viewport.x        = 0.0f;
-      viewport.y        = 0.0f;
-      viewport.width    = float(passExtent.width);
-      viewport.height   = float(passExtent.height);
-      viewport.minDepth = 0.0f;
-      viewport.maxDepth = 1.0f;
-      
-      VkRect2D scissor;
-      scissor.offset    = { 0, 0 };
-      scissor.extent    = { passExtent.width, passExtent.height };
-      
-      // Set up render pass info
-      passInfo.framebuffer = pass.framebuffer;
-      passInfo.renderArea  = scissor;
-      
-      // Set up push constants
-      DxvkMetaBlitPushConstants pushConstants = { };
-      pushConstants.srcCoord0  = { 0.0f, 0.0f, 0.0f };
-      pushConstants.srcCoord1  = { 1.0f, 1.0f, 1.0f };
-      pushConstants.layerCount = passExtent.depth;
-      
-      m_cmd->cmdBeginRenderPass(&passInfo, VK_SUBPASS_CONTENTS_INLINE);
-      m_cmd->cmdBindPipeline(VK_PIPELINE_BIND_POINT_GRAPHICS, pipeInfo.pipeHandle);
-      m_cmd->cmdBindDescriptorSet(VK_PIPELINE_BIND_POINT_GRAPHICS,
-        pipeInfo.pipeLayout, descriptorWrite.dstSet, 0, nullptr);
-      
-      m_cmd->cmdSetViewport(0, 1, &viewport);
-      m_cmd->cmdSetScissor (0, 1, &scissor);
-      
-      m_cmd->cmdPushConstants(
-        pipeInfo.pipeLayout,
-        VK_SHADER_STAGE_FRAGMENT_BIT,
-        0, sizeof(pushConstants),
-        &pushConstants);
-      
-      m_cmd->cmdDraw(3, passExtent.depth, 0, 0);
-      m_cmd->cmdEndRenderPass();
-    }
-    
-    m_cmd->trackResource<DxvkAccess::None>(mipGenerator);
-    m_cmd->trackResource<DxvkAccess::Write>(imageView->image());
+    if (m_common->metaMipGen().checkViewSupport(imageView))
+      this->generateMipmapsCs(imageView);
+    else
+      this->generateMipmapsFb(imageView);
   }
   
   
@@ -1829,76 +1742,57 @@ namespace dxvk {
           VkDeviceSize              offset,
           VkDeviceSize              size,
     const void*                     data) {
-    bool replaceBuffer = (size == buffer->info().size)
-                      && (size <= (1 << 20)); /* 1 MB */
-    
-    DxvkBufferSliceHandle bufferSlice;
-    DxvkCmdBuffer         cmdBuffer;
-
-    if (replaceBuffer) {
-      // Pause transform feedback so that we don't mess
-      // with the currently bound counter buffers
-      if (m_flags.test(DxvkContextFlag::GpXfbActive))
-        this->pauseTransformFeedback();
-
-      // As an optimization, allocate a free slice and perform
-      // the copy in the initialization command buffer instead
-      // interrupting the render pass and stalling the pipeline.
-      bufferSlice = buffer->allocSlice();
-      cmdBuffer   = DxvkCmdBuffer::InitBuffer;
-
-      this->invalidateBuffer(buffer, bufferSlice);
-    } else {
-      this->spillRenderPass();
-    
-      bufferSlice = buffer->getSliceHandle(offset, size);
-      cmdBuffer   = DxvkCmdBuffer::ExecBuffer;
-
-      if (m_execBarriers.isBufferDirty(bufferSlice, DxvkAccess::Write))
-        m_execBarriers.recordCommands(m_cmd);
-    }
-
     // Vulkan specifies that small amounts of data (up to 64kB) can
     // be copied to a buffer directly if the size is a multiple of
     // four. Anything else must be copied through a staging buffer.
     // We'll limit the size to 4kB in order to keep command buffers
     // reasonably small, we do not know how much data apps may upload.
-    if ((size <= 4096) && ((size & 0x3) == 0) && ((offset & 0x3) == 0)) {
+    if ((size <= MaxInlineUpdateSize) && ((size & 0x3) == 0) && ((offset & 0x3) == 0)) {
+      DxvkCmdBuffer cmdBuffer;
+
+      auto bufferSlice = this->beginBufferUpdate(
+        buffer, offset, size, cmdBuffer);
+
       m_cmd->cmdUpdateBuffer(
         cmdBuffer,
         bufferSlice.handle,
         bufferSlice.offset,
         bufferSlice.length,
         data);
+
+      this->endBufferUpdate(buffer, bufferSlice, cmdBuffer);
     } else {
-      auto stagingSlice  = m_staging.alloc(CACHE_LINE_SIZE, size);
-      auto stagingHandle = stagingSlice.getSliceHandle();
+      auto stagingSlice = m_staging.alloc(CACHE_LINE_SIZE, size);
+      std::memcpy(stagingSlice.mapPtr(0), data, size);
 
-      std::memcpy(stagingHandle.mapPtr, data, size);
+      this->updateBuffer(buffer, offset, size, stagingSlice);
+    }
+  }
+  
+  
+  void DxvkContext::updateBuffer(
+    const Rc<DxvkBuffer>&           buffer,
+          VkDeviceSize              offset,
+          VkDeviceSize              size,
+    const DxvkBufferSlice&          data) {
+    DxvkCmdBuffer cmdBuffer;
 
-      VkBufferCopy region;
-      region.srcOffset = stagingHandle.offset;
-      region.dstOffset = bufferSlice.offset;
-      region.size      = size;
+    auto bufferSlice = this->beginBufferUpdate(
+      buffer, offset, size, cmdBuffer);
 
-      m_cmd->cmdCopyBuffer(cmdBuffer,
-        stagingHandle.handle, bufferSlice.handle, 1, &region);
-      
-      m_cmd->trackResource<DxvkAccess::Read>(stagingSlice.buffer());
-    }
+    auto stagingHandle = data.getSliceHandle();
 
-    auto& barriers = replaceBuffer
-      ? m_initBarriers
-      : m_execBarriers;
+    VkBufferCopy region;
+    region.srcOffset = stagingHandle.offset;
+    region.dstOffset = bufferSlice.offset;
+    region.size      = size;
 
-    barriers.accessBuffer(
-      bufferSlice,
-      VK_PIPELINE_STAGE_TRANSFER_BIT,
-      VK_ACCESS_TRANSFER_WRITE_BIT,
-      buffer->info().stages,
-      buffer->info().access);
+    m_cmd->cmdCopyBuffer(cmdBuffer,
+      stagingHandle.handle, bufferSlice.handle, 1, &region);
+    
+    m_cmd->trackResource<DxvkAccess::Read>(data.buffer());
 
-    m_cmd->trackResource<DxvkAccess::Write>(buffer);
+    this->endBufferUpdate(buffer, bufferSlice, cmdBuffer);
   }
   
   
@@ -2788,6 +2682,171 @@ namespace dxvk {
   }
 
   
+  void DxvkContext::generateMipmapsCs(
+    const Rc<DxvkImageView>&        imageView) {
+    this->spillRenderPass();
+    this->unbindComputePipeline();
+    
+    // Mip generation objects only depend on the view, so
+    // we can reuse them for as long as the view is alive
+    DxvkMetaMipGenPipeline pipeInfo = m_common->metaMipGen().getPipeline();
+    
+    Rc<DxvkMetaMipGenComputePass> mipGenerator = imageView->getMipGenComputePass();
+    
+    if (mipGenerator == nullptr) {
+      mipGenerator = new DxvkMetaMipGenComputePass(
+        m_device->vkd(), imageView, pipeInfo);
+      imageView->setMipGenComputePass(mipGenerator);
+    }
+    
+    // Keep the entire view in the general layout while
+    // generating mips, since every dispatch reads from
+    // one level and writes to the following ones
+    VkImageSubresourceRange subresources = imageView->imageSubresources();
+    
+    m_execBarriers.accessImage(
+      imageView->image(), subresources,
+      imageView->imageInfo().layout,
+      imageView->imageInfo().stages,
+      imageView->imageInfo().access,
+      VK_IMAGE_LAYOUT_GENERAL,
+      VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+      VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT);
+    m_execBarriers.recordCommands(m_cmd);
+    
+    m_cmd->cmdBindPipeline(
+      VK_PIPELINE_BIND_POINT_COMPUTE,
+      pipeInfo.pipeHandle);
+    
+    for (uint32_t i = 0; i < mipGenerator->dispatchCount(); i++) {
+      const DxvkMetaMipGenDispatch& dispatch = mipGenerator->dispatch(i);
+      
+      if (i) {
+        m_execBarriers.accessImage(
+          imageView->image(), subresources,
+          VK_IMAGE_LAYOUT_GENERAL,
+          VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+          VK_ACCESS_SHADER_WRITE_BIT,
+          VK_IMAGE_LAYOUT_GENERAL,
+          VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+          VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT);
+        m_execBarriers.recordCommands(m_cmd);
+      }
+      
+      m_cmd->cmdBindDescriptorSet(
+        VK_PIPELINE_BIND_POINT_COMPUTE,
+        pipeInfo.pipeLayout, dispatch.descriptorSet,
+        0, nullptr);
+      m_cmd->cmdPushConstants(
+        pipeInfo.pipeLayout,
+        VK_SHADER_STAGE_COMPUTE_BIT,
+        0, sizeof(dispatch.args), &dispatch.args);
+      m_cmd->cmdDispatch(
+        dispatch.workgroups.width,
+        dispatch.workgroups.height,
+        dispatch.workgroups.depth);
+    }
+    
+    m_execBarriers.accessImage(
+      imageView->image(), subresources,
+      VK_IMAGE_LAYOUT_GENERAL,
+      VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+      VK_ACCESS_SHADER_WRITE_BIT,
+      imageView->imageInfo().layout,
+      imageView->imageInfo().stages,
+      imageView->imageInfo().access);
+    
+    m_cmd->trackResource<DxvkAccess::None>(mipGenerator);
+    m_cmd->trackResource<DxvkAccess::Write>(imageView->image());
+  }
+  
+  
+  void DxvkContext::generateMipmapsFb(
+    const Rc<DxvkImageView>&        imageView) {
+    this->spillRenderPass();
+
+    m_execBarriers.recordCommands(m_cmd);
+    
+    // Retrieve a compatible pipeline to use for rendering
+    VkImageViewType srcViewType = DxvkMetaMipGenRenderPass::getSrcViewType(
+      imageView->imageInfo().type);
+    
+    DxvkMetaBlitPipeline pipeInfo = m_common->metaBlit().getPipeline(
+      srcViewType, imageView->info().format, VK_SAMPLE_COUNT_1_BIT);
+    
+    // Image views, framebuffers and descriptor sets only
+    // depend on the view, so we can create them once and
+    // reuse them for as long as the view is alive
+    Rc<DxvkMetaMipGenRenderPass> mipGenerator = imageView->getMipGenRenderPass();
+    
+    if (mipGenerator == nullptr) {
+      mipGenerator = new DxvkMetaMipGenRenderPass(m_device->vkd(), imageView,
+        pipeInfo, m_common->metaBlit().getSampler(VK_FILTER_LINEAR));
+      imageView->setMipGenRenderPass(mipGenerator);
+    }
+    
+    // Common render pass info
+    VkRenderPassBeginInfo passInfo;
+    passInfo.sType            = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
+    passInfo.pNext            = nullptr;
+    passInfo.renderPass       = mipGenerator->renderPass();
+    passInfo.framebuffer      = VK_NULL_HANDLE;
+    passInfo.renderArea       = VkRect2D { };
+    passInfo.clearValueCount  = 0;
+    passInfo.pClearValues     = nullptr;
+    
+    for (uint32_t i = 0; i < mipGenerator->passCount(); i++) {
+      DxvkMetaBlitPass pass = mipGenerator->pass(i);
+      
+      // Width, height and layer count for the current pass
+      VkExtent3D passExtent = mipGenerator->passExtent(i);
+      
+      // Set up viewport and scissor rect
+      VkViewport viewport;
+      viewport.x        = 0.0f;
+      viewport.y        = 0.0f;
+      viewport.width    = float(passExtent.width);
+      viewport.height   = float(passExtent.height);
+      viewport.minDepth = 0.0f;
+      viewport.maxDepth = 1.0f;
+      
+      VkRect2D scissor;
+      scissor.offset    = { 0, 0 };
+      scissor.extent    = { passExtent.width, passExtent.height };
+      
+      // Set up render pass info
+      passInfo.framebuffer = pass.framebuffer;
+      passInfo.renderArea  = scissor;
+      
+      // Set up push constants
+      DxvkMetaBlitPushConstants pushConstants = { };
+      pushConstants.srcCoord0  = { 0.0f, 0.0f, 0.0f };
+      pushConstants.srcCoord1  = { 1.0f, 1.0f, 1.0f };
+      pushConstants.layerCount = passExtent.depth;
+      
+      m_cmd->cmdBeginRenderPass(&passInfo, VK_SUBPASS_CONTENTS_INLINE);
+      m_cmd->cmdBindPipeline(VK_PIPELINE_BIND_POINT_GRAPHICS, pipeInfo.pipeHandle);
+      m_cmd->cmdBindDescriptorSet(VK_PIPELINE_BIND_POINT_GRAPHICS,
+        pipeInfo.pipeLayout, mipGenerator->descriptorSet(i), 0, nullptr);
+      
+      m_cmd->cmdSetViewport(0, 1, &viewport);
+      m_cmd->cmdSetScissor (0, 1, &scissor);
+      
+      m_cmd->cmdPushConstants(
+        pipeInfo.pipeLayout,
+        VK_SHADER_STAGE_FRAGMENT_BIT,
+        0, sizeof(pushConstants),
+        &pushConstants);
+      
+      m_cmd->cmdDraw(3, passExtent.depth, 0, 0);
+      m_cmd->cmdEndRenderPass();
+    }
+    
+    m_cmd->trackResource<DxvkAccess::None>(mipGenerator);
+    m_cmd->trackResource<DxvkAccess::Write>(imageView->image());
+  }
+  
+  
   void DxvkContext::copyImageHw(
     const Rc<DxvkImage>&        dstImage,
           VkImageSubresourceLayers dstSubresource,
@@ -3398,6 +3457,62 @@ namespace dxvk {
   }
 
 
+  DxvkBufferSliceHandle DxvkContext::beginBufferUpdate(
+    const Rc<DxvkBuffer>&           buffer,
+          VkDeviceSize              offset,
+          VkDeviceSize              size,
+          DxvkCmdBuffer&            cmdBuffer) {
+    bool replaceBuffer = (size == buffer->info().size)
+                      && (size <= (1 << 20)); /* 1 MB */
+    
+    DxvkBufferSliceHandle bufferSlice;
+
+    if (replaceBuffer) {
+      // Pause transform feedback so that we don't mess
+      // with the currently bound counter buffers
+      if (m_flags.test(DxvkContextFlag::GpXfbActive))
+        this->pauseTransformFeedback();
+
+      // As an optimization, allocate a free slice and perform
+      // the copy in the initialization command buffer instead
+      // interrupting the render pass and stalling the pipeline.
+      bufferSlice = buffer->allocSlice();
+      cmdBuffer   = DxvkCmdBuffer::InitBuffer;
+
+      this->invalidateBuffer(buffer, bufferSlice);
+    } else {
+      this->spillRenderPass();
+    
+      bufferSlice = buffer->getSliceHandle(offset, size);
+      cmdBuffer   = DxvkCmdBuffer::ExecBuffer;
+
+      if (m_execBarriers.isBufferDirty(bufferSlice, DxvkAccess::Write))
+        m_execBarriers.recordCommands(m_cmd);
+    }
+
+    return bufferSlice;
+  }
+
+
+  void DxvkContext::endBufferUpdate(
+    const Rc<DxvkBuffer>&           buffer,
+    const DxvkBufferSliceHandle&    bufferSlice,
+          DxvkCmdBuffer             cmdBuffer) {
+    auto& barriers = cmdBuffer == DxvkCmdBuffer::InitBuffer
+      ? m_initBarriers
+      : m_execBarriers;
+
+    barriers.accessBuffer(
+      bufferSlice,
+      VK_PIPELINE_STAGE_TRANSFER_BIT,
+      VK_ACCESS_TRANSFER_WRITE_BIT,
+      buffer->info().stages,
+      buffer->info().access);
+
+    m_cmd->trackResource<DxvkAccess::Write>(buffer);
+  }
+
+
   void DxvkContext::updatePredicate(
     const DxvkBufferSliceHandle&    predicate,
     const DxvkGpuQueryHandle&       query) {
@@ -3836,8 +3951,22 @@ namespace dxvk {
       ? DxvkContextFlag::GpDynamicStencilRef
       : DxvkContextFlag::GpDirtyStencilRef);
     
-    // Retrieve and bind actual Vulkan pipeline handle
-    m_gpActivePipeline = m_state.gp.pipeline->getPipelineHandle(m_state.gp.state, m_state.om.framebuffer->getRenderPass());
+    // Retrieve and bind actual Vulkan pipeline handle. Pipelines
+    // with transform feedback must not skip any draws, so always
+    // compile those synchronously.
+    if (m_device->config().enableAsyncPipelines
+     && !m_state.gp.flags.test(DxvkGraphicsPipelineFlag::HasTransformFeedback)) {
+      bool pending = false;
+
+      m_gpActivePipeline = m_state.gp.pipeline->getPipelineHandleAsync(
+        m_state.gp.state, m_state.om.framebuffer->getRenderPass(), pending);
+
+      if (unlikely(pending))
+        m_cmd->addStatCtr(DxvkStatCounter::PipeSkippedDraws, 1);
+    } else {
+      m_gpActivePipeline = m_state.gp.pipeline->getPipelineHandle(
+        m_state.gp.state, m_state.om.framebuffer->getRenderPass());
+    }
 
     if (unlikely(!m_gpActivePipeline))
       return false;
@@ -3879,7 +4008,9 @@ namespace dxvk {
   
   template<VkPipelineBindPoint BindPoint>
   void DxvkContext::updateShaderResources(const DxvkPipelineLayout* layout) {
-    std::array<DxvkDescriptorInfo, MaxNumActiveBindings> descriptors;
+    // Write descriptors to the set cache directly so that
+    // they do not need to be copied on a cache miss
+    DxvkDescriptorInfo* descriptors = m_descCache.allocDescriptors(layout->bindingCount());
 
     // Assume that all bindings are active as a fast path
     DxvkBindingMask bindMask;
@@ -4044,10 +4175,22 @@ namespace dxvk {
     auto& set = BindPoint == VK_PIPELINE_BIND_POINT_GRAPHICS ? m_gpSet : m_cpSet;
 
     if (layout->bindingCount()) {
-      set = allocateDescriptorSet(layout->descriptorSetLayout());
+      // Reuse a previously written set if the exact same
+      // descriptors were used earlier in the command list
+      size_t hash = DxvkDescriptorSetCache::computeHash(layout, descriptors);
+      set = m_descCache.find(layout, descriptors, hash);
 
-      m_cmd->updateDescriptorSetWithTemplate(set,
-        layout->descriptorTemplate(), descriptors.data());
+      if (set) {
+        m_cmd->addStatCtr(DxvkStatCounter::DescriptorCacheHits, 1);
+      } else {
+        set = allocateDescriptorSet(layout->descriptorSetLayout());
+
+        m_cmd->updateDescriptorSetWithTemplate(set,
+          layout->descriptorTemplate(), descriptors);
+
+        m_descCache.insert(layout, hash, set);
+        m_cmd->addStatCtr(DxvkStatCounter::DescriptorCacheMisses, 1);
+      }
     } else {
       set = VK_NULL_HANDLE;
     }
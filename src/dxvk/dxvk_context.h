@@ -621,8 +621,10 @@ namespace dxvk {
     /**
      * \brief Generates mip maps
      * 
-     * Uses blitting to generate lower mip levels from
-     * the top-most mip level passed to this method.
+     * Generates lower mip levels from the top-most mip
+     * level passed to this method. Uses a compute shader
+     * if the image supports storage access in the view
+     * format, and falls back to blitting otherwise.
      * \param [in] imageView The image to generate mips for
      */
     void generateMipmaps(
@@ -737,6 +739,23 @@ namespace dxvk {
             VkDeviceSize              size,
       const void*                     data);
     
+    /**
+     * \brief Updates a buffer from a staging buffer
+     * 
+     * Behaves like \ref updateBuffer, except that the
+     * source data has already been written to a host
+     * visible buffer slice. Only the copy is recorded.
+     * \param [in] buffer Destination buffer
+     * \param [in] offset Offset of sub range to update
+     * \param [in] size Length of sub range to update
+     * \param [in] data Staging buffer slice holding the data
+     */
+    void updateBuffer(
+      const Rc<DxvkBuffer>&           buffer,
+            VkDeviceSize              offset,
+            VkDeviceSize              size,
+      const DxvkBufferSlice&          data);
+    
     /**
      * \brief Updates an image
      * 
@@ -1014,6 +1033,7 @@ namespace dxvk {
     
     Rc<DxvkCommandList>     m_cmd;
     Rc<DxvkDescriptorPool>  m_descPool;
+    DxvkDescriptorSetCache  m_descCache;
 
     DxvkContextFlags        m_flags;
     DxvkContextState        m_state;
@@ -1073,6 +1093,12 @@ namespace dxvk {
             VkExtent3D            extent,
             VkClearValue          value);
     
+    void generateMipmapsCs(
+      const Rc<DxvkImageView>&    imageView);
+    
+    void generateMipmapsFb(
+      const Rc<DxvkImageView>&    imageView);
+    
     void copyImageHw(
       const Rc<DxvkImage>&        dstImage,
             VkImageSubresourceLayers dstSubresource,
@@ -1111,6 +1137,17 @@ namespace dxvk {
             VkResolveModeFlagBitsKHR  depthMode,
             VkResolveModeFlagBitsKHR  stencilMode);
     
+    DxvkBufferSliceHandle beginBufferUpdate(
+      const Rc<DxvkBuffer>&           buffer,
+            VkDeviceSize              offset,
+            VkDeviceSize              size,
+            DxvkCmdBuffer&            cmdBuffer);
+    
+    void endBufferUpdate(
+      const Rc<DxvkBuffer>&           buffer,
+      const DxvkBufferSliceHandle&    bufferSlice,
+            DxvkCmdBuffer             cmdBuffer);
+    
     void updatePredicate(
       const DxvkBufferSliceHandle&    predicate,
       const DxvkGpuQueryHandle&       query);
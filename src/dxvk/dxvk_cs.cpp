@@ -102,30 +102,33 @@ namespace dxvk {
   
   
   DxvkCsThread::~DxvkCsThread() {
-    { std::unique_lock<std::mutex> lock(m_mutex);
-      m_stopped.store(true);
-    }
-    
-    m_condOnAdd.notify_one();
+    m_stopped.store(true);
+    m_eventOnAdd.notify();
+
     m_thread.join();
   }
   
   
   void DxvkCsThread::dispatchChunk(DxvkCsChunkRef&& chunk) {
-    { std::unique_lock<std::mutex> lock(m_mutex);
-      m_chunksQueued.push(std::move(chunk));
-      m_chunksPending += 1;
-    }
-    
-    m_condOnAdd.notify_one();
+    uint64_t seq = m_chunksQueued.load(std::memory_order_relaxed);
+
+    // Slots can be reused once the chunk that previously
+    // occupied them has been consumed by the CS thread
+    m_eventOnSync.wait([this, seq] {
+      return seq - m_chunksExecuted.load(std::memory_order_acquire) < MaxChunksInFlight;
+    });
+
+    m_chunks[seq % MaxChunksInFlight] = std::move(chunk);
+    m_chunksQueued.store(seq + 1, std::memory_order_release);
+    m_eventOnAdd.notify();
   }
   
   
   void DxvkCsThread::synchronize() {
-    std::unique_lock<std::mutex> lock(m_mutex);
-    
-    m_condOnSync.wait(lock, [this] {
-      return !m_chunksPending.load();
+    uint64_t seq = m_chunksQueued.load(std::memory_order_relaxed);
+
+    m_eventOnSync.wait([this, seq] {
+      return m_chunksExecuted.load(std::memory_order_acquire) >= seq;
     });
   }
   
@@ -133,33 +136,26 @@ namespace dxvk {
   void DxvkCsThread::threadFunc() {
     env::setThreadName("dxvk-cs");
 
-    DxvkCsChunkRef chunk;
+    uint64_t seq = 0;
     
     while (!m_stopped.load()) {
-      { std::unique_lock<std::mutex> lock(m_mutex);
-        if (chunk) {
-          if (--m_chunksPending == 0)
-            m_condOnSync.notify_one();
-          
-          chunk = DxvkCsChunkRef();
-        }
-        
-        if (m_chunksQueued.size() == 0) {
-          m_condOnAdd.wait(lock, [this] {
-            return (m_chunksQueued.size() != 0)
-                || (m_stopped.load());
-          });
-        }
-        
-        if (m_chunksQueued.size() != 0) {
-          chunk = std::move(m_chunksQueued.front());
-          m_chunksQueued.pop();
-        }
-      }
-      
-      if (chunk)
+      m_eventOnAdd.wait([this, seq] {
+        return m_chunksQueued.load(std::memory_order_acquire) > seq
+            || m_stopped.load();
+      });
+
+      if (m_chunksQueued.load(std::memory_order_acquire) > seq) {
+        DxvkCsChunkRef chunk = std::move(m_chunks[seq % MaxChunksInFlight]);
         chunk->executeAll(m_context.ptr());
+
+        // Return the chunk to the pool before
+        // any waiting thread gets woken up
+        chunk = DxvkCsChunkRef();
+
+        m_chunksExecuted.store(++seq, std::memory_order_release);
+        m_eventOnSync.notify();
+      }
     }
   }
   
-}
\ No newline at end of file
+}
@@ -1,10 +1,9 @@
 #pragma once
 
+#include <array>
 #include <atomic>
-#include <condition_variable>
-#include <mutex>
-#include <queue>
 
+#include "../util/sync/sync_eventcount.h"
 #include "../util/thread.h"
 #include "dxvk_context.h"
 
@@ -374,10 +373,14 @@ namespace dxvk {
    * \brief Command stream thread
    * 
    * Spawns a thread that will execute
-   * commands on a DXVK context. 
+   * commands on a DXVK context. Chunks
+   * are passed to the thread through a
+   * bounded single-producer ring buffer,
+   * so dispatching a chunk will usually
+   * not take any locks.
    */
   class DxvkCsThread {
-    
+    constexpr static uint64_t MaxChunksInFlight = 1024;
   public:
     
     DxvkCsThread(const Rc<DxvkContext>& context);
@@ -388,6 +391,9 @@ namespace dxvk {
      * 
      * Can be used to efficiently play back large
      * command lists recorded on another thread.
+     * Must not be called concurrently from more
+     * than one thread. Blocks if the ring buffer
+     * is full.
      * \param [in] chunk The chunk to dispatch
      */
     void dispatchChunk(DxvkCsChunkRef&& chunk);
@@ -411,7 +417,8 @@ namespace dxvk {
      * \returns \c true if there is still work to do
      */
     bool isBusy() const {
-      return m_chunksPending.load() != 0;
+      return m_chunksExecuted.load(std::memory_order_acquire)
+          != m_chunksQueued.load(std::memory_order_relaxed);
     }
     
   private:
@@ -419,11 +426,14 @@ namespace dxvk {
     const Rc<DxvkContext>       m_context;
     
     std::atomic<bool>           m_stopped = { false };
-    std::mutex                  m_mutex;
-    std::condition_variable     m_condOnAdd;
-    std::condition_variable     m_condOnSync;
-    std::queue<DxvkCsChunkRef>  m_chunksQueued;
-    std::atomic<uint32_t>       m_chunksPending = { 0u };
+    sync::EventCount            m_eventOnAdd;
+    sync::EventCount            m_eventOnSync;
+
+    std::atomic<uint64_t>       m_chunksQueued   = { 0ull };
+    std::atomic<uint64_t>       m_chunksExecuted = { 0ull };
+
+    std::array<DxvkCsChunkRef, MaxChunksInFlight> m_chunks;
+
     dxvk::thread                m_thread;
     
     void threadFunc();
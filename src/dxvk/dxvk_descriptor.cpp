@@ -1,5 +1,6 @@
 #include "dxvk_descriptor.h"
 #include "dxvk_device.h"
+#include "dxvk_pipelayout.h"
 
 namespace dxvk {
   
@@ -85,4 +86,170 @@ namespace dxvk {
     m_pools.clear();
   }
   
-}
\ No newline at end of file
+
+
+  DxvkDescriptorSetCache::DxvkDescriptorSetCache()
+  : m_data(MinDescriptorCount), m_entries(MinEntryCount) {
+
+  }
+
+
+  DxvkDescriptorSetCache::~DxvkDescriptorSetCache() {
+
+  }
+
+
+  size_t DxvkDescriptorSetCache::computeHash(
+    const DxvkPipelineLayout*       layout,
+    const DxvkDescriptorInfo*       descriptors) {
+    DxvkHashState hash;
+    hash.add(size_t(layout));
+
+    // Descriptor infos may contain uninitialized padding,
+    // so we need to look at the individual members
+    for (uint32_t i = 0; i < layout->bindingCount(); i++) {
+      switch (layout->binding(i).type) {
+        case VK_DESCRIPTOR_TYPE_SAMPLER:
+        case VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE:
+        case VK_DESCRIPTOR_TYPE_STORAGE_IMAGE:
+        case VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER:
+          hash.add(size_t(descriptors[i].image.sampler));
+          hash.add(size_t(descriptors[i].image.imageView));
+          hash.add(size_t(descriptors[i].image.imageLayout));
+          break;
+
+        case VK_DESCRIPTOR_TYPE_UNIFORM_TEXEL_BUFFER:
+        case VK_DESCRIPTOR_TYPE_STORAGE_TEXEL_BUFFER:
+          hash.add(size_t(descriptors[i].texelBuffer));
+          break;
+
+        default:
+          hash.add(size_t(descriptors[i].buffer.buffer));
+          hash.add(size_t(descriptors[i].buffer.offset));
+          hash.add(size_t(descriptors[i].buffer.range));
+      }
+    }
+
+    return hash;
+  }
+
+
+  DxvkDescriptorInfo* DxvkDescriptorSetCache::allocDescriptors(
+          uint32_t                  count) {
+    if (unlikely(m_dataSize + count > m_data.size()))
+      m_data.resize(std::max(2 * m_data.size(), m_dataSize + count));
+
+    return &m_data[m_dataSize];
+  }
+
+
+  VkDescriptorSet DxvkDescriptorSetCache::find(
+    const DxvkPipelineLayout*       layout,
+    const DxvkDescriptorInfo*       descriptors,
+          size_t                    hash) const {
+    size_t mask  = m_entries.size() - 1;
+    size_t index = hash & mask;
+
+    while (m_entries[index].set) {
+      const Entry& e = m_entries[index];
+
+      if (e.hash == hash && e.layout == layout
+       && compareDescriptors(layout, descriptors, &m_data[e.offset]))
+        return e.set;
+
+      index = (index + 1) & mask;
+    }
+
+    return VK_NULL_HANDLE;
+  }
+
+
+  void DxvkDescriptorSetCache::insert(
+    const DxvkPipelineLayout*       layout,
+          size_t                    hash,
+          VkDescriptorSet           set) {
+    if (unlikely(2 * (m_entryCount + 1) > m_entries.size()))
+      this->grow();
+
+    size_t mask  = m_entries.size() - 1;
+    size_t index = hash & mask;
+
+    while (m_entries[index].set)
+      index = (index + 1) & mask;
+
+    Entry& e = m_entries[index];
+    e.hash   = hash;
+    e.layout = layout;
+    e.offset = m_dataSize;
+    e.set    = set;
+
+    m_entryCount += 1;
+
+    // Keep the descriptors written by the caller
+    m_dataSize += layout->bindingCount();
+  }
+
+
+  void DxvkDescriptorSetCache::reset() {
+    m_dataSize = 0;
+
+    if (m_entryCount) {
+      std::fill(m_entries.begin(), m_entries.end(), Entry());
+      m_entryCount = 0;
+    }
+  }
+
+
+  void DxvkDescriptorSetCache::grow() {
+    std::vector<Entry> entries(2 * m_entries.size());
+    std::swap(entries, m_entries);
+
+    size_t mask = m_entries.size() - 1;
+
+    for (const Entry& e : entries) {
+      if (!e.set)
+        continue;
+
+      size_t index = e.hash & mask;
+
+      while (m_entries[index].set)
+        index = (index + 1) & mask;
+
+      m_entries[index] = e;
+    }
+  }
+
+
+  bool DxvkDescriptorSetCache::compareDescriptors(
+    const DxvkPipelineLayout*       layout,
+    const DxvkDescriptorInfo*       a,
+    const DxvkDescriptorInfo*       b) {
+    bool eq = true;
+
+    for (uint32_t i = 0; i < layout->bindingCount() && eq; i++) {
+      switch (layout->binding(i).type) {
+        case VK_DESCRIPTOR_TYPE_SAMPLER:
+        case VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE:
+        case VK_DESCRIPTOR_TYPE_STORAGE_IMAGE:
+        case VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER:
+          eq = a[i].image.sampler     == b[i].image.sampler
+            && a[i].image.imageView   == b[i].image.imageView
+            && a[i].image.imageLayout == b[i].image.imageLayout;
+          break;
+
+        case VK_DESCRIPTOR_TYPE_UNIFORM_TEXEL_BUFFER:
+        case VK_DESCRIPTOR_TYPE_STORAGE_TEXEL_BUFFER:
+          eq = a[i].texelBuffer == b[i].texelBuffer;
+          break;
+
+        default:
+          eq = a[i].buffer.buffer == b[i].buffer.buffer
+            && a[i].buffer.offset == b[i].buffer.offset
+            && a[i].buffer.range  == b[i].buffer.range;
+      }
+    }
+
+    return eq;
+  }
+
+}
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <unordered_map>
 #include <vector>
 
 #include "dxvk_include.h"
@@ -7,6 +8,7 @@
 namespace dxvk {
 
   class DxvkDevice;
+  class DxvkPipelineLayout;
   
   /**
    * \brief Descriptor info
@@ -97,4 +99,112 @@ namespace dxvk {
 
   };
   
-}
\ No newline at end of file
+
+
+  /**
+   * \brief Descriptor set cache
+   * 
+   * Maps descriptor arrays that have already been written
+   * to a descriptor set to that set, so that the set can
+   * be reused when the same resources are bound again.
+   * Only valid for the lifetime of a single command list,
+   * since descriptor pools may be reset afterwards.
+   * 
+   * Descriptors are written directly into storage owned
+   * by the cache, and sets are stored in a flat hash
+   * table. Both keep their capacity across resets, so
+   * that cache misses do not allocate memory.
+   */
+  class DxvkDescriptorSetCache {
+    constexpr static size_t MinEntryCount      = 256;
+    constexpr static size_t MinDescriptorCount = 1024;
+  public:
+
+    DxvkDescriptorSetCache();
+    ~DxvkDescriptorSetCache();
+
+    /**
+     * \brief Computes hash of a descriptor array
+     * 
+     * \param [in] layout Pipeline layout
+     * \param [in] descriptors Descriptor array
+     * \returns Hash of the descriptor array
+     */
+    static size_t computeHash(
+      const DxvkPipelineLayout*       layout,
+      const DxvkDescriptorInfo*       descriptors);
+
+    /**
+     * \brief Allocates descriptor storage
+     * 
+     * The returned array is only added to the cache when
+     * \ref insert is called, otherwise it will be reused
+     * by the next call. The pointer remains valid until
+     * the next call to this function.
+     * \param [in] count Number of descriptors
+     * \returns Descriptor array to write to
+     */
+    DxvkDescriptorInfo* allocDescriptors(
+            uint32_t                  count);
+
+    /**
+     * \brief Looks up a descriptor set
+     * 
+     * \param [in] layout Pipeline layout
+     * \param [in] descriptors Descriptor array
+     * \param [in] hash Hash of the descriptor array
+     * \returns Matching descriptor set, or \c VK_NULL_HANDLE
+     */
+    VkDescriptorSet find(
+      const DxvkPipelineLayout*       layout,
+      const DxvkDescriptorInfo*       descriptors,
+            size_t                    hash) const;
+
+    /**
+     * \brief Adds a descriptor set
+     * 
+     * Adds the descriptor array returned by the last
+     * call to \ref allocDescriptors to the cache.
+     * \param [in] layout Pipeline layout
+     * \param [in] hash Hash of the descriptor array
+     * \param [in] set Descriptor set that has been
+     *    written with the given descriptors
+     */
+    void insert(
+      const DxvkPipelineLayout*       layout,
+            size_t                    hash,
+            VkDescriptorSet           set);
+
+    /**
+     * \brief Resets cache
+     * 
+     * Must be called when the command list
+     * that the sets were allocated for ends.
+     */
+    void reset();
+
+  private:
+
+    struct Entry {
+      size_t                    hash   = 0;
+      const DxvkPipelineLayout* layout = nullptr;
+      size_t                    offset = 0;
+      VkDescriptorSet           set    = VK_NULL_HANDLE;
+    };
+
+    std::vector<DxvkDescriptorInfo> m_data;
+    size_t                          m_dataSize  = 0;
+
+    std::vector<Entry>              m_entries;
+    size_t                          m_entryCount = 0;
+
+    void grow();
+
+    static bool compareDescriptors(
+      const DxvkPipelineLayout*       layout,
+      const DxvkDescriptorInfo*       a,
+      const DxvkDescriptorInfo*       b);
+
+  };
+  
+}
@@ -20,7 +20,8 @@ namespace dxvk {
     m_properties        (adapter->devicePropertiesExt()),
     m_perfHints         (getPerfHints()),
     m_objects           (this),
-    m_submissionQueue   (this) {
+    m_submissionQueue   (this),
+    m_shaderTasks       (this) {
     auto queueFamilies = m_adapter->findQueueFamilies();
     m_queues.graphics = getQueue(queueFamilies.graphics, 0);
     m_queues.transfer = getQueue(queueFamilies.transfer, 0);
@@ -142,7 +143,7 @@ namespace dxvk {
   
   Rc<DxvkSampler> DxvkDevice::createSampler(
     const DxvkSamplerCreateInfo&  createInfo) {
-    return new DxvkSampler(m_vkd, createInfo);
+    return m_objects.samplerPool().getSampler(createInfo);
   }
   
   
@@ -152,10 +153,12 @@ namespace dxvk {
     const DxvkResourceSlot*         slotInfos,
     const DxvkInterfaceSlots&       iface,
     const SpirvCodeBuffer&          code) {
+    DxvkShaderOptions options = { };
+    options.disableOptimizer = !m_options.enableSpirvOptimizer;
+
     return new DxvkShader(stage,
       slotCount, slotInfos, iface, code,
-      DxvkShaderOptions(),
-      DxvkShaderConstData());
+      options, DxvkShaderConstData());
   }
   
   
@@ -166,7 +169,16 @@ namespace dxvk {
     result.setCtr(DxvkStatCounter::PipeCountGraphics, pipe.numGraphicsPipelines);
     result.setCtr(DxvkStatCounter::PipeCountCompute,  pipe.numComputePipelines);
     result.setCtr(DxvkStatCounter::PipeCompilerBusy,  m_objects.pipelineManager().isCompilingShaders());
+    result.setCtr(DxvkStatCounter::PipeQueueDepth,    pipe.numQueuedPipelines);
+    result.setCtr(DxvkStatCounter::PipeWorkersBusy,   pipe.numBusyWorkers);
+    result.setCtr(DxvkStatCounter::PipeWorkerSlots,   pipe.numWorkerSlots);
     result.setCtr(DxvkStatCounter::GpuIdleTicks,      m_submissionQueue.gpuIdleTicks());
+    result.setCtr(DxvkStatCounter::SamplerCount,      m_objects.samplerPool().getSamplerCount());
+
+    DxvkShaderTaskStats tasks = m_shaderTasks.getStats();
+    result.setCtr(DxvkStatCounter::ShaderTaskQueueDepth, tasks.numQueuedTasks);
+    result.setCtr(DxvkStatCounter::ShaderTaskWaits,      tasks.numWaits);
+    result.setCtr(DxvkStatCounter::ShaderTaskWaitTicks,  tasks.waitTicks);
 
     std::lock_guard<sync::Spinlock> lock(m_statLock);
     result.merge(m_statCounters);
@@ -266,6 +278,11 @@ namespace dxvk {
   }
 
 
+  void DxvkDevice::trimBuffers() {
+    m_objects.bufferTrimList().trimBuffers(getCurrentFrameId());
+  }
+
+
   DxvkDeviceQueue DxvkDevice::getQueue(
           uint32_t                family,
           uint32_t                index) const {
@@ -20,6 +20,7 @@
 #include "dxvk_renderpass.h"
 #include "dxvk_sampler.h"
 #include "dxvk_shader.h"
+#include "dxvk_shader_task.h"
 #include "dxvk_stats.h"
 #include "dxvk_unbound.h"
 
@@ -73,6 +74,7 @@ namespace dxvk {
    * contexts. Multiple contexts can be created for a device.
    */
   class DxvkDevice : public RcObject {
+    friend class DxvkBuffer;
     friend class DxvkContext;
     friend class DxvkSubmissionQueue;
     friend class DxvkDescriptorPoolTracker;
@@ -316,10 +318,13 @@ namespace dxvk {
       const DxvkImageViewCreateInfo&  createInfo);
     
     /**
-     * \brief Creates a sampler object
+     * \brief Retrieves a sampler object
      * 
+     * Samplers are cached, so that this will return the
+     * same sampler object for identical parameters. This
+     * is thread-safe and may be called from any thread.
      * \param [in] createInfo Sampler parameters
-     * \returns Newly created sampler object
+     * \returns Sampler object
      */
     Rc<DxvkSampler> createSampler(
       const DxvkSamplerCreateInfo&  createInfo);
@@ -380,6 +385,43 @@ namespace dxvk {
     void registerShader(
       const Rc<DxvkShader>&         shader);
     
+    /**
+     * \brief Retrieves shader cache
+     * 
+     * Used by the shader frontends to look up
+     * and store translated shaders on disk.
+     * \returns Shader cache, or \c nullptr
+     */
+    Rc<DxvkShaderCache> getShaderCache() {
+      return m_objects.pipelineManager().getShaderCache();
+    }
+    
+    /**
+     * \brief Queues a shader task
+     * 
+     * Used by the shader frontends to translate
+     * shaders on a worker thread. Tasks that are
+     * still pending when the device is destroyed
+     * will be executed before the device goes away.
+     * \param [in] task The task to execute
+     */
+    void queueShaderTask(
+      const Rc<DxvkShaderTask>&     task) {
+      m_shaderTasks.queueTask(task);
+    }
+    
+    /**
+     * \brief Waits for a shader task
+     * 
+     * Records a stall in the device statistics
+     * if the task has not completed yet.
+     * \param [in] task The task to wait for
+     */
+    void waitForShaderTask(
+      const Rc<DxvkShaderTask>&     task) {
+      m_shaderTasks.waitForTask(task);
+    }
+    
     /**
      * \brief Presents a swap chain image
      * 
@@ -486,6 +528,8 @@ namespace dxvk {
     
     DxvkSubmissionQueue m_submissionQueue;
 
+    DxvkShaderTaskQueue m_shaderTasks;
+
     DxvkDevicePerfHints getPerfHints();
     
     void recycleCommandList(
@@ -494,6 +538,8 @@ namespace dxvk {
     void recycleDescriptorPool(
       const Rc<DxvkDescriptorPool>& pool);
     
+    void trimBuffers();
+    
     DxvkDeviceQueue getQueue(
             uint32_t                family,
             uint32_t                index) const;
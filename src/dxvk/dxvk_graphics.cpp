@@ -41,8 +41,16 @@ namespace dxvk {
   
   
   DxvkGraphicsPipeline::~DxvkGraphicsPipeline() {
-    for (const auto& instance : m_pipelines)
-      this->destroyPipeline(instance.pipeline());
+    for (const auto& bucket : m_buckets) {
+      auto instance = bucket.load();
+
+      while (instance != nullptr) {
+        auto next = instance->next();
+        this->destroyPipeline(instance->pipeline());
+        delete instance;
+        instance = next;
+      }
+    }
   }
   
   
@@ -63,22 +71,43 @@ namespace dxvk {
   VkPipeline DxvkGraphicsPipeline::getPipelineHandle(
     const DxvkGraphicsPipelineStateInfo& state,
     const DxvkRenderPass*                renderPass) {
-    DxvkGraphicsPipelineInstance* instance = nullptr;
+    bool created = false;
 
-    { std::lock_guard<sync::Spinlock> lock(m_mutex);
-    
-      instance = this->findInstance(state, renderPass);
-      
-      if (instance)
-        return instance->pipeline();
-      
-      instance = this->createInstance(state, renderPass);
+    auto instance = this->getInstance(state, renderPass, created);
+    VkPipeline pipeline = instance->pipeline();
+
+    // Also write instances that were compiled ahead of
+    // time, so that the state cache can track usage
+    if (pipeline != VK_NULL_HANDLE && instance->markUsed())
+      this->writePipelineStateToCache(state, renderPass->format());
+
+    return pipeline;
+  }
+
+
+  VkPipeline DxvkGraphicsPipeline::getPipelineHandleAsync(
+    const DxvkGraphicsPipelineStateInfo& state,
+    const DxvkRenderPass*                renderPass,
+          bool&                          pending) {
+    size_t hash = computeInstanceHash(state, renderPass);
+    auto instance = this->findInstance(state, renderPass, hash);
+
+    if (unlikely(!instance)) {
+      bool created = false;
+      instance = this->insertInstance(state, renderPass, hash, created);
+
+      if (created)
+        m_pipeMgr->queueGraphicsPipeline(this, instance, state, renderPass);
     }
-    
-    if (!instance)
+
+    pending = !instance->isReady();
+
+    if (pending)
       return VK_NULL_HANDLE;
 
-    this->writePipelineStateToCache(state, renderPass->format());
+    if (instance->pipeline() != VK_NULL_HANDLE && instance->markUsed())
+      this->writePipelineStateToCache(state, renderPass->format());
+
     return instance->pipeline();
   }
 
@@ -86,37 +115,105 @@ namespace dxvk {
   void DxvkGraphicsPipeline::compilePipeline(
     const DxvkGraphicsPipelineStateInfo& state,
     const DxvkRenderPass*                renderPass) {
+    bool created = false;
+    this->getInstance(state, renderPass, created);
+  }
+
+
+  DxvkGraphicsPipelineInstance* DxvkGraphicsPipeline::getInstance(
+    const DxvkGraphicsPipelineStateInfo& state,
+    const DxvkRenderPass*                renderPass,
+          bool&                          created) {
+    size_t hash = computeInstanceHash(state, renderPass);
+    auto instance = this->findInstance(state, renderPass, hash);
+
+    if (unlikely(!instance)) {
+      instance = this->insertInstance(state, renderPass, hash, created);
+
+      if (created) {
+        this->compileInstance(instance, state, renderPass);
+        return instance;
+      }
+    }
+
+    if (unlikely(!instance->isReady()))
+      m_compileEvent.wait([instance] { return instance->isReady(); });
+
+    return instance;
+  }
+  
+  
+  DxvkGraphicsPipelineInstance* DxvkGraphicsPipeline::findInstance(
+    const DxvkGraphicsPipelineStateInfo& state,
+    const DxvkRenderPass*                renderPass,
+          size_t                         hash) const {
+    auto instance = m_buckets[hash % m_buckets.size()].load(std::memory_order_acquire);
+
+    while (instance != nullptr) {
+      if (instance->isCompatible(state, renderPass, hash))
+        return instance;
+
+      instance = instance->next();
+    }
+    
+    return nullptr;
+  }
+  
+  
+  DxvkGraphicsPipelineInstance* DxvkGraphicsPipeline::insertInstance(
+    const DxvkGraphicsPipelineStateInfo& state,
+    const DxvkRenderPass*                renderPass,
+          size_t                         hash,
+          bool&                          created) {
+    auto& bucket = m_buckets[hash % m_buckets.size()];
+
+    // Check again while holding the lock so that
+    // only one thread will compile the pipeline
     std::lock_guard<sync::Spinlock> lock(m_mutex);
+    auto instance = this->findInstance(state, renderPass, hash);
+
+    if (!instance) {
+      instance = new DxvkGraphicsPipelineInstance(
+        state, renderPass, hash, bucket.load(std::memory_order_relaxed));
+      bucket.store(instance, std::memory_order_release);
+      created = true;
+    }
+
+    return instance;
+  }
+
 
-    if (!this->findInstance(state, renderPass))
-      this->createInstance(state, renderPass);
+  void DxvkGraphicsPipeline::compileInstance(
+          DxvkGraphicsPipelineInstance*  instance,
+    const DxvkGraphicsPipelineStateInfo& state,
+    const DxvkRenderPass*                renderPass) {
+    instance->setPipeline(this->createInstancePipeline(state, renderPass));
+    m_compileEvent.notify();
   }
 
 
-  DxvkGraphicsPipelineInstance* DxvkGraphicsPipeline::createInstance(
+  VkPipeline DxvkGraphicsPipeline::createInstancePipeline(
     const DxvkGraphicsPipelineStateInfo& state,
     const DxvkRenderPass*                renderPass) {
     // If the pipeline state vector is invalid, don't try
     // to create a new pipeline, it won't work anyway.
     if (!this->validatePipelineState(state))
-      return nullptr;
+      return VK_NULL_HANDLE;
 
-    VkPipeline newPipelineHandle = this->createPipeline(state, renderPass);
+    VkPipeline pipeline = this->createPipeline(state, renderPass);
 
     m_pipeMgr->m_numGraphicsPipelines += 1;
-    return &m_pipelines.emplace_back(state, renderPass, newPipelineHandle);
+    return pipeline;
   }
-  
-  
-  DxvkGraphicsPipelineInstance* DxvkGraphicsPipeline::findInstance(
+
+
+  size_t DxvkGraphicsPipeline::computeInstanceHash(
     const DxvkGraphicsPipelineStateInfo& state,
     const DxvkRenderPass*                renderPass) {
-    for (auto& instance : m_pipelines) {
-      if (instance.isCompatible(state, renderPass))
-        return &instance;
-    }
-    
-    return nullptr;
+    DxvkHashState hash;
+    hash.add(state.hash());
+    hash.add(std::hash<const DxvkRenderPass*>()(renderPass));
+    return hash;
   }
   
   
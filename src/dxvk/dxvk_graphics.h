@@ -1,7 +1,10 @@
 #pragma once
 
+#include <atomic>
 #include <mutex>
 
+#include "../util/sync/sync_eventcount.h"
+
 #include "dxvk_bind_mask.h"
 #include "dxvk_constant_state.h"
 #include "dxvk_graphics_state.h"
@@ -71,53 +74,107 @@ namespace dxvk {
   /**
    * \brief Graphics pipeline instance
    * 
-   * Stores a state vector and the
-   * corresponding pipeline handle.
+   * Stores a state vector and the corresponding
+   * pipeline handle. Instances are created before
+   * the pipeline is compiled so that other threads
+   * requesting the same pipeline can wait for the
+   * compilation to finish.
    */
   class DxvkGraphicsPipelineInstance {
 
   public:
 
-    DxvkGraphicsPipelineInstance()
-    : m_stateVector (),
-      m_renderPass  (VK_NULL_HANDLE),
-      m_pipeline    (VK_NULL_HANDLE) { }
-
     DxvkGraphicsPipelineInstance(
       const DxvkGraphicsPipelineStateInfo&  state,
       const DxvkRenderPass*                 rp,
-            VkPipeline                      pipe)
+            size_t                          hash,
+            DxvkGraphicsPipelineInstance*   next)
     : m_stateVector (state),
       m_renderPass  (rp),
-      m_pipeline    (pipe) { }
+      m_hash        (hash),
+      m_next        (next) { }
 
     /**
      * \brief Checks for matching pipeline state
      * 
      * \param [in] stateVector Graphics pipeline state
      * \param [in] renderPass Render pass handle
+     * \param [in] hash Hash of state and render pass
      * \returns \c true if the specialization is compatible
      */
     bool isCompatible(
       const DxvkGraphicsPipelineStateInfo&  state,
-      const DxvkRenderPass*                 rp) {
-      return m_renderPass  == rp
+      const DxvkRenderPass*                 rp,
+            size_t                          hash) const {
+      return m_hash        == hash
+          && m_renderPass  == rp
           && m_stateVector == state;
     }
 
+    /**
+     * \brief Checks whether the pipeline is ready
+     * 
+     * If this returns \c false, the pipeline is
+     * still being compiled on another thread.
+     * \returns \c true if the pipeline can be used
+     */
+    bool isReady() const {
+      return m_ready.load(std::memory_order_acquire);
+    }
+
     /**
      * \brief Retrieves pipeline
+     * 
+     * Only valid if \ref isReady returns \c true.
      * \returns The pipeline handle
      */
     VkPipeline pipeline() const {
       return m_pipeline;
     }
 
+    /**
+     * \brief Sets pipeline handle
+     * 
+     * Publishes the compiled pipeline to other
+     * threads. Must be called exactly once.
+     * \param [in] pipeline The pipeline handle
+     */
+    void setPipeline(VkPipeline pipeline) {
+      m_pipeline = pipeline;
+      m_ready.store(true, std::memory_order_release);
+    }
+
+    /**
+     * \brief Marks the pipeline as used
+     * 
+     * Used to record pipeline usage in the state
+     * cache once per session. Instances that are
+     * only compiled ahead of time are not marked.
+     * \returns \c true if this is the first use
+     */
+    bool markUsed() {
+      return !m_used.load(std::memory_order_relaxed)
+          && !m_used.exchange(true);
+    }
+
+    /**
+     * \brief Next instance in the same hash bucket
+     * \returns Next instance, or \c nullptr
+     */
+    DxvkGraphicsPipelineInstance* next() const {
+      return m_next;
+    }
+
   private:
 
     DxvkGraphicsPipelineStateInfo m_stateVector;
     const DxvkRenderPass*         m_renderPass;
-    VkPipeline                    m_pipeline;
+    size_t                        m_hash;
+    DxvkGraphicsPipelineInstance* m_next;
+
+    VkPipeline                    m_pipeline = VK_NULL_HANDLE;
+    std::atomic<bool>             m_ready    = { false };
+    std::atomic<bool>             m_used     = { false };
 
   };
 
@@ -130,7 +187,7 @@ namespace dxvk {
    * pipeline state vector.
    */
   class DxvkGraphicsPipeline {
-    
+    friend class DxvkPipelineManager;
   public:
     
     DxvkGraphicsPipeline(
@@ -191,6 +248,23 @@ namespace dxvk {
       const DxvkGraphicsPipelineStateInfo&    state,
       const DxvkRenderPass*                   renderPass);
     
+    /**
+     * \brief Pipeline handle without blocking
+     * 
+     * Retrieves a pipeline handle for the given pipeline
+     * state if it is available. Otherwise, the pipeline
+     * will be queued for compilation on a worker thread.
+     * \param [in] state Pipeline state vector
+     * \param [in] renderPass The render pass
+     * \param [out] pending Set to \c true if the pipeline
+     *    is not yet available and the draw must be skipped
+     * \returns Pipeline handle, or \c VK_NULL_HANDLE
+     */
+    VkPipeline getPipelineHandleAsync(
+      const DxvkGraphicsPipelineStateInfo&    state,
+      const DxvkRenderPass*                   renderPass,
+            bool&                             pending);
+    
     /**
      * \brief Compiles a pipeline
      * 
@@ -219,15 +293,41 @@ namespace dxvk {
     DxvkGraphicsPipelineFlags           m_flags;
     DxvkGraphicsCommonPipelineStateInfo m_common;
     
-    // List of pipeline instances, shared between threads
+    // Hash table of pipeline instances. Lookups are lock-free
+    // since instances are only ever prepended to a bucket, and
+    // the lock is only taken in order to insert new instances.
     alignas(CACHE_LINE_SIZE) sync::Spinlock   m_mutex;
-    std::vector<DxvkGraphicsPipelineInstance> m_pipelines;
+    std::array<std::atomic<DxvkGraphicsPipelineInstance*>, 64> m_buckets = { };
+
+    // Used to wait for pipelines compiled on other threads
+    sync::EventCount            m_compileEvent;
     
-    DxvkGraphicsPipelineInstance* createInstance(
+    DxvkGraphicsPipelineInstance* getInstance(
+      const DxvkGraphicsPipelineStateInfo& state,
+      const DxvkRenderPass*                renderPass,
+            bool&                          created);
+
+    DxvkGraphicsPipelineInstance* findInstance(
+      const DxvkGraphicsPipelineStateInfo& state,
+      const DxvkRenderPass*                renderPass,
+            size_t                         hash) const;
+    
+    DxvkGraphicsPipelineInstance* insertInstance(
+      const DxvkGraphicsPipelineStateInfo& state,
+      const DxvkRenderPass*                renderPass,
+            size_t                         hash,
+            bool&                          created);
+
+    void compileInstance(
+            DxvkGraphicsPipelineInstance*  instance,
       const DxvkGraphicsPipelineStateInfo& state,
       const DxvkRenderPass*                renderPass);
     
-    DxvkGraphicsPipelineInstance* findInstance(
+    VkPipeline createInstancePipeline(
+      const DxvkGraphicsPipelineStateInfo& state,
+      const DxvkRenderPass*                renderPass);
+
+    static size_t computeInstanceHash(
       const DxvkGraphicsPipelineStateInfo& state,
       const DxvkRenderPass*                renderPass);
     
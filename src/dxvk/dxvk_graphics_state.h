@@ -648,6 +648,20 @@ namespace dxvk {
       return !bit::bcmpeq(this, &other);
     }
 
+    size_t hash() const {
+      // The structure is always fully initialized, so
+      // we can just hash the raw data in 64-bit words
+      auto data = reinterpret_cast<const uint64_t*>(this);
+      uint64_t result = 0;
+
+      for (size_t i = 0; i < sizeof(*this) / sizeof(uint64_t); i++) {
+        result = (result << 5) | (result >> 59);
+        result = (result ^ data[i]) * 0x9e3779b97f4a7c15ull;
+      }
+
+      return size_t(result ^ (result >> 32));
+    }
+
     bool useDynamicStencilRef() const {
       return ds.enableStencilTest();
     }
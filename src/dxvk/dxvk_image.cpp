@@ -1,4 +1,5 @@
 #include "dxvk_image.h"
+#include "dxvk_meta_mipgen.h"
 
 namespace dxvk {
   
@@ -181,6 +182,28 @@ namespace dxvk {
   }
   
   
+  Rc<DxvkMetaMipGenRenderPass> DxvkImageView::getMipGenRenderPass() const {
+    return m_mipGenRenderPass;
+  }
+  
+  
+  void DxvkImageView::setMipGenRenderPass(
+    const Rc<DxvkMetaMipGenRenderPass>& pass) {
+    m_mipGenRenderPass = pass;
+  }
+  
+  
+  Rc<DxvkMetaMipGenComputePass> DxvkImageView::getMipGenComputePass() const {
+    return m_mipGenComputePass;
+  }
+  
+  
+  void DxvkImageView::setMipGenComputePass(
+    const Rc<DxvkMetaMipGenComputePass>& pass) {
+    m_mipGenComputePass = pass;
+  }
+  
+  
   void DxvkImageView::createView(VkImageViewType type, uint32_t numLayers) {
     VkImageSubresourceRange subresourceRange;
     subresourceRange.aspectMask     = m_info.aspect;
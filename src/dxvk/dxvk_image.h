@@ -286,6 +286,10 @@ namespace dxvk {
   };
   
   
+  class DxvkMetaMipGenRenderPass;
+  class DxvkMetaMipGenComputePass;
+  
+  
   /**
    * \brief DXVK image view
    */
@@ -453,6 +457,37 @@ namespace dxvk {
       return result;
     }
 
+    /**
+     * \brief Cached mip generation render pass
+     * 
+     * Mip generation objects are created by the context
+     * on first use and destroyed along with the view.
+     * They must only be accessed from the thread that
+     * executes the context.
+     * \returns Render pass, or \c nullptr if not created yet
+     */
+    Rc<DxvkMetaMipGenRenderPass> getMipGenRenderPass() const;
+
+    /**
+     * \brief Caches mip generation render pass
+     * \param [in] pass Render pass
+     */
+    void setMipGenRenderPass(
+      const Rc<DxvkMetaMipGenRenderPass>& pass);
+
+    /**
+     * \brief Cached mip generation compute pass
+     * \returns Compute pass, or \c nullptr if not created yet
+     */
+    Rc<DxvkMetaMipGenComputePass> getMipGenComputePass() const;
+
+    /**
+     * \brief Caches mip generation compute pass
+     * \param [in] pass Compute pass
+     */
+    void setMipGenComputePass(
+      const Rc<DxvkMetaMipGenComputePass>& pass);
+
   private:
     
     Rc<vk::DeviceFn>  m_vkd;
@@ -461,6 +496,9 @@ namespace dxvk {
     DxvkImageViewCreateInfo m_info;
     VkImageView             m_views[ViewCount];
 
+    Rc<DxvkMetaMipGenRenderPass>  m_mipGenRenderPass;
+    Rc<DxvkMetaMipGenComputePass> m_mipGenComputePass;
+
     void createView(VkImageViewType type, uint32_t numLayers);
     
   };
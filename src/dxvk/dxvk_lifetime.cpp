@@ -2,6 +2,40 @@
 
 namespace dxvk {
   
+  DxvkTrackedResourceSet:: DxvkTrackedResourceSet()
+  : m_keys(MinCapacity, 0) { }
+  
+  DxvkTrackedResourceSet::~DxvkTrackedResourceSet() { }
+  
+  
+  void DxvkTrackedResourceSet::clear() {
+    if (m_count) {
+      std::fill(m_keys.begin(), m_keys.end(), 0);
+      m_count = 0;
+    }
+  }
+  
+  
+  void DxvkTrackedResourceSet::grow() {
+    std::vector<uintptr_t> keys(2 * m_keys.size(), 0);
+    std::swap(keys, m_keys);
+    
+    size_t mask = m_keys.size() - 1;
+    
+    for (uintptr_t key : keys) {
+      if (!key)
+        continue;
+      
+      size_t index = hashKey(key) & mask;
+      
+      while (m_keys[index])
+        index = (index + 1) & mask;
+      
+      m_keys[index] = key;
+    }
+  }
+  
+  
   DxvkLifetimeTracker:: DxvkLifetimeTracker() { }
   DxvkLifetimeTracker::~DxvkLifetimeTracker() { }
   
@@ -10,6 +44,8 @@ namespace dxvk {
     for (const auto& resource : m_resources)
       resource.first->release(resource.second);
     m_resources.clear();
+    m_resourceSet.clear();
+    m_trackCount = 0;
   }
   
-}
\ No newline at end of file
+}
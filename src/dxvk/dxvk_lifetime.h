@@ -6,6 +6,70 @@
 
 namespace dxvk {
   
+  /**
+   * \brief Tracked resource set
+   * 
+   * Small open-addressing hash set of resource
+   * and access type pairs. Used to skip resources
+   * that are already tracked by a command list.
+   */
+  class DxvkTrackedResourceSet {
+    constexpr static size_t MinCapacity = 64;
+  public:
+    
+    DxvkTrackedResourceSet();
+    ~DxvkTrackedResourceSet();
+    
+    /**
+     * \brief Inserts a resource
+     * 
+     * \param [in] rc The resource
+     * \param [in] access Access type
+     * \returns \c true if the resource was not
+     *    yet in the set with the given access
+     */
+    bool insert(DxvkResource* rc, DxvkAccess access) {
+      uintptr_t key = reinterpret_cast<uintptr_t>(rc) | uintptr_t(access);
+      
+      if (unlikely(2 * (m_count + 1) > m_keys.size()))
+        this->grow();
+      
+      size_t mask  = m_keys.size() - 1;
+      size_t index = hashKey(key) & mask;
+      
+      while (m_keys[index]) {
+        if (m_keys[index] == key)
+          return false;
+        index = (index + 1) & mask;
+      }
+      
+      m_keys[index] = key;
+      m_count += 1;
+      return true;
+    }
+    
+    /**
+     * \brief Removes all resources
+     */
+    void clear();
+    
+  private:
+    
+    std::vector<uintptr_t> m_keys;
+    size_t                 m_count = 0;
+    
+    void grow();
+    
+    static size_t hashKey(uintptr_t key) {
+      // Resources are heap-allocated, so the lowest bits
+      // of the pointer do not carry any useful information
+      uint64_t hash = uint64_t(key >> 4) * 0x9E3779B97F4A7C15ull;
+      return size_t(hash >> 32) ^ size_t(key & 0x3);
+    }
+    
+  };
+  
+  
   /**
    * \brief DXVK lifetime tracker
    * 
@@ -23,12 +87,38 @@ namespace dxvk {
     
     /**
      * \brief Adds a resource to track
+     * 
+     * Resources that are already tracked with the same
+     * access type are ignored, so that the reference and
+     * use counts are only modified once per command list.
      * \param [in] rc The resource to track
      */
     template<DxvkAccess Access>
-    void trackResource(Rc<DxvkResource>&& rc) {
+    void trackResource(DxvkResource* rc) {
+      m_trackCount += 1;
+
+      if (!m_resourceSet.insert(rc, Access))
+        return;
+      
       rc->acquire(Access);
-      m_resources.emplace_back(std::move(rc), Access);
+      m_resources.emplace_back(rc, Access);
+    }
+    
+    /**
+     * \brief Number of tracked resources
+     * \returns Number of unique resource and access pairs
+     */
+    size_t resourceCount() const {
+      return m_resources.size();
+    }
+    
+    /**
+     * \brief Number of tracking requests
+     * \returns Number of resources passed to \ref trackResource,
+     *    including the ones that were already tracked
+     */
+    uint64_t trackCount() const {
+      return m_trackCount;
     }
     
     /**
@@ -42,7 +132,9 @@ namespace dxvk {
   private:
     
     std::vector<std::pair<Rc<DxvkResource>, DxvkAccess>> m_resources;
+    DxvkTrackedResourceSet                                m_resourceSet;
+    uint64_t                                              m_trackCount = 0;
     
   };
   
-}
\ No newline at end of file
+}
@@ -11,6 +11,7 @@ namespace dxvk {
           VkDeviceMemory        memory,
           VkDeviceSize          offset,
           VkDeviceSize          length,
+          uint32_t              block,
           void*                 mapPtr)
   : m_alloc   (alloc),
     m_chunk   (chunk),
@@ -18,6 +19,7 @@ namespace dxvk {
     m_memory  (memory),
     m_offset  (offset),
     m_length  (length),
+    m_block   (block),
     m_mapPtr  (mapPtr) { }
   
   
@@ -28,6 +30,7 @@ namespace dxvk {
     m_memory  (std::exchange(other.m_memory, VkDeviceMemory(VK_NULL_HANDLE))),
     m_offset  (std::exchange(other.m_offset, 0)),
     m_length  (std::exchange(other.m_length, 0)),
+    m_block   (std::exchange(other.m_block,  DxvkTlsfAllocator::InvalidBlock)),
     m_mapPtr  (std::exchange(other.m_mapPtr, nullptr)) { }
   
   
@@ -39,6 +42,7 @@ namespace dxvk {
     m_memory  = std::exchange(other.m_memory, VkDeviceMemory(VK_NULL_HANDLE));
     m_offset  = std::exchange(other.m_offset, 0);
     m_length  = std::exchange(other.m_length, 0);
+    m_block   = std::exchange(other.m_block,  DxvkTlsfAllocator::InvalidBlock);
     m_mapPtr  = std::exchange(other.m_mapPtr, nullptr);
     return *this;
   }
@@ -59,9 +63,9 @@ namespace dxvk {
           DxvkMemoryAllocator*  alloc,
           DxvkMemoryType*       type,
           DxvkDeviceMemory      memory)
-  : m_alloc(alloc), m_type(type), m_memory(memory) {
-    // Mark the entire chunk as free
-    m_freeList.push_back(FreeSlice { 0, memory.memSize });
+  : m_alloc(alloc), m_type(type), m_memory(memory),
+    m_allocator(memory.memSize) {
+
   }
   
   
@@ -83,72 +87,22 @@ namespace dxvk {
      || m_memory.priority != priority)
       return DxvkMemory();
     
-    // If the chunk is full, return
-    if (m_freeList.size() == 0)
-      return DxvkMemory();
-    
-    // Select the slice to allocate from in a worst-fit
-    // manner. This may help keep fragmentation low.
-    auto bestSlice = m_freeList.begin();
-    
-    for (auto slice = m_freeList.begin(); slice != m_freeList.end(); slice++) {
-      if (slice->length == size) {
-        bestSlice = slice;
-        break;
-      } else if (slice->length > bestSlice->length) {
-        bestSlice = slice;
-      }
-    }
-    
-    // We need to align the allocation to the requested alignment
-    const VkDeviceSize sliceStart = bestSlice->offset;
-    const VkDeviceSize sliceEnd   = bestSlice->offset + bestSlice->length;
-    
-    const VkDeviceSize allocStart = dxvk::align(sliceStart,        align);
-    const VkDeviceSize allocEnd   = dxvk::align(allocStart + size, align);
-    
-    if (allocEnd > sliceEnd)
+    // Allocate the aligned slice from the sub-allocator. Both
+    // allocating and freeing ranges runs in constant time.
+    auto slice = m_allocator.alloc(dxvk::align(size, align), align);
+
+    if (slice.block == DxvkTlsfAllocator::InvalidBlock)
       return DxvkMemory();
     
-    // We can use this slice, but we'll have to add
-    // the unused parts of it back to the free list.
-    m_freeList.erase(bestSlice);
-    
-    if (allocStart != sliceStart)
-      m_freeList.push_back({ sliceStart, allocStart - sliceStart });
-    
-    if (allocEnd != sliceEnd)
-      m_freeList.push_back({ allocEnd, sliceEnd - allocEnd });
-    
-    // Create the memory object with the aligned slice
     return DxvkMemory(m_alloc, this, m_type,
-      m_memory.memHandle, allocStart, allocEnd - allocStart,
-      reinterpret_cast<char*>(m_memory.memPointer) + allocStart);
+      m_memory.memHandle, slice.offset, slice.length, slice.block,
+      reinterpret_cast<char*>(m_memory.memPointer) + slice.offset);
   }
   
   
   void DxvkMemoryChunk::free(
-          VkDeviceSize  offset,
-          VkDeviceSize  length) {
-    // Remove adjacent entries from the free list and then add
-    // a new slice that covers all those entries. Without doing
-    // so, the slice could not be reused for larger allocations.
-    auto curr = m_freeList.begin();
-    
-    while (curr != m_freeList.end()) {
-      if (curr->offset == offset + length) {
-        length += curr->length;
-        curr = m_freeList.erase(curr);
-      } else if (curr->offset + curr->length == offset) {
-        offset -= curr->length;
-        length += curr->length;
-        curr = m_freeList.erase(curr);
-      } else {
-        curr++;
-      }
-    }
-    
-    m_freeList.push_back({ offset, length });
+          uint32_t      block) {
+    m_allocator.free(block);
   }
   
   
@@ -157,9 +111,30 @@ namespace dxvk {
     m_device          (device),
     m_devProps        (device->adapter()->deviceProperties()),
     m_memProps        (device->adapter()->memoryProperties()) {
+    this->initMemoryTypes();
+  }
+  
+  
+  DxvkMemoryAllocator::DxvkMemoryAllocator(
+    const Rc<vk::DeviceFn>&                 vkd,
+    const VkPhysicalDeviceProperties&       devProps,
+    const VkPhysicalDeviceMemoryProperties& memProps)
+  : m_vkd             (vkd),
+    m_device          (nullptr),
+    m_devProps        (devProps),
+    m_memProps        (memProps) {
+    this->initMemoryTypes();
+  }
+  
+  
+  DxvkMemoryAllocator::~DxvkMemoryAllocator() {
+    
+  }
+  
+  
+  void DxvkMemoryAllocator::initMemoryTypes() {
     for (uint32_t i = 0; i < m_memProps.memoryHeapCount; i++) {
       m_memHeaps[i].properties = m_memProps.memoryHeaps[i];
-      m_memHeaps[i].stats      = DxvkMemoryStats { 0, 0 };
     }
     
     for (uint32_t i = 0; i < m_memProps.memoryTypeCount; i++) {
@@ -172,19 +147,12 @@ namespace dxvk {
   }
   
   
-  DxvkMemoryAllocator::~DxvkMemoryAllocator() {
-    
-  }
-  
-  
   DxvkMemory DxvkMemoryAllocator::alloc(
     const VkMemoryRequirements*             req,
     const VkMemoryDedicatedRequirements&    dedAllocReq,
     const VkMemoryDedicatedAllocateInfoKHR& dedAllocInfo,
           VkMemoryPropertyFlags             flags,
           float                             priority) {
-    std::lock_guard<std::mutex> lock(m_mutex);
-
     // Try to allocate from a memory type which supports the given flags exactly
     auto dedAllocPtr = dedAllocReq.prefersDedicatedAllocation ? &dedAllocInfo : nullptr;
     DxvkMemory result = this->tryAlloc(req, dedAllocPtr, flags, priority);
@@ -203,7 +171,13 @@ namespace dxvk {
       result = this->tryAlloc(req, dedAllocPtr, flags & ~optFlags, priority);
     
     if (!result) {
-      DxvkAdapterMemoryInfo memHeapInfo = m_device->adapter()->getMemoryHeapInfo();
+      bool hasMemoryBudget = m_device != nullptr
+        && m_device->extensions().extMemoryBudget;
+
+      DxvkAdapterMemoryInfo memHeapInfo = { };
+
+      if (hasMemoryBudget)
+        memHeapInfo = m_device->adapter()->getMemoryHeapInfo();
 
       Logger::err(str::format(
         "DxvkMemoryAllocator: Memory allocation failed",
@@ -214,9 +188,9 @@ namespace dxvk {
 
       for (uint32_t i = 0; i < m_memProps.memoryHeapCount; i++) {
         Logger::err(str::format("Heap ", i, ": ",
-          (m_memHeaps[i].stats.memoryAllocated >> 20), " MB allocated, ",
-          (m_memHeaps[i].stats.memoryUsed      >> 20), " MB used, ",
-          m_device->extensions().extMemoryBudget
+          (m_memHeaps[i].memoryAllocated.load() >> 20), " MB allocated, ",
+          (m_memHeaps[i].memoryUsed.load()      >> 20), " MB used, ",
+          hasMemoryBudget
             ? str::format(
                 (memHeapInfo.heaps[i].memoryAllocated >> 20), " MB allocated (driver), ",
                 (memHeapInfo.heaps[i].memoryBudget    >> 20), " MB budget (driver), ",
@@ -273,8 +247,11 @@ namespace dxvk {
         type, flags, size, priority, dedAllocInfo);
 
       if (devMem.memHandle != VK_NULL_HANDLE)
-        memory = DxvkMemory(this, nullptr, type, devMem.memHandle, 0, size, devMem.memPointer);
+        memory = DxvkMemory(this, nullptr, type, devMem.memHandle, 0, size,
+          DxvkTlsfAllocator::InvalidBlock, devMem.memPointer);
     } else {
+      std::lock_guard<std::mutex> lock(type->mutex);
+
       for (uint32_t i = 0; i < type->chunks.size() && !memory; i++)
         memory = type->chunks[i]->alloc(flags, size, align, priority);
       
@@ -294,7 +271,7 @@ namespace dxvk {
     }
 
     if (memory)
-      type->heap->stats.memoryUsed += memory.m_length;
+      type->heap->memoryUsed += memory.m_length;
 
     return memory;
   }
@@ -307,6 +284,7 @@ namespace dxvk {
           float                             priority,
     const VkMemoryDedicatedAllocateInfoKHR* dedAllocInfo) {
     bool useMemoryPriority = (flags & VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT)
+                          && (m_device != nullptr)
                           && (m_device->features().extMemoryPriority.memoryPriority);
     
     DxvkDeviceMemory result;
@@ -338,23 +316,23 @@ namespace dxvk {
       }
     }
 
-    type->heap->stats.memoryAllocated += size;
-    m_device->adapter()->notifyHeapMemoryAlloc(type->heapId, size);
+    type->heap->memoryAllocated += size;
+
+    if (m_device != nullptr)
+      m_device->adapter()->notifyHeapMemoryAlloc(type->heapId, size);
     return result;
   }
 
 
   void DxvkMemoryAllocator::free(
     const DxvkMemory&           memory) {
-    std::lock_guard<std::mutex> lock(m_mutex);
-    memory.m_type->heap->stats.memoryUsed -= memory.m_length;
+    memory.m_type->heap->memoryUsed -= memory.m_length;
 
     if (memory.m_chunk != nullptr) {
       this->freeChunkMemory(
         memory.m_type,
         memory.m_chunk,
-        memory.m_offset,
-        memory.m_length);
+        memory.m_block);
     } else {
       DxvkDeviceMemory devMem;
       devMem.memHandle  = memory.m_memory;
@@ -368,9 +346,9 @@ namespace dxvk {
   void DxvkMemoryAllocator::freeChunkMemory(
           DxvkMemoryType*       type,
           DxvkMemoryChunk*      chunk,
-          VkDeviceSize          offset,
-          VkDeviceSize          length) {
-    chunk->free(offset, length);
+          uint32_t              block) {
+    std::lock_guard<std::mutex> lock(type->mutex);
+    chunk->free(block);
   }
   
 
@@ -378,8 +356,10 @@ namespace dxvk {
           DxvkMemoryType*       type,
           DxvkDeviceMemory      memory) {
     m_vkd->vkFreeMemory(m_vkd->device(), memory.memHandle, nullptr);
-    type->heap->stats.memoryAllocated -= memory.memSize;
-    m_device->adapter()->notifyHeapMemoryFree(type->heapId, memory.memSize);
+    type->heap->memoryAllocated -= memory.memSize;
+
+    if (m_device != nullptr)
+      m_device->adapter()->notifyHeapMemoryFree(type->heapId, memory.memSize);
   }
 
 
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "dxvk_adapter.h"
+#include "dxvk_memory_tlsf.h"
 
 namespace dxvk {
   
@@ -16,6 +17,7 @@ namespace dxvk {
   struct DxvkMemoryStats {
     VkDeviceSize memoryAllocated = 0;
     VkDeviceSize memoryUsed      = 0;
+    VkDeviceSize memoryTrimmed   = 0;
   };
   
   
@@ -40,10 +42,14 @@ namespace dxvk {
    * 
    * Corresponds to a Vulkan memory heap and stores
    * its properties as well as allocation statistics.
+   * Multiple memory types can share the same heap,
+   * so the statistics are updated atomically.
    */
   struct DxvkMemoryHeap {
-    VkMemoryHeap      properties;
-    DxvkMemoryStats   stats;
+    VkMemoryHeap                properties;
+    std::atomic<VkDeviceSize>   memoryAllocated = { 0ull };
+    std::atomic<VkDeviceSize>   memoryUsed      = { 0ull };
+    std::atomic<VkDeviceSize>   memoryTrimmed   = { 0ull };
   };
 
 
@@ -52,9 +58,13 @@ namespace dxvk {
    * 
    * Corresponds to a Vulkan memory type and stores
    * memory chunks used to sub-allocate memory on
-   * this memory type.
+   * this memory type. The chunk list as well as
+   * all chunk allocators are protected by the
+   * per-type lock.
    */
   struct DxvkMemoryType {
+    std::mutex        mutex;
+
     DxvkMemoryHeap*   heap;
     uint32_t          heapId;
 
@@ -85,6 +95,7 @@ namespace dxvk {
       VkDeviceMemory        memory,
       VkDeviceSize          offset,
       VkDeviceSize          length,
+      uint32_t              block,
       void*                 mapPtr);
     DxvkMemory             (DxvkMemory&& other);
     DxvkMemory& operator = (DxvkMemory&& other);
@@ -149,6 +160,7 @@ namespace dxvk {
     VkDeviceMemory        m_memory = VK_NULL_HANDLE;
     VkDeviceSize          m_offset = 0;
     VkDeviceSize          m_length = 0;
+    uint32_t              m_block  = DxvkTlsfAllocator::InvalidBlock;
     void*                 m_mapPtr = nullptr;
     
     void free();
@@ -160,7 +172,8 @@ namespace dxvk {
    * \brief Memory chunk
    * 
    * A single chunk of memory that provides a
-   * sub-allocator. This is not thread-safe.
+   * sub-allocator. This is not thread-safe, the
+   * owning memory type's lock must be held.
    */
   class DxvkMemoryChunk : public RcObject {
     
@@ -196,25 +209,18 @@ namespace dxvk {
      * Returns a slice back to the chunk.
      * Called automatically when a memory
      * slice runs out of scope.
-     * \param [in] offset Slice offset
-     * \param [in] length Slice length
+     * \param [in] block Sub-allocator block index
      */
     void free(
-            VkDeviceSize  offset,
-            VkDeviceSize  length);
+            uint32_t      block);
     
   private:
     
-    struct FreeSlice {
-      VkDeviceSize offset;
-      VkDeviceSize length;
-    };
-    
     DxvkMemoryAllocator*  m_alloc;
     DxvkMemoryType*       m_type;
     DxvkDeviceMemory      m_memory;
     
-    std::vector<FreeSlice> m_freeList;
+    DxvkTlsfAllocator     m_allocator;
     
   };
   
@@ -231,6 +237,23 @@ namespace dxvk {
   public:
     
     DxvkMemoryAllocator(const DxvkDevice* device);
+
+    /**
+     * \brief Creates an allocator without a device
+     * 
+     * Only uses the given Vulkan functions to allocate,
+     * map and free memory, and does not report memory
+     * usage to an adapter. Allows testing the allocator
+     * with stubbed Vulkan functions.
+     * \param [in] vkd Vulkan device functions
+     * \param [in] devProps Device properties
+     * \param [in] memProps Memory properties
+     */
+    DxvkMemoryAllocator(
+      const Rc<vk::DeviceFn>&                 vkd,
+      const VkPhysicalDeviceProperties&       devProps,
+      const VkPhysicalDeviceMemoryProperties& memProps);
+
     ~DxvkMemoryAllocator();
     
     /**
@@ -266,12 +289,32 @@ namespace dxvk {
      * \brief Queries memory stats
      * 
      * Returns the total amount of memory
-     * allocated and used for a given heap.
+     * allocated and used for a given heap,
+     * as well as the amount of memory freed
+     * by trimming resources so far.
      * \param [in] heap Heap index
      * \returns Memory stats for this heap
      */
     DxvkMemoryStats getMemoryStats(uint32_t heap) const {
-      return m_memHeaps[heap].stats;
+      DxvkMemoryStats stats;
+      stats.memoryAllocated = m_memHeaps[heap].memoryAllocated.load();
+      stats.memoryUsed      = m_memHeaps[heap].memoryUsed.load();
+      stats.memoryTrimmed   = m_memHeaps[heap].memoryTrimmed.load();
+      return stats;
+    }
+
+    /**
+     * \brief Records trimmed memory
+     * 
+     * Resources call this when they release memory
+     * that is no longer needed during their lifetime,
+     * so that the amount of memory freed this way
+     * can be reported in the memory stats.
+     * \param [in] memory The memory being released
+     */
+    void recordTrim(const DxvkMemory& memory) {
+      if (memory.m_type != nullptr)
+        memory.m_type->heap->memoryTrimmed += memory.m_length;
     }
     
   private:
@@ -281,10 +324,11 @@ namespace dxvk {
     const VkPhysicalDeviceProperties       m_devProps;
     const VkPhysicalDeviceMemoryProperties m_memProps;
     
-    std::mutex                                      m_mutex;
     std::array<DxvkMemoryHeap, VK_MAX_MEMORY_HEAPS> m_memHeaps;
     std::array<DxvkMemoryType, VK_MAX_MEMORY_TYPES> m_memTypes;
     
+    void initMemoryTypes();
+
     DxvkMemory tryAlloc(
       const VkMemoryRequirements*             req,
       const VkMemoryDedicatedAllocateInfoKHR* dedAllocInfo,
@@ -312,8 +356,7 @@ namespace dxvk {
     void freeChunkMemory(
             DxvkMemoryType*       type,
             DxvkMemoryChunk*      chunk,
-            VkDeviceSize          offset,
-            VkDeviceSize          length);
+            uint32_t              block);
     
     void freeDeviceMemory(
             DxvkMemoryType*       type,
@@ -0,0 +1,302 @@
+#include "dxvk_memory_tlsf.h"
+
+namespace dxvk {
+
+  static uint32_t findMsb(uint64_t n) {
+    uint32_t hi = uint32_t(n >> 32);
+
+    return hi != 0
+      ? 63 - bit::lzcnt(hi)
+      : 31 - bit::lzcnt(uint32_t(n));
+  }
+
+
+  static uint32_t findLsb(uint64_t n) {
+    uint32_t lo = uint32_t(n);
+
+    return lo != 0
+      ? bit::tzcnt(lo)
+      : bit::tzcnt(uint32_t(n >> 32)) + 32;
+  }
+
+
+  DxvkTlsfAllocator::DxvkTlsfAllocator(VkDeviceSize size)
+  : m_size(size), m_freeSize(size) {
+    m_slMasks.fill(0);
+    m_freeLists.fill(InvalidBlock);
+
+    // Mark the entire range as free
+    insertFreeBlock(createBlock(0, size));
+  }
+
+
+  DxvkTlsfAllocator::~DxvkTlsfAllocator() {
+
+  }
+
+
+  DxvkTlsfAllocator::Slice DxvkTlsfAllocator::alloc(
+          VkDeviceSize          size,
+          VkDeviceSize          align) {
+    Slice result = { 0, 0, InvalidBlock };
+
+    if (!size || size > m_freeSize)
+      return result;
+
+    // Try a block of the requested size first, so that aligned
+    // holes which fit exactly can be reused. If the candidate
+    // cannot hold the aligned range, look for a block which is
+    // large enough for any offset, so that we never have to
+    // check more than two blocks regardless of alignment.
+    uint32_t blockId = findFreeBlock(size);
+
+    if (blockId != InvalidBlock && !fitsBlock(blockId, size, align))
+      blockId = findFreeBlock(size + align - 1);
+
+    if (blockId == InvalidBlock)
+      return result;
+
+    removeFreeBlock(blockId);
+
+    // Split off the padding required for alignment. The
+    // previous block cannot be free, so no merge needed.
+    VkDeviceSize blockOffset = m_blocks[blockId].offset;
+    VkDeviceSize allocOffset = dxvk::align(blockOffset, align);
+
+    if (allocOffset != blockOffset) {
+      uint32_t padId = createBlock(blockOffset, allocOffset - blockOffset);
+
+      Block& block = m_blocks[blockId];
+      Block& pad   = m_blocks[padId];
+
+      pad.prevPhys = block.prevPhys;
+      pad.nextPhys = blockId;
+
+      if (block.prevPhys != InvalidBlock)
+        m_blocks[block.prevPhys].nextPhys = padId;
+
+      block.prevPhys = padId;
+      block.offset  += pad.length;
+      block.length  -= pad.length;
+
+      insertFreeBlock(padId);
+    }
+
+    // Return the unused tail of the block to the free list
+    if (m_blocks[blockId].length != size) {
+      Block& block = m_blocks[blockId];
+
+      uint32_t tailId = createBlock(
+        block.offset + size,
+        block.length - size);
+
+      Block& head = m_blocks[blockId];
+      Block& tail = m_blocks[tailId];
+
+      tail.prevPhys = blockId;
+      tail.nextPhys = head.nextPhys;
+
+      if (head.nextPhys != InvalidBlock)
+        m_blocks[head.nextPhys].prevPhys = tailId;
+
+      head.nextPhys = tailId;
+      head.length   = size;
+
+      insertFreeBlock(tailId);
+    }
+
+    m_freeSize -= size;
+
+    result.offset = allocOffset;
+    result.length = size;
+    result.block  = blockId;
+    return result;
+  }
+
+
+  void DxvkTlsfAllocator::free(
+          uint32_t              blockId) {
+    m_freeSize += m_blocks[blockId].length;
+
+    // Merge with the previous block if it is free
+    uint32_t prevId = m_blocks[blockId].prevPhys;
+
+    if (prevId != InvalidBlock && m_blocks[prevId].isFree) {
+      removeFreeBlock(prevId);
+
+      Block& block = m_blocks[blockId];
+      Block& prev  = m_blocks[prevId];
+
+      prev.length  += block.length;
+      prev.nextPhys = block.nextPhys;
+
+      if (block.nextPhys != InvalidBlock)
+        m_blocks[block.nextPhys].prevPhys = prevId;
+
+      destroyBlock(blockId);
+      blockId = prevId;
+    }
+
+    // Merge with the next block if it is free
+    uint32_t nextId = m_blocks[blockId].nextPhys;
+
+    if (nextId != InvalidBlock && m_blocks[nextId].isFree) {
+      removeFreeBlock(nextId);
+
+      Block& block = m_blocks[blockId];
+      Block& next  = m_blocks[nextId];
+
+      block.length  += next.length;
+      block.nextPhys = next.nextPhys;
+
+      if (next.nextPhys != InvalidBlock)
+        m_blocks[next.nextPhys].prevPhys = blockId;
+
+      destroyBlock(nextId);
+    }
+
+    insertFreeBlock(blockId);
+  }
+
+
+  uint32_t DxvkTlsfAllocator::createBlock(
+          VkDeviceSize          offset,
+          VkDeviceSize          length) {
+    uint32_t blockId;
+
+    if (!m_unusedBlocks.empty()) {
+      blockId = m_unusedBlocks.back();
+      m_unusedBlocks.pop_back();
+    } else {
+      blockId = uint32_t(m_blocks.size());
+      m_blocks.emplace_back();
+    }
+
+    Block& block = m_blocks[blockId];
+    block.offset   = offset;
+    block.length   = length;
+    block.prevPhys = InvalidBlock;
+    block.nextPhys = InvalidBlock;
+    block.prevFree = InvalidBlock;
+    block.nextFree = InvalidBlock;
+    block.isFree   = false;
+    return blockId;
+  }
+
+
+  void DxvkTlsfAllocator::destroyBlock(
+          uint32_t              blockId) {
+    m_unusedBlocks.push_back(blockId);
+  }
+
+
+  void DxvkTlsfAllocator::insertFreeBlock(
+          uint32_t              blockId) {
+    Block& block = m_blocks[blockId];
+
+    uint32_t list = mapSize(block.length);
+    uint32_t head = m_freeLists[list];
+
+    block.isFree   = true;
+    block.prevFree = InvalidBlock;
+    block.nextFree = head;
+
+    if (head != InvalidBlock)
+      m_blocks[head].prevFree = blockId;
+
+    m_freeLists[list] = blockId;
+
+    m_flMask |= uint64_t(1) << (list / SlCount);
+    m_slMasks[list / SlCount] |= 1u << (list % SlCount);
+  }
+
+
+  void DxvkTlsfAllocator::removeFreeBlock(
+          uint32_t              blockId) {
+    Block& block = m_blocks[blockId];
+
+    uint32_t list = mapSize(block.length);
+
+    if (block.prevFree != InvalidBlock)
+      m_blocks[block.prevFree].nextFree = block.nextFree;
+    else
+      m_freeLists[list] = block.nextFree;
+
+    if (block.nextFree != InvalidBlock)
+      m_blocks[block.nextFree].prevFree = block.prevFree;
+
+    block.isFree   = false;
+    block.prevFree = InvalidBlock;
+    block.nextFree = InvalidBlock;
+
+    if (m_freeLists[list] == InvalidBlock) {
+      m_slMasks[list / SlCount] &= ~(1u << (list % SlCount));
+
+      if (!m_slMasks[list / SlCount])
+        m_flMask &= ~(uint64_t(1) << (list / SlCount));
+    }
+  }
+
+
+  bool DxvkTlsfAllocator::fitsBlock(
+          uint32_t              blockId,
+          VkDeviceSize          size,
+          VkDeviceSize          align) const {
+    const Block& block = m_blocks[blockId];
+
+    VkDeviceSize offset = dxvk::align(block.offset, align);
+    return offset + size <= block.offset + block.length;
+  }
+
+
+  uint32_t DxvkTlsfAllocator::findFreeBlock(
+          VkDeviceSize          size) const {
+    // Blocks in the size class of the requested size may
+    // be too small, so only the head of that list is an
+    // exact fit candidate. Check it before rounding up.
+    uint32_t list = mapSize(size);
+    uint32_t head = m_freeLists[list];
+
+    if (head != InvalidBlock && m_blocks[head].length >= size)
+      return head;
+
+    // Round the size up to the next size class so
+    // that any block in the list is large enough
+    if (size >= SlCount)
+      size += (VkDeviceSize(1) << (findMsb(size) - SlBits)) - 1;
+
+    list = mapSize(size);
+    uint32_t fl = list / SlCount;
+    uint32_t sl = list % SlCount;
+
+    uint32_t slMask = m_slMasks[fl] & (~0u << sl);
+
+    if (!slMask) {
+      uint64_t flMask = m_flMask & (~uint64_t(0) << (fl + 1));
+
+      if (!flMask)
+        return InvalidBlock;
+
+      fl = findLsb(flMask);
+      slMask = m_slMasks[fl];
+    }
+
+    sl = bit::tzcnt(slMask);
+    return m_freeLists[fl * SlCount + sl];
+  }
+
+
+  uint32_t DxvkTlsfAllocator::mapSize(
+          VkDeviceSize          size) {
+    // Sizes below the first power-of-two class
+    // are stored in linearly spaced lists
+    if (size < SlCount)
+      return uint32_t(size);
+
+    uint32_t msb = findMsb(size);
+    uint32_t fl  = msb - SlBits + 1;
+    uint32_t sl  = uint32_t(size >> (msb - SlBits)) ^ SlCount;
+    return fl * SlCount + sl;
+  }
+
+}
@@ -0,0 +1,135 @@
+#pragma once
+
+#include <array>
+#include <vector>
+
+#include "dxvk_include.h"
+
+namespace dxvk {
+
+  /**
+   * \brief TLSF sub-allocator
+   *
+   * Two-level segregated fit allocator which manages
+   * ranges within a single memory chunk. Free blocks
+   * are kept in per-size class lists which are found
+   * through two levels of bit masks, so that both
+   * allocating and freeing memory run in constant
+   * time. Adjacent free blocks are merged on free.
+   *
+   * Block metadata is stored outside of the managed
+   * range since device memory may not be mapped.
+   * This class is not thread-safe.
+   */
+  class DxvkTlsfAllocator {
+    constexpr static uint32_t SlBits  = 4;
+    constexpr static uint32_t SlCount = 1u << SlBits;
+    constexpr static uint32_t FlCount = 64 - SlBits + 1;
+  public:
+
+    constexpr static uint32_t InvalidBlock = ~0u;
+
+    /**
+     * \brief Allocated range
+     *
+     * The block index must be passed back
+     * to \ref free in order to release the
+     * range. If allocation failed, it will
+     * be \c InvalidBlock.
+     */
+    struct Slice {
+      VkDeviceSize  offset;
+      VkDeviceSize  length;
+      uint32_t      block;
+    };
+
+    DxvkTlsfAllocator(VkDeviceSize size);
+    ~DxvkTlsfAllocator();
+
+    /**
+     * \brief Total size of the managed range
+     * \returns Size, in bytes
+     */
+    VkDeviceSize size() const {
+      return m_size;
+    }
+
+    /**
+     * \brief Number of free bytes
+     * \returns Free size, in bytes
+     */
+    VkDeviceSize freeSize() const {
+      return m_freeSize;
+    }
+
+    /**
+     * \brief Allocates a range
+     *
+     * \param [in] size Number of bytes to allocate
+     * \param [in] align Required alignment, must be
+     *    a power of two
+     * \returns Allocated range
+     */
+    Slice alloc(
+            VkDeviceSize          size,
+            VkDeviceSize          align);
+
+    /**
+     * \brief Frees a range
+     *
+     * Merges the block with adjacent free
+     * blocks and returns it to the free list.
+     * \param [in] block Block index of the range
+     */
+    void free(
+            uint32_t              block);
+
+  private:
+
+    struct Block {
+      VkDeviceSize  offset;
+      VkDeviceSize  length;
+      uint32_t      prevPhys;
+      uint32_t      nextPhys;
+      uint32_t      prevFree;
+      uint32_t      nextFree;
+      bool          isFree;
+    };
+
+    VkDeviceSize                        m_size;
+    VkDeviceSize                        m_freeSize;
+
+    std::vector<Block>                  m_blocks;
+    std::vector<uint32_t>               m_unusedBlocks;
+
+    uint64_t                            m_flMask = 0;
+    std::array<uint32_t, FlCount>       m_slMasks;
+    std::array<uint32_t, FlCount * SlCount> m_freeLists;
+
+    uint32_t createBlock(
+            VkDeviceSize          offset,
+            VkDeviceSize          length);
+
+    void destroyBlock(
+            uint32_t              block);
+
+    void insertFreeBlock(
+            uint32_t              block);
+
+    void removeFreeBlock(
+            uint32_t              block);
+
+    bool fitsBlock(
+            uint32_t              block,
+            VkDeviceSize          size,
+            VkDeviceSize          align) const;
+
+    uint32_t findFreeBlock(
+            VkDeviceSize          size) const;
+
+    static uint32_t mapSize(
+            VkDeviceSize          size);
+
+  };
+
+}
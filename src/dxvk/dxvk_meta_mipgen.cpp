@@ -1,11 +1,17 @@
+#include "dxvk_device.h"
 #include "dxvk_meta_mipgen.h"
 
+#include <dxvk_mipgen_2d.h>
+
 namespace dxvk {
 
   DxvkMetaMipGenRenderPass::DxvkMetaMipGenRenderPass(
-    const Rc<vk::DeviceFn>&   vkd,
-    const Rc<DxvkImageView>&  view)
-  : m_vkd(vkd), m_view(view), m_renderPass(createRenderPass()) {
+    const Rc<vk::DeviceFn>&     vkd,
+    const Rc<DxvkImageView>&    view,
+    const DxvkMetaBlitPipeline& pipeline,
+          VkSampler             sampler)
+  : m_vkd(vkd), m_image(view->image()), m_viewInfo(view->info()),
+    m_renderPass(createRenderPass()) {
     // Determine view type based on image type
     const std::array<std::pair<VkImageViewType, VkImageViewType>, 3> viewTypes = {{
       { VK_IMAGE_VIEW_TYPE_1D_ARRAY, VK_IMAGE_VIEW_TYPE_1D_ARRAY },
@@ -21,10 +27,16 @@ namespace dxvk {
     
     for (uint32_t i = 0; i < m_passes.size(); i++)
       m_passes.at(i) = this->createFramebuffer(i);
+    
+    // Descriptor sets only reference the source views,
+    // so they can be written once and reused afterwards
+    this->createDescriptorSets(pipeline, sampler);
   }
   
   
   DxvkMetaMipGenRenderPass::~DxvkMetaMipGenRenderPass() {
+    m_vkd->vkDestroyDescriptorPool(m_vkd->device(), m_descriptorPool, nullptr);
+    
     for (const auto& pass : m_passes) {
       m_vkd->vkDestroyFramebuffer(m_vkd->device(), pass.framebuffer, nullptr);
       m_vkd->vkDestroyImageView(m_vkd->device(), pass.dstView, nullptr);
@@ -36,38 +48,48 @@ namespace dxvk {
   
   
   VkExtent3D DxvkMetaMipGenRenderPass::passExtent(uint32_t passId) const {
-    VkExtent3D extent = m_view->mipLevelExtent(passId + 1);
+    VkExtent3D extent = m_image->mipLevelExtent(m_viewInfo.minLevel + passId + 1);
     
-    if (m_view->imageInfo().type != VK_IMAGE_TYPE_3D)
-      extent.depth = m_view->info().numLayers;
+    if (m_image->info().type != VK_IMAGE_TYPE_3D)
+      extent.depth = m_viewInfo.numLayers;
     
     return extent;
   }
   
   
+  VkImageViewType DxvkMetaMipGenRenderPass::getSrcViewType(VkImageType type) {
+    switch (type) {
+      case VK_IMAGE_TYPE_1D: return VK_IMAGE_VIEW_TYPE_1D_ARRAY;
+      case VK_IMAGE_TYPE_2D: return VK_IMAGE_VIEW_TYPE_2D_ARRAY;
+      case VK_IMAGE_TYPE_3D: return VK_IMAGE_VIEW_TYPE_3D;
+      default: throw DxvkError(str::format("DxvkMetaMipGenRenderPass: Invalid image type: ", type));
+    }
+  }
+  
+  
   VkRenderPass DxvkMetaMipGenRenderPass::createRenderPass() const {
     std::array<VkSubpassDependency, 2> subpassDeps = {{
       { VK_SUBPASS_EXTERNAL, 0,
-        m_view->imageInfo().stages,
+        m_image->info().stages,
         VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,
         0, VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT, 0 },
       { 0, VK_SUBPASS_EXTERNAL,
         VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,
-        m_view->imageInfo().stages,
+        m_image->info().stages,
         VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT,
-        m_view->imageInfo().access, 0 },
+        m_image->info().access, 0 },
     }};
     
     VkAttachmentDescription attachment;
     attachment.flags            = 0;
-    attachment.format           = m_view->info().format;
+    attachment.format           = m_viewInfo.format;
     attachment.samples          = VK_SAMPLE_COUNT_1_BIT;
     attachment.loadOp           = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
     attachment.storeOp          = VK_ATTACHMENT_STORE_OP_STORE;
     attachment.stencilLoadOp    = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
     attachment.stencilStoreOp   = VK_ATTACHMENT_STORE_OP_DONT_CARE;
     attachment.initialLayout    = VK_IMAGE_LAYOUT_UNDEFINED;
-    attachment.finalLayout      = m_view->imageInfo().layout;
+    attachment.finalLayout      = m_image->info().layout;
     
     VkAttachmentReference attachmentRef;
     attachmentRef.attachment    = 0;
@@ -110,13 +132,20 @@ namespace dxvk {
     result.renderPass   = m_renderPass;
     result.framebuffer  = VK_NULL_HANDLE;
     
+    // Restrict view usage, since the image may
+    // have usage flags not supported by the format
+    VkImageViewUsageCreateInfoKHR viewUsage;
+    viewUsage.sType     = VK_STRUCTURE_TYPE_IMAGE_VIEW_USAGE_CREATE_INFO_KHR;
+    viewUsage.pNext     = nullptr;
+    viewUsage.usage     = VK_IMAGE_USAGE_SAMPLED_BIT;
+    
     // Common image view info
     VkImageViewCreateInfo viewInfo;
     viewInfo.sType      = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
-    viewInfo.pNext      = nullptr;
+    viewInfo.pNext      = &viewUsage;
     viewInfo.flags      = 0;
-    viewInfo.image      = m_view->imageHandle();
-    viewInfo.format     = m_view->info().format;
+    viewInfo.image      = m_image->handle();
+    viewInfo.format     = m_viewInfo.format;
     viewInfo.components = {
       VK_COMPONENT_SWIZZLE_IDENTITY, VK_COMPONENT_SWIZZLE_IDENTITY,
       VK_COMPONENT_SWIZZLE_IDENTITY, VK_COMPONENT_SWIZZLE_IDENTITY };
@@ -125,10 +154,10 @@ namespace dxvk {
     // the one mip level we're going to sample.
     VkImageSubresourceRange srcSubresources;
     srcSubresources.aspectMask     = VK_IMAGE_ASPECT_COLOR_BIT;
-    srcSubresources.baseMipLevel   = m_view->info().minLevel + pass;
+    srcSubresources.baseMipLevel   = m_viewInfo.minLevel + pass;
     srcSubresources.levelCount     = 1;
-    srcSubresources.baseArrayLayer = m_view->info().minLayer;
-    srcSubresources.layerCount     = m_view->info().numLayers;
+    srcSubresources.baseArrayLayer = m_viewInfo.minLayer;
+    srcSubresources.layerCount     = m_viewInfo.numLayers;
     
     viewInfo.viewType         = m_srcViewType;
     viewInfo.subresourceRange = srcSubresources;
@@ -138,21 +167,22 @@ namespace dxvk {
     
     // Create destination image view, which points
     // to the mip level we're going to render to.
-    VkExtent3D dstExtent = m_view->mipLevelExtent(pass + 1);
+    VkExtent3D dstExtent = m_image->mipLevelExtent(m_viewInfo.minLevel + pass + 1);
     
     VkImageSubresourceRange dstSubresources;
     dstSubresources.aspectMask     = VK_IMAGE_ASPECT_COLOR_BIT;
-    dstSubresources.baseMipLevel   = m_view->info().minLevel + pass + 1;
+    dstSubresources.baseMipLevel   = m_viewInfo.minLevel + pass + 1;
     dstSubresources.levelCount     = 1;
     
-    if (m_view->imageInfo().type != VK_IMAGE_TYPE_3D) {
-      dstSubresources.baseArrayLayer = m_view->info().minLayer;
-      dstSubresources.layerCount     = m_view->info().numLayers;
+    if (m_image->info().type != VK_IMAGE_TYPE_3D) {
+      dstSubresources.baseArrayLayer = m_viewInfo.minLayer;
+      dstSubresources.layerCount     = m_viewInfo.numLayers;
     } else {
       dstSubresources.baseArrayLayer = 0;
       dstSubresources.layerCount     = dstExtent.depth;
     }
     
+    viewUsage.usage           = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT;
     viewInfo.viewType         = m_dstViewType;
     viewInfo.subresourceRange = dstSubresources;
     
@@ -178,4 +208,395 @@ namespace dxvk {
     return result;
   }
   
+  
+  
+  void DxvkMetaMipGenRenderPass::createDescriptorSets(
+    const DxvkMetaBlitPipeline& pipeline,
+          VkSampler             sampler) {
+    if (m_passes.empty())
+      return;
+    
+    VkDescriptorPoolSize poolSize;
+    poolSize.type             = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+    poolSize.descriptorCount  = m_passes.size();
+    
+    VkDescriptorPoolCreateInfo poolInfo;
+    poolInfo.sType            = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+    poolInfo.pNext            = nullptr;
+    poolInfo.flags            = 0;
+    poolInfo.maxSets          = m_passes.size();
+    poolInfo.poolSizeCount    = 1;
+    poolInfo.pPoolSizes       = &poolSize;
+    
+    if (m_vkd->vkCreateDescriptorPool(m_vkd->device(), &poolInfo, nullptr, &m_descriptorPool) != VK_SUCCESS)
+      throw DxvkError("DxvkMetaMipGenRenderPass: Failed to create descriptor pool");
+    
+    std::vector<VkDescriptorSetLayout> setLayouts(m_passes.size(), pipeline.dsetLayout);
+    m_descriptorSets.resize(m_passes.size());
+    
+    VkDescriptorSetAllocateInfo allocInfo;
+    allocInfo.sType              = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+    allocInfo.pNext              = nullptr;
+    allocInfo.descriptorPool     = m_descriptorPool;
+    allocInfo.descriptorSetCount = setLayouts.size();
+    allocInfo.pSetLayouts        = setLayouts.data();
+    
+    if (m_vkd->vkAllocateDescriptorSets(m_vkd->device(), &allocInfo, m_descriptorSets.data()) != VK_SUCCESS)
+      throw DxvkError("DxvkMetaMipGenRenderPass: Failed to allocate descriptor sets");
+    
+    std::vector<VkDescriptorImageInfo> descriptorImages(m_passes.size());
+    std::vector<VkWriteDescriptorSet>  descriptorWrites(m_passes.size());
+    
+    for (uint32_t i = 0; i < m_passes.size(); i++) {
+      descriptorImages[i].sampler     = sampler;
+      descriptorImages[i].imageView   = m_passes[i].srcView;
+      descriptorImages[i].imageLayout = m_image->info().layout;
+      
+      descriptorWrites[i].sType            = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+      descriptorWrites[i].pNext            = nullptr;
+      descriptorWrites[i].dstSet           = m_descriptorSets[i];
+      descriptorWrites[i].dstBinding       = 0;
+      descriptorWrites[i].dstArrayElement  = 0;
+      descriptorWrites[i].descriptorCount  = 1;
+      descriptorWrites[i].descriptorType   = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+      descriptorWrites[i].pImageInfo       = &descriptorImages[i];
+      descriptorWrites[i].pBufferInfo      = nullptr;
+      descriptorWrites[i].pTexelBufferView = nullptr;
+    }
+    
+    m_vkd->vkUpdateDescriptorSets(m_vkd->device(),
+      descriptorWrites.size(), descriptorWrites.data(), 0, nullptr);
+  }
+  
+  
+  DxvkMetaMipGenComputePass::DxvkMetaMipGenComputePass(
+    const Rc<vk::DeviceFn>&       vkd,
+    const Rc<DxvkImageView>&      view,
+    const DxvkMetaMipGenPipeline& pipeline)
+  : m_vkd(vkd), m_image(view->image()), m_viewInfo(view->info()) {
+    // Split the mip chain into dispatches, each of
+    // which generates as many levels as possible
+    std::vector<std::pair<uint32_t, uint32_t>> ranges;
+    
+    for (uint32_t level = 0; level + 1 < m_viewInfo.numLevels; ) {
+      uint32_t levelCount = getLevelCount(level);
+      ranges.push_back({ level, levelCount });
+      level += levelCount;
+    }
+    
+    if (ranges.empty())
+      return;
+    
+    m_descriptorPool = createDescriptorPool(ranges.size());
+    
+    std::vector<VkDescriptorSetLayout> setLayouts(ranges.size(), pipeline.dsetLayout);
+    std::vector<VkDescriptorSet>       sets(ranges.size());
+    
+    VkDescriptorSetAllocateInfo allocInfo;
+    allocInfo.sType              = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+    allocInfo.pNext              = nullptr;
+    allocInfo.descriptorPool     = m_descriptorPool;
+    allocInfo.descriptorSetCount = setLayouts.size();
+    allocInfo.pSetLayouts        = setLayouts.data();
+    
+    if (m_vkd->vkAllocateDescriptorSets(m_vkd->device(), &allocInfo, sets.data()) != VK_SUCCESS)
+      throw DxvkError("DxvkMetaMipGenComputePass: Failed to allocate descriptor sets");
+    
+    for (uint32_t i = 0; i < ranges.size(); i++) {
+      uint32_t srcLevel   = ranges[i].first;
+      uint32_t levelCount = ranges[i].second;
+      
+      // The shader statically uses all destination bindings,
+      // so fill unused ones with the last valid view
+      std::array<VkDescriptorImageInfo, MaxLevelsPerDispatch + 1> descriptorImages;
+      
+      for (uint32_t j = 0; j <= MaxLevelsPerDispatch; j++) {
+        bool isSrc = j == 0;
+        
+        descriptorImages[j].sampler     = VK_NULL_HANDLE;
+        descriptorImages[j].imageView   = j <= levelCount
+          ? createView(srcLevel + j, isSrc ? VK_IMAGE_USAGE_SAMPLED_BIT : VK_IMAGE_USAGE_STORAGE_BIT)
+          : descriptorImages[j - 1].imageView;
+        descriptorImages[j].imageLayout = VK_IMAGE_LAYOUT_GENERAL;
+      }
+      
+      std::array<VkWriteDescriptorSet, 2> descriptorWrites;
+      
+      for (uint32_t j = 0; j < descriptorWrites.size(); j++) {
+        descriptorWrites[j].sType            = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+        descriptorWrites[j].pNext            = nullptr;
+        descriptorWrites[j].dstSet           = sets[i];
+        descriptorWrites[j].dstBinding       = j;
+        descriptorWrites[j].dstArrayElement  = 0;
+        descriptorWrites[j].descriptorCount  = j ? MaxLevelsPerDispatch : 1;
+        descriptorWrites[j].descriptorType   = j
+          ? VK_DESCRIPTOR_TYPE_STORAGE_IMAGE
+          : VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+        descriptorWrites[j].pImageInfo       = &descriptorImages[j];
+        descriptorWrites[j].pBufferInfo      = nullptr;
+        descriptorWrites[j].pTexelBufferView = nullptr;
+      }
+      
+      m_vkd->vkUpdateDescriptorSets(m_vkd->device(),
+        descriptorWrites.size(), descriptorWrites.data(), 0, nullptr);
+      
+      VkExtent3D dstExtent = m_image->mipLevelExtent(m_viewInfo.minLevel + srcLevel + 1);
+      dstExtent.depth = m_viewInfo.numLayers;
+      
+      DxvkMetaMipGenDispatch dispatch;
+      dispatch.descriptorSet    = sets[i];
+      dispatch.args.dstExtent   = { dstExtent.width, dstExtent.height };
+      dispatch.args.levelCount  = levelCount;
+      dispatch.workgroups       = util::computeBlockCount(dstExtent, pipeline.workgroupSize);
+      m_dispatches.push_back(dispatch);
+    }
+  }
+  
+  
+  DxvkMetaMipGenComputePass::~DxvkMetaMipGenComputePass() {
+    m_vkd->vkDestroyDescriptorPool(m_vkd->device(), m_descriptorPool, nullptr);
+    
+    for (VkImageView view : m_views)
+      m_vkd->vkDestroyImageView(m_vkd->device(), view, nullptr);
+  }
+  
+  
+  uint32_t DxvkMetaMipGenComputePass::getLevelCount(
+          uint32_t              srcLevel) const {
+    uint32_t maxCount = std::min(MaxLevelsPerDispatch,
+      m_viewInfo.numLevels - srcLevel - 1);
+    
+    // Levels after the first one can only be computed in shared
+    // memory if the previous level has even dimensions, since
+    // the box filter would not match linear filtering otherwise
+    uint32_t count = 1;
+    
+    while (count < maxCount) {
+      VkExtent3D extent = m_image->mipLevelExtent(m_viewInfo.minLevel + srcLevel + count);
+      
+      if ((extent.width  > 1 && (extent.width  & 1))
+       || (extent.height > 1 && (extent.height & 1)))
+        break;
+      
+      count += 1;
+    }
+    
+    return count;
+  }
+  
+  
+  VkImageView DxvkMetaMipGenComputePass::createView(
+          uint32_t              level,
+          VkImageUsageFlags     usage) {
+    VkImageViewUsageCreateInfoKHR viewUsage;
+    viewUsage.sType     = VK_STRUCTURE_TYPE_IMAGE_VIEW_USAGE_CREATE_INFO_KHR;
+    viewUsage.pNext     = nullptr;
+    viewUsage.usage     = usage;
+    
+    VkImageViewCreateInfo viewInfo;
+    viewInfo.sType      = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+    viewInfo.pNext      = &viewUsage;
+    viewInfo.flags      = 0;
+    viewInfo.image      = m_image->handle();
+    viewInfo.viewType   = VK_IMAGE_VIEW_TYPE_2D_ARRAY;
+    viewInfo.format     = m_viewInfo.format;
+    viewInfo.components = {
+      VK_COMPONENT_SWIZZLE_IDENTITY, VK_COMPONENT_SWIZZLE_IDENTITY,
+      VK_COMPONENT_SWIZZLE_IDENTITY, VK_COMPONENT_SWIZZLE_IDENTITY };
+    viewInfo.subresourceRange.aspectMask     = VK_IMAGE_ASPECT_COLOR_BIT;
+    viewInfo.subresourceRange.baseMipLevel   = m_viewInfo.minLevel + level;
+    viewInfo.subresourceRange.levelCount     = 1;
+    viewInfo.subresourceRange.baseArrayLayer = m_viewInfo.minLayer;
+    viewInfo.subresourceRange.layerCount     = m_viewInfo.numLayers;
+    
+    VkImageView result = VK_NULL_HANDLE;
+    if (m_vkd->vkCreateImageView(m_vkd->device(), &viewInfo, nullptr, &result) != VK_SUCCESS)
+      throw DxvkError("DxvkMetaMipGenComputePass: Failed to create image view");
+    
+    m_views.push_back(result);
+    return result;
+  }
+  
+  
+  VkDescriptorPool DxvkMetaMipGenComputePass::createDescriptorPool(
+          uint32_t              dispatchCount) const {
+    std::array<VkDescriptorPoolSize, 2> poolSizes = {{
+      { VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, dispatchCount },
+      { VK_DESCRIPTOR_TYPE_STORAGE_IMAGE,          dispatchCount * MaxLevelsPerDispatch },
+    }};
+    
+    VkDescriptorPoolCreateInfo poolInfo;
+    poolInfo.sType            = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+    poolInfo.pNext            = nullptr;
+    poolInfo.flags            = 0;
+    poolInfo.maxSets          = dispatchCount;
+    poolInfo.poolSizeCount    = poolSizes.size();
+    poolInfo.pPoolSizes       = poolSizes.data();
+    
+    VkDescriptorPool result = VK_NULL_HANDLE;
+    if (m_vkd->vkCreateDescriptorPool(m_vkd->device(), &poolInfo, nullptr, &result) != VK_SUCCESS)
+      throw DxvkError("DxvkMetaMipGenComputePass: Failed to create descriptor pool");
+    return result;
+  }
+  
+  
+  DxvkMetaMipGenObjects::DxvkMetaMipGenObjects(const DxvkDevice* device)
+  : m_device  (device),
+    m_vkd     (device->vkd()),
+    m_sampler (createSampler()) {
+    m_pipeline.dsetLayout    = createDescriptorSetLayout();
+    m_pipeline.pipeLayout    = createPipelineLayout(m_pipeline.dsetLayout);
+    m_pipeline.pipeHandle    = createPipeline(m_pipeline.pipeLayout);
+    m_pipeline.workgroupSize = VkExtent3D { 8, 8, 1 };
+  }
+  
+  
+  DxvkMetaMipGenObjects::~DxvkMetaMipGenObjects() {
+    m_vkd->vkDestroyPipeline(m_vkd->device(), m_pipeline.pipeHandle, nullptr);
+    m_vkd->vkDestroyPipelineLayout(m_vkd->device(), m_pipeline.pipeLayout, nullptr);
+    m_vkd->vkDestroyDescriptorSetLayout(m_vkd->device(), m_pipeline.dsetLayout, nullptr);
+    m_vkd->vkDestroySampler(m_vkd->device(), m_sampler, nullptr);
+  }
+  
+  
+  bool DxvkMetaMipGenObjects::checkViewSupport(
+    const Rc<DxvkImageView>&  view) const {
+    const DxvkImageCreateInfo& imageInfo = view->imageInfo();
+    
+    if (imageInfo.type        != VK_IMAGE_TYPE_2D
+     || imageInfo.sampleCount != VK_SAMPLE_COUNT_1_BIT
+     || view->info().aspect   != VK_IMAGE_ASPECT_COLOR_BIT
+     || !(imageInfo.usage & VK_IMAGE_USAGE_STORAGE_BIT))
+      return false;
+    
+    VkFormatProperties formatProps = m_device->adapter()->formatProperties(view->info().format);
+    
+    VkFormatFeatureFlags features = imageInfo.tiling == VK_IMAGE_TILING_OPTIMAL
+      ? formatProps.optimalTilingFeatures
+      : formatProps.linearTilingFeatures;
+    
+    VkFormatFeatureFlags required = VK_FORMAT_FEATURE_STORAGE_IMAGE_BIT
+                                  | VK_FORMAT_FEATURE_SAMPLED_IMAGE_FILTER_LINEAR_BIT;
+    
+    return (features & required) == required;
+  }
+  
+  
+  VkSampler DxvkMetaMipGenObjects::createSampler() const {
+    VkSamplerCreateInfo info;
+    info.sType                  = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO;
+    info.pNext                  = nullptr;
+    info.flags                  = 0;
+    info.magFilter              = VK_FILTER_LINEAR;
+    info.minFilter              = VK_FILTER_LINEAR;
+    info.mipmapMode             = VK_SAMPLER_MIPMAP_MODE_NEAREST;
+    info.addressModeU           = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+    info.addressModeV           = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+    info.addressModeW           = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+    info.mipLodBias             = 0.0f;
+    info.anisotropyEnable       = VK_FALSE;
+    info.maxAnisotropy          = 1.0f;
+    info.compareEnable          = VK_FALSE;
+    info.compareOp              = VK_COMPARE_OP_ALWAYS;
+    info.minLod                 = 0.0f;
+    info.maxLod                 = 0.0f;
+    info.borderColor            = VK_BORDER_COLOR_FLOAT_TRANSPARENT_BLACK;
+    info.unnormalizedCoordinates = VK_FALSE;
+    
+    VkSampler result = VK_NULL_HANDLE;
+    if (m_vkd->vkCreateSampler(m_vkd->device(), &info, nullptr, &result) != VK_SUCCESS)
+      throw DxvkError("DxvkMetaMipGenObjects: Failed to create sampler");
+    return result;
+  }
+  
+  
+  VkDescriptorSetLayout DxvkMetaMipGenObjects::createDescriptorSetLayout() const {
+    std::array<VkDescriptorSetLayoutBinding, 2> bindings = {{
+      { 0, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 1, VK_SHADER_STAGE_COMPUTE_BIT, &m_sampler },
+      { 1, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, DxvkMetaMipGenComputePass::MaxLevelsPerDispatch, VK_SHADER_STAGE_COMPUTE_BIT, nullptr },
+    }};
+    
+    VkDescriptorSetLayoutCreateInfo dsetInfo;
+    dsetInfo.sType        = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+    dsetInfo.pNext        = nullptr;
+    dsetInfo.flags        = 0;
+    dsetInfo.bindingCount = bindings.size();
+    dsetInfo.pBindings    = bindings.data();
+    
+    VkDescriptorSetLayout result = VK_NULL_HANDLE;
+    if (m_vkd->vkCreateDescriptorSetLayout(m_vkd->device(), &dsetInfo, nullptr, &result) != VK_SUCCESS)
+      throw DxvkError("DxvkMetaMipGenObjects: Failed to create descriptor set layout");
+    return result;
+  }
+  
+  
+  VkPipelineLayout DxvkMetaMipGenObjects::createPipelineLayout(
+          VkDescriptorSetLayout dsetLayout) const {
+    VkPushConstantRange push;
+    push.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+    push.offset     = 0;
+    push.size       = sizeof(DxvkMetaMipGenArgs);
+    
+    VkPipelineLayoutCreateInfo layoutInfo;
+    layoutInfo.sType                  = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+    layoutInfo.pNext                  = nullptr;
+    layoutInfo.flags                  = 0;
+    layoutInfo.setLayoutCount         = 1;
+    layoutInfo.pSetLayouts            = &dsetLayout;
+    layoutInfo.pushConstantRangeCount = 1;
+    layoutInfo.pPushConstantRanges    = &push;
+    
+    VkPipelineLayout result = VK_NULL_HANDLE;
+    if (m_vkd->vkCreatePipelineLayout(m_vkd->device(), &layoutInfo, nullptr, &result) != VK_SUCCESS)
+      throw DxvkError("DxvkMetaMipGenObjects: Failed to create pipeline layout");
+    return result;
+  }
+  
+  
+  VkPipeline DxvkMetaMipGenObjects::createPipeline(
+          VkPipelineLayout      pipeLayout) const {
+    SpirvCodeBuffer code(dxvk_mipgen_2d);
+    
+    VkShaderModuleCreateInfo shaderInfo;
+    shaderInfo.sType    = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
+    shaderInfo.pNext    = nullptr;
+    shaderInfo.flags    = 0;
+    shaderInfo.codeSize = code.size();
+    shaderInfo.pCode    = code.data();
+    
+    VkShaderModule module = VK_NULL_HANDLE;
+    
+    if (m_vkd->vkCreateShaderModule(m_vkd->device(), &shaderInfo, nullptr, &module) != VK_SUCCESS)
+      throw DxvkError("DxvkMetaMipGenObjects: Failed to create shader module");
+    
+    VkPipelineShaderStageCreateInfo stageInfo;
+    stageInfo.sType     = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+    stageInfo.pNext     = nullptr;
+    stageInfo.flags     = 0;
+    stageInfo.stage     = VK_SHADER_STAGE_COMPUTE_BIT;
+    stageInfo.module    = module;
+    stageInfo.pName     = "main";
+    stageInfo.pSpecializationInfo = nullptr;
+    
+    VkComputePipelineCreateInfo pipeInfo;
+    pipeInfo.sType      = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
+    pipeInfo.pNext      = nullptr;
+    pipeInfo.flags      = 0;
+    pipeInfo.stage      = stageInfo;
+    pipeInfo.layout     = pipeLayout;
+    pipeInfo.basePipelineHandle = VK_NULL_HANDLE;
+    pipeInfo.basePipelineIndex  = -1;
+    
+    VkPipeline result = VK_NULL_HANDLE;
+    
+    VkResult status = m_vkd->vkCreateComputePipelines(
+      m_vkd->device(), VK_NULL_HANDLE, 1, &pipeInfo, nullptr, &result);
+    
+    m_vkd->vkDestroyShaderModule(m_vkd->device(), module, nullptr);
+    
+    if (status != VK_SUCCESS)
+      throw DxvkError("DxvkMetaMipGenObjects: Failed to create pipeline");
+    return result;
+  }
+  
 }
@@ -5,21 +5,27 @@
 #include "dxvk_meta_blit.h"
 
 namespace dxvk {
+
+  class DxvkDevice;
   
   /**
    * \brief Mip map generation render pass
    * 
-   * Stores image views, framebuffer objects and
-   * a render pass object for mip map generation.
-   * This must be created per image view.
+   * Stores image views, framebuffer objects,
+   * descriptor sets and a render pass object
+   * for mip map generation. This must be created
+   * per image view, and can be reused for as long
+   * as the image view is alive.
    */
   class DxvkMetaMipGenRenderPass : public DxvkResource {
     
   public:
     
     DxvkMetaMipGenRenderPass(
-      const Rc<vk::DeviceFn>&   vkd,
-      const Rc<DxvkImageView>&  view);
+      const Rc<vk::DeviceFn>&     vkd,
+      const Rc<DxvkImageView>&    view,
+      const DxvkMetaBlitPipeline& pipeline,
+            VkSampler             sampler);
     
     ~DxvkMetaMipGenRenderPass();
     
@@ -64,6 +70,18 @@ namespace dxvk {
       return m_passes.at(passId);
     }
     
+    /**
+     * \brief Descriptor set for a given pass
+     * 
+     * The descriptor set binds the source image
+     * view of the given pass and never changes.
+     * \param [in] pass Render pass index
+     * \returns Descriptor set handle
+     */
+    VkDescriptorSet descriptorSet(uint32_t passId) const {
+      return m_descriptorSets.at(passId);
+    }
+    
     /**
      * \brief Framebuffer size for a given pass
      * 
@@ -72,22 +90,199 @@ namespace dxvk {
      */
     VkExtent3D passExtent(uint32_t passId) const;
     
+    /**
+     * \brief Source image view type for an image type
+     * 
+     * \param [in] type Image type
+     * \returns Source image view type
+     */
+    static VkImageViewType getSrcViewType(VkImageType type);
+    
   private:
     
     Rc<vk::DeviceFn>  m_vkd;
-    Rc<DxvkImageView> m_view;
+    Rc<DxvkImage>     m_image;
+    
+    DxvkImageViewCreateInfo m_viewInfo;
     
     VkRenderPass m_renderPass;
     
     VkImageViewType m_srcViewType;
     VkImageViewType m_dstViewType;
     
+    VkDescriptorPool m_descriptorPool = VK_NULL_HANDLE;
+    
     std::vector<DxvkMetaBlitPass> m_passes;
+    std::vector<VkDescriptorSet>  m_descriptorSets;
     
     VkRenderPass createRenderPass() const;
     
     DxvkMetaBlitPass createFramebuffer(uint32_t pass) const;
     
+    void createDescriptorSets(
+      const DxvkMetaBlitPipeline& pipeline,
+            VkSampler             sampler);
+    
   };
-  
+
+
+  /**
+   * \brief Mip map generation arguments
+   *
+   * Passed in as push constants
+   * to the compute shader.
+   */
+  struct DxvkMetaMipGenArgs {
+    VkExtent2D dstExtent;
+    uint32_t   levelCount;
+  };
+
+
+  /**
+   * \brief Mip map generation pipeline
+   */
+  struct DxvkMetaMipGenPipeline {
+    VkDescriptorSetLayout dsetLayout;
+    VkPipelineLayout      pipeLayout;
+    VkPipeline            pipeHandle;
+    VkExtent3D            workgroupSize;
+  };
+
+
+  /**
+   * \brief Mip map generation dispatch
+   *
+   * Stores the arguments and descriptor set for
+   * a single dispatch, which generates up to
+   * \c MaxLevelsPerDispatch mip levels at once.
+   */
+  struct DxvkMetaMipGenDispatch {
+    VkDescriptorSet    descriptorSet;
+    DxvkMetaMipGenArgs args;
+    VkExtent3D         workgroups;
+  };
+
+
+  /**
+   * \brief Compute-based mip map generation objects
+   *
+   * Stores image views and descriptor sets for mip
+   * map generation using the downsampling compute
+   * shader. Each dispatch generates a chain of up
+   * to four mip levels, using shared memory for
+   * all but the first one. This must be created
+   * per image view, and can be reused for as long
+   * as the image view is alive.
+   */
+  class DxvkMetaMipGenComputePass : public DxvkResource {
+
+  public:
+
+    constexpr static uint32_t MaxLevelsPerDispatch = 4;
+
+    DxvkMetaMipGenComputePass(
+      const Rc<vk::DeviceFn>&       vkd,
+      const Rc<DxvkImageView>&      view,
+      const DxvkMetaMipGenPipeline& pipeline);
+
+    ~DxvkMetaMipGenComputePass();
+
+    /**
+     * \brief Dispatch count
+     * \returns Number of dispatches
+     */
+    uint32_t dispatchCount() const {
+      return m_dispatches.size();
+    }
+
+    /**
+     * \brief Dispatch info
+     *
+     * \param [in] dispatchId Dispatch index
+     * \returns Arguments for the given dispatch
+     */
+    const DxvkMetaMipGenDispatch& dispatch(uint32_t dispatchId) const {
+      return m_dispatches.at(dispatchId);
+    }
+
+  private:
+
+    Rc<vk::DeviceFn>  m_vkd;
+    Rc<DxvkImage>     m_image;
+
+    DxvkImageViewCreateInfo m_viewInfo;
+
+    VkDescriptorPool m_descriptorPool = VK_NULL_HANDLE;
+
+    std::vector<VkImageView>            m_views;
+    std::vector<DxvkMetaMipGenDispatch> m_dispatches;
+
+    uint32_t getLevelCount(
+            uint32_t              srcLevel) const;
+
+    VkImageView createView(
+            uint32_t              level,
+            VkImageUsageFlags     usage);
+
+    VkDescriptorPool createDescriptorPool(
+            uint32_t              dispatchCount) const;
+
+  };
+
+
+  /**
+   * \brief Mip map generation objects
+   *
+   * Stores the compute pipeline and related
+   * objects used to generate mip maps with
+   * the downsampling compute shader.
+   */
+  class DxvkMetaMipGenObjects {
+
+  public:
+
+    DxvkMetaMipGenObjects(const DxvkDevice* device);
+    ~DxvkMetaMipGenObjects();
+
+    /**
+     * \brief Checks whether an image view is supported
+     *
+     * The compute shader can only be used for single-sampled
+     * 2D color images that support storage image access
+     * with the view format. Other images need to use the
+     * render pass based fallback.
+     * \param [in] view The image view
+     * \returns \c true if the compute shader can be used
+     */
+    bool checkViewSupport(
+      const Rc<DxvkImageView>&  view) const;
+
+    /**
+     * \brief Retrieves mip map generation pipeline
+     * \returns Mip map generation pipeline
+     */
+    DxvkMetaMipGenPipeline getPipeline() const {
+      return m_pipeline;
+    }
+
+  private:
+
+    const DxvkDevice*       m_device;
+    Rc<vk::DeviceFn>        m_vkd;
+
+    VkSampler               m_sampler;
+    DxvkMetaMipGenPipeline  m_pipeline;
+
+    VkSampler createSampler() const;
+
+    VkDescriptorSetLayout createDescriptorSetLayout() const;
+
+    VkPipelineLayout createPipelineLayout(
+            VkDescriptorSetLayout dsetLayout) const;
+
+    VkPipeline createPipeline(
+            VkPipelineLayout      pipeLayout) const;
+
+  };
+
 }
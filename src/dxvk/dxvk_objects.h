@@ -1,5 +1,6 @@
 #pragma once
 
+#include "dxvk_buffer.h"
 #include "dxvk_gpu_event.h"
 #include "dxvk_gpu_query.h"
 #include "dxvk_memory.h"
@@ -11,6 +12,7 @@
 #include "dxvk_meta_resolve.h"
 #include "dxvk_pipemanager.h"
 #include "dxvk_renderpass.h"
+#include "dxvk_sampler.h"
 #include "dxvk_unbound.h"
 
 #include "../util/util_lazy.h"
@@ -28,6 +30,7 @@ namespace dxvk {
       m_pipelineManager (device, &m_renderPassPool),
       m_eventPool       (device),
       m_queryPool       (device),
+      m_samplerPool     (device),
       m_dummyResources  (device) {
 
     }
@@ -52,10 +55,18 @@ namespace dxvk {
       return m_queryPool;
     }
 
+    DxvkSamplerPool& samplerPool() {
+      return m_samplerPool;
+    }
+
     DxvkUnboundResources& dummyResources() {
       return m_dummyResources;
     }
 
+    DxvkBufferTrimList& bufferTrimList() {
+      return m_bufferTrimList;
+    }
+
     DxvkMetaBlitObjects& metaBlit() {
       return m_metaBlit.get(m_device);
     }
@@ -76,6 +87,10 @@ namespace dxvk {
       return m_metaPack.get(m_device);
     }
 
+    DxvkMetaMipGenObjects& metaMipGen() {
+      return m_metaMipGen.get(m_device);
+    }
+
   private:
 
     DxvkDevice*                   m_device;
@@ -87,13 +102,18 @@ namespace dxvk {
     DxvkGpuEventPool              m_eventPool;
     DxvkGpuQueryPool              m_queryPool;
 
+    DxvkSamplerPool               m_samplerPool;
+
     DxvkUnboundResources          m_dummyResources;
 
+    DxvkBufferTrimList            m_bufferTrimList;
+
     Lazy<DxvkMetaBlitObjects>     m_metaBlit;
     Lazy<DxvkMetaClearObjects>    m_metaClear;
     Lazy<DxvkMetaCopyObjects>     m_metaCopy;
     Lazy<DxvkMetaResolveObjects>  m_metaResolve;
     Lazy<DxvkMetaPackObjects>     m_metaPack;
+    Lazy<DxvkMetaMipGenObjects>   m_metaMipGen;
 
   };
 
@@ -4,8 +4,12 @@ namespace dxvk {
 
   DxvkOptions::DxvkOptions(const Config& config) {
     enableStateCache      = config.getOption<bool>    ("dxvk.enableStateCache",       true);
+    enableShaderCache     = config.getOption<bool>    ("dxvk.enableShaderCache",      true);
     enableOpenVR          = config.getOption<bool>    ("dxvk.enableOpenVR",           true);
     numCompilerThreads    = config.getOption<int32_t> ("dxvk.numCompilerThreads",     0);
+    enableAsyncPipelines  = config.getOption<bool>    ("dxvk.enableAsyncPipelines",   false);
+    enableAsyncShaders    = config.getOption<bool>    ("dxvk.enableAsyncShaders",     false);
+    enableSpirvOptimizer  = config.getOption<bool>    ("dxvk.enableSpirvOptimizer",   true);
     useRawSsbo            = config.getOption<Tristate>("dxvk.useRawSsbo",             Tristate::Auto);
     useEarlyDiscard       = config.getOption<Tristate>("dxvk.useEarlyDiscard",        Tristate::Auto);
     hud                   = config.getOption<std::string>("dxvk.hud", "");
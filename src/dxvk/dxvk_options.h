@@ -11,6 +11,9 @@ namespace dxvk {
     /// Enable state cache
     bool enableStateCache;
 
+    /// Enable on-disk cache for translated shaders
+    bool enableShaderCache;
+
     /// Enables OpenVR loading
     bool enableOpenVR;
 
@@ -18,6 +21,17 @@ namespace dxvk {
     /// when using the state cache
     int32_t numCompilerThreads;
 
+    /// Compile missing pipelines on background
+    /// threads and skip draws until they are ready
+    bool enableAsyncPipelines;
+
+    /// Translate shaders on background threads
+    /// instead of during shader creation
+    bool enableAsyncShaders;
+
+    /// Run the SPIR-V optimizer on generated shaders
+    bool enableSpirvOptimizer;
+
     /// Shader-related options
     Tristate useRawSsbo;
     Tristate useEarlyDiscard;
@@ -9,15 +9,60 @@ namespace dxvk {
           DxvkRenderPassPool* passManager)
   : m_device    (device),
     m_cache     (new DxvkPipelineCache(device->vkd())) {
+    // The state cache workers and the async compiler threads share
+    // one budget, so that running both does not oversubscribe the
+    // CPU. Use half the available CPU cores for pipeline compilation.
+    uint32_t numCpuCores = dxvk::thread::hardware_concurrency();
+
+    m_workerSlots = numCpuCores > 8
+      ? numCpuCores * 3 / 4
+      : numCpuCores * 1 / 2;
+
+    if (m_workerSlots <  1) m_workerSlots =  1;
+    if (m_workerSlots > 16) m_workerSlots = 16;
+
+    if (device->config().numCompilerThreads > 0)
+      m_workerSlots = device->config().numCompilerThreads;
+
     std::string useStateCache = env::getEnvVar("DXVK_STATE_CACHE");
     
     if (useStateCache != "0" && device->config().enableStateCache)
       m_stateCache = new DxvkStateCache(device, this, passManager);
+
+    std::string useShaderCache = env::getEnvVar("DXVK_SHADER_CACHE");
+
+    if (useShaderCache != "0" && device->config().enableShaderCache)
+      m_shaderCache = new DxvkShaderCache();
+
+    if (device->config().enableAsyncPipelines) {
+      uint32_t numWorkers = std::min(m_workerSlots,
+        std::max(1u, numCpuCores / 4));
+
+      if (device->config().numCompilerThreads > 0)
+        numWorkers = m_workerSlots;
+
+      Logger::info(str::format("DXVK: Using ", numWorkers, " async pipeline compiler threads"));
+
+      for (uint32_t i = 0; i < numWorkers; i++) {
+        m_asyncThreads.emplace_back([this] () { asyncFunc(); });
+        m_asyncThreads[i].set_priority(ThreadPriority::Lowest);
+      }
+    }
   }
   
   
   DxvkPipelineManager::~DxvkPipelineManager() {
-    
+    // State cache workers may be waiting for
+    // pipelines that are being compiled async
+    m_stateCache = nullptr;
+
+    { std::lock_guard<std::mutex> lock(m_asyncLock);
+      m_asyncStop.store(true);
+      m_asyncCond.notify_all();
+    }
+
+    for (auto& worker : m_asyncThreads)
+      worker.join();
   }
   
   
@@ -66,17 +111,87 @@ namespace dxvk {
   }
 
 
+  void DxvkPipelineManager::queueGraphicsPipeline(
+          DxvkGraphicsPipeline*           pipeline,
+          DxvkGraphicsPipelineInstance*   instance,
+    const DxvkGraphicsPipelineStateInfo&  state,
+    const DxvkRenderPass*                 renderPass) {
+    std::lock_guard<std::mutex> lock(m_asyncLock);
+    m_asyncQueue.push({ pipeline, instance, state, renderPass });
+    m_asyncCount += 1;
+    m_asyncCond.notify_one();
+  }
+
+
+  void DxvkPipelineManager::acquireWorkerSlot(bool async) {
+    std::unique_lock<std::mutex> lock(m_workerLock);
+
+    if (!async) {
+      m_workerCond.wait(lock, [this] () {
+        return m_workerBusy.load() < m_workerSlots;
+      });
+    }
+
+    m_workerBusy += 1;
+  }
+
+
+  void DxvkPipelineManager::releaseWorkerSlot() {
+    std::lock_guard<std::mutex> lock(m_workerLock);
+    m_workerBusy -= 1;
+    m_workerCond.notify_one();
+  }
+
+
   DxvkPipelineCount DxvkPipelineManager::getPipelineCount() const {
     DxvkPipelineCount result;
     result.numComputePipelines  = m_numComputePipelines.load();
     result.numGraphicsPipelines = m_numGraphicsPipelines.load();
+    result.numQueuedPipelines   = m_asyncCount.load();
+    result.numBusyWorkers       = m_workerBusy.load();
+    result.numWorkerSlots       = m_workerSlots;
     return result;
   }
 
 
   bool DxvkPipelineManager::isCompilingShaders() const {
-    return m_stateCache != nullptr
-        && m_stateCache->isCompilingShaders();
+    return (m_asyncCount.load() != 0)
+        || (m_stateCache != nullptr && m_stateCache->isCompilingShaders());
+  }
+
+
+  void DxvkPipelineManager::asyncFunc() {
+    env::setThreadName("dxvk-async");
+
+    while (!m_asyncStop.load()) {
+      AsyncItem item;
+
+      { std::unique_lock<std::mutex> lock(m_asyncLock);
+
+        m_asyncCond.wait(lock, [this] () {
+          return m_asyncQueue.size()
+              || m_asyncStop.load();
+        });
+
+        if (m_asyncQueue.empty())
+          break;
+
+        item = m_asyncQueue.front();
+        m_asyncQueue.pop();
+      }
+
+      acquireWorkerSlot(true);
+
+      item.pipeline->compileInstance(
+        item.instance, item.state, item.renderPass);
+
+      releaseWorkerSlot();
+
+      if (item.instance->pipeline() && item.instance->markUsed())
+        item.pipeline->writePipelineStateToCache(item.state, item.renderPass->format());
+
+      m_asyncCount -= 1;
+    }
   }
   
 }
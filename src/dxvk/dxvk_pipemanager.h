@@ -1,7 +1,9 @@
 
 #pragma once
 
+#include <condition_variable>
 #include <mutex>
+#include <queue>
 #include <unordered_map>
 
 #include "dxvk_compute.h"
@@ -20,6 +22,9 @@ namespace dxvk {
   struct DxvkPipelineCount {
     uint32_t numGraphicsPipelines;
     uint32_t numComputePipelines;
+    uint32_t numQueuedPipelines;
+    uint32_t numBusyWorkers;
+    uint32_t numWorkerSlots;
   };
   
   
@@ -78,6 +83,59 @@ namespace dxvk {
     void registerShader(
       const Rc<DxvkShader>&         shader);
     
+    /**
+     * \brief Queues a graphics pipeline for compilation
+     * 
+     * Compiles the given pipeline instance on one of
+     * the async compiler threads. Only available if
+     * async pipeline compilation is enabled.
+     * \param [in] pipeline The graphics pipeline
+     * \param [in] instance Pipeline instance to compile
+     * \param [in] state Pipeline state vector
+     * \param [in] renderPass The render pass
+     */
+    void queueGraphicsPipeline(
+            DxvkGraphicsPipeline*           pipeline,
+            DxvkGraphicsPipelineInstance*   instance,
+      const DxvkGraphicsPipelineStateInfo&  state,
+      const DxvkRenderPass*                 renderPass);
+    
+    /**
+     * \brief Number of compiler worker slots
+     * 
+     * Upper bound for the number of pipelines that the
+     * state cache and the async compiler will compile
+     * concurrently. Also used to size the worker pools.
+     * \returns Number of compiler worker slots
+     */
+    uint32_t getWorkerSlotCount() const {
+      return m_workerSlots;
+    }
+
+    /**
+     * \brief Acquires a compiler worker slot
+     * 
+     * State cache workers block until a slot is available.
+     * Async workers take a slot immediately since the draws
+     * that depend on their pipelines are being skipped, and
+     * since state cache workers may wait for their results.
+     * \param [in] async Whether the caller is an async worker
+     */
+    void acquireWorkerSlot(bool async);
+
+    /**
+     * \brief Releases a compiler worker slot
+     */
+    void releaseWorkerSlot();
+    
+    /**
+     * \brief Retrieves shader cache
+     * \returns Shader cache, or \c nullptr if disabled
+     */
+    Rc<DxvkShaderCache> getShaderCache() const {
+      return m_shaderCache;
+    }
+    
     /**
      * \brief Retrieves total pipeline count
      * \returns Number of compute/graphics pipelines
@@ -91,10 +149,18 @@ namespace dxvk {
     bool isCompilingShaders() const;
     
   private:
+
+    struct AsyncItem {
+      DxvkGraphicsPipeline*         pipeline;
+      DxvkGraphicsPipelineInstance* instance;
+      DxvkGraphicsPipelineStateInfo state;
+      const DxvkRenderPass*         renderPass;
+    };
     
     const DxvkDevice*         m_device;
     Rc<DxvkPipelineCache>     m_cache;
     Rc<DxvkStateCache>        m_stateCache;
+    Rc<DxvkShaderCache>       m_shaderCache;
 
     std::atomic<uint32_t>     m_numComputePipelines  = { 0 };
     std::atomic<uint32_t>     m_numGraphicsPipelines = { 0 };
@@ -110,6 +176,20 @@ namespace dxvk {
       DxvkGraphicsPipelineShaders,
       DxvkGraphicsPipeline,
       DxvkHash, DxvkEq> m_graphicsPipelines;
+
+    uint32_t                  m_workerSlots = 0;
+    std::atomic<uint32_t>     m_workerBusy  = { 0 };
+    std::mutex                m_workerLock;
+    std::condition_variable   m_workerCond;
+
+    std::atomic<bool>         m_asyncStop  = { false };
+    std::atomic<uint32_t>     m_asyncCount = { 0 };
+    std::mutex                m_asyncLock;
+    std::condition_variable   m_asyncCond;
+    std::queue<AsyncItem>     m_asyncQueue;
+    std::vector<dxvk::thread> m_asyncThreads;
+
+    void asyncFunc();
     
   };
   
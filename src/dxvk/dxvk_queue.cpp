@@ -177,6 +177,10 @@ namespace dxvk {
 
       m_device->recycleCommandList(entry.submit.cmdList);
 
+      // Slices returned by the command list may have
+      // left some buffer storage unused, so check now
+      m_device->trimBuffers();
+
       lock = std::unique_lock<std::mutex>(m_mutex);
       m_pending -= 1;
 
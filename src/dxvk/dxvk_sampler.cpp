@@ -1,3 +1,4 @@
+#include "dxvk_device.h"
 #include "dxvk_sampler.h"
 
 namespace dxvk {
@@ -69,4 +70,37 @@ namespace dxvk {
     return VK_BORDER_COLOR_FLOAT_TRANSPARENT_BLACK;
   }
   
+  
+
+  DxvkSamplerPool::DxvkSamplerPool(DxvkDevice* device)
+  : m_device(device) {
+
+  }
+
+
+  DxvkSamplerPool::~DxvkSamplerPool() {
+
+  }
+
+
+  Rc<DxvkSampler> DxvkSamplerPool::getSampler(
+    const DxvkSamplerCreateInfo&  info) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    auto entry = m_samplers.find(info);
+
+    if (entry != m_samplers.end())
+      return entry->second;
+
+    Rc<DxvkSampler> sampler = new DxvkSampler(m_device->vkd(), info);
+    m_samplers.insert({ info, sampler });
+    return sampler;
+  }
+
+
+  uint32_t DxvkSamplerPool::getSamplerCount() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return uint32_t(m_samplers.size());
+  }
+
 }
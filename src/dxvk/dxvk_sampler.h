@@ -1,8 +1,14 @@
 #pragma once
 
+#include <mutex>
+#include <unordered_map>
+
+#include "dxvk_hash.h"
 #include "dxvk_resource.h"
 
 namespace dxvk {
+
+  class DxvkDevice;
   
   /**
    * \brief Sampler properties
@@ -36,6 +42,24 @@ namespace dxvk {
     
     /// Enables unnormalized coordinates
     VkBool32 usePixelCoord;
+
+    bool eq(const DxvkSamplerCreateInfo& other) const {
+      // Compare floats bitwise so that NaN values
+      // do not create a new sampler for every lookup
+      return !std::memcmp(this, &other, sizeof(*this));
+    }
+
+    size_t hash() const {
+      std::array<uint32_t, sizeof(*this) / sizeof(uint32_t)> dwords;
+      std::memcpy(dwords.data(), this, sizeof(*this));
+
+      DxvkHashState result;
+
+      for (uint32_t dword : dwords)
+        result.add(dword);
+
+      return result;
+    }
   };
   
   
@@ -72,4 +96,49 @@ namespace dxvk {
     
   };
   
+  
+  /**
+   * \brief Sampler pool
+   * 
+   * Thread-safe cache of sampler objects, so that
+   * samplers with identical properties are shared
+   * among all users of the device rather than being
+   * created again for every state object.
+   */
+  class DxvkSamplerPool {
+
+  public:
+
+    DxvkSamplerPool(DxvkDevice* device);
+    ~DxvkSamplerPool();
+
+    /**
+     * \brief Retrieves a sampler
+     * 
+     * Creates a new sampler if no sampler
+     * with the given properties exists yet.
+     * \param [in] info Sampler properties
+     * \returns The sampler object
+     */
+    Rc<DxvkSampler> getSampler(
+      const DxvkSamplerCreateInfo&  info);
+
+    /**
+     * \brief Number of samplers
+     * \returns Number of samplers created so far
+     */
+    uint32_t getSamplerCount();
+
+  private:
+
+    DxvkDevice*             m_device;
+
+    std::mutex              m_mutex;
+    std::unordered_map<
+      DxvkSamplerCreateInfo,
+      Rc<DxvkSampler>,
+      DxvkHash, DxvkEq>     m_samplers;
+
+  };
+  
 }
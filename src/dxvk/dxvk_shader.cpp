@@ -104,12 +104,32 @@ namespace dxvk {
           SpirvCodeBuffer         code,
     const DxvkShaderOptions&      options,
           DxvkShaderConstData&&   constData)
-  : m_stage(stage), m_code(code), m_interface(iface),
+  : m_stage(stage), m_interface(iface),
     m_options(options), m_constData(std::move(constData)) {
     // Write back resource slot infos
     for (uint32_t i = 0; i < slotCount; i++)
       m_slots.push_back(slotInfos[i]);
     
+    // Run some cheap optimizations on the generated code
+    // once, so that drivers have less work to do whenever
+    // a pipeline is compiled. Needs to happen before we
+    // gather any offsets since those will change.
+    if (!options.disableOptimizer) {
+      SpirvOptimizer optimizer(code);
+      optimizer.run();
+      code = optimizer.getCode();
+
+      SpirvOptimizerStats stats = optimizer.getStats();
+
+      if (stats.dwordsAfter != stats.dwordsBefore) {
+        Logger::debug(str::format("DxvkShader: Optimized SPIR-V from ",
+          stats.dwordsBefore, " to ", stats.dwordsAfter, " dwords, ",
+          stats.instructionsBefore, " to ", stats.instructionsAfter, " instructions"));
+      }
+    }
+
+    m_code = SpirvCompressedBuffer(code);
+    
     // Gather the offsets where the binding IDs
     // are stored so we can quickly remap them.
     uint32_t o1VarId = 0;
@@ -197,6 +217,117 @@ namespace dxvk {
   }
 
 
+  void DxvkShader::serialize(DxvkShaderCacheEntryData& data) const {
+    std::vector<uint32_t> idOffsets(
+      m_idOffsets.begin(), m_idOffsets.end());
+
+    std::vector<uint32_t> constData(
+      m_constData.data(),
+      m_constData.data() + m_constData.sizeInDwords());
+
+    data.write(m_stage);
+    data.write(m_code.dwords());
+    data.write(m_code.mask());
+    data.write(m_code.code());
+    data.write(uint32_t(m_slots.size()));
+
+    for (const auto& slot : m_slots) {
+      data.write(slot.slot);
+      data.write(slot.type);
+      data.write(slot.view);
+      data.write(slot.access);
+    }
+
+    data.write(idOffsets);
+    data.write(m_interface.inputSlots);
+    data.write(m_interface.outputSlots);
+    data.write(m_interface.pushConstOffset);
+    data.write(m_interface.pushConstSize);
+    data.write(m_flags.raw());
+    data.write(m_options.rasterizedStream);
+
+    for (uint32_t i = 0; i < MaxNumXfbBuffers; i++)
+      data.write(m_options.xfbStrides[i]);
+
+    data.write(m_options.disableOptimizer);
+    data.write(constData);
+    data.write(uint32_t(m_o1IdxOffset));
+    data.write(uint32_t(m_o1LocOffset));
+  }
+
+
+  Rc<DxvkShader> DxvkShader::deserialize(DxvkShaderCacheEntryData& data) {
+    Rc<DxvkShader> shader = new DxvkShader();
+
+    uint32_t              codeSize = 0;
+    std::vector<uint64_t> codeMask;
+    std::vector<uint64_t> codeData;
+    uint32_t              slotCount = 0;
+    std::vector<uint32_t> idOffsets;
+    uint32_t              flags = 0;
+    std::vector<uint32_t> constData;
+    uint32_t              o1IdxOffset = 0;
+    uint32_t              o1LocOffset = 0;
+
+    if (!data.read(shader->m_stage)
+     || !data.read(codeSize)
+     || !data.read(codeMask)
+     || !data.read(codeData)
+     || !data.read(slotCount))
+      return nullptr;
+
+    // Each slot takes up at least 16 bytes, this avoids
+    // allocating excessive amounts of memory for bad data
+    if (slotCount > (data.size() - data.readOffset()) / 16)
+      return nullptr;
+
+    shader->m_slots.resize(slotCount);
+
+    for (auto& slot : shader->m_slots) {
+      if (!data.read(slot.slot)
+       || !data.read(slot.type)
+       || !data.read(slot.view)
+       || !data.read(slot.access))
+        return nullptr;
+    }
+
+    if (!data.read(idOffsets)
+     || !data.read(shader->m_interface.inputSlots)
+     || !data.read(shader->m_interface.outputSlots)
+     || !data.read(shader->m_interface.pushConstOffset)
+     || !data.read(shader->m_interface.pushConstSize)
+     || !data.read(flags)
+     || !data.read(shader->m_options.rasterizedStream))
+      return nullptr;
+
+    for (uint32_t i = 0; i < MaxNumXfbBuffers; i++) {
+      if (!data.read(shader->m_options.xfbStrides[i]))
+        return nullptr;
+    }
+
+    if (!data.read(shader->m_options.disableOptimizer)
+     || !data.read(constData)
+     || !data.read(o1IdxOffset)
+     || !data.read(o1LocOffset))
+      return nullptr;
+
+    shader->m_flags = DxvkShaderFlags(flags);
+
+    shader->m_code = SpirvCompressedBuffer(codeSize,
+      std::move(codeMask), std::move(codeData));
+    shader->m_idOffsets.assign(idOffsets.begin(), idOffsets.end());
+    shader->m_o1IdxOffset = o1IdxOffset;
+    shader->m_o1LocOffset = o1LocOffset;
+
+    if (!constData.empty()) {
+      shader->m_constData = DxvkShaderConstData(
+        constData.size(), constData.data());
+    }
+
+    return shader;
+  }
+
+
   void DxvkShader::eliminateInput(SpirvCodeBuffer& code, uint32_t location) {
     struct SpirvTypeInfo {
       spv::Op           op            = spv::OpNop;
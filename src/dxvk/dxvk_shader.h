@@ -5,10 +5,12 @@
 #include "dxvk_include.h"
 #include "dxvk_limits.h"
 #include "dxvk_pipelayout.h"
+#include "dxvk_shader_cache.h"
 #include "dxvk_shader_key.h"
 
 #include "../spirv/spirv_code_buffer.h"
 #include "../spirv/spirv_compression.h"
+#include "../spirv/spirv_optimizer.h"
 
 namespace dxvk {
   
@@ -75,6 +77,8 @@ namespace dxvk {
     int32_t rasterizedStream;
     /// Xfb vertex strides
     uint32_t xfbStrides[MaxNumXfbBuffers];
+    /// Skip the SPIR-V optimizer
+    bool disableOptimizer;
   };
 
 
@@ -105,6 +109,10 @@ namespace dxvk {
       return m_data;
     }
 
+    size_t sizeInDwords() const {
+      return m_size;
+    }
+
     size_t sizeInBytes() const {
       return m_size * sizeof(uint32_t);
     }
@@ -228,6 +236,26 @@ namespace dxvk {
      */
     void dump(std::ostream& outputStream) const;
     
+    /**
+     * \brief Serializes shader
+     * 
+     * Writes the compressed SPIR-V code as well as all
+     * reflection data needed to recreate the shader
+     * object to a shader cache entry. The shader key
+     * is not stored and must be set by the caller.
+     * \param [out] data Shader cache entry data
+     */
+    void serialize(DxvkShaderCacheEntryData& data) const;
+    
+    /**
+     * \brief Deserializes shader
+     * 
+     * \param [in] data Shader cache entry data
+     * \returns Shader object, or \c nullptr if
+     *    the shader cache entry is invalid
+     */
+    static Rc<DxvkShader> deserialize(DxvkShaderCacheEntryData& data);
+    
     /**
      * \brief Sets the shader key
      * \param [in] key Unique key
@@ -294,6 +322,8 @@ namespace dxvk {
     size_t m_o1IdxOffset = 0;
     size_t m_o1LocOffset = 0;
 
+    DxvkShader() { }
+
     static void eliminateInput(SpirvCodeBuffer& code, uint32_t location);
 
   };
@@ -0,0 +1,382 @@
+#include <cstring>
+#include <fstream>
+
+#include <version.h>
+
+#include "dxvk_shader_cache.h"
+
+namespace dxvk {
+
+  /// Serializes file access between all shader cache
+  /// instances in the process, e.g. from multiple devices
+  static std::mutex g_shaderCacheFileMutex;
+
+
+  static DxvkShaderCacheEntryData getCurrentHeader() {
+    DxvkShaderCacheHeader header;
+    std::strncpy(header.dxvkVersion, DXVK_VERSION,
+      sizeof(header.dxvkVersion) - 1);
+
+    DxvkShaderCacheEntryData data;
+    header.write(data);
+    return data;
+  }
+
+
+  bool DxvkShaderCacheKey::eq(const DxvkShaderCacheKey& key) const {
+    return this->shader.eq(key.shader)
+        && this->version == key.version
+        && this->options == key.options;
+  }
+
+
+  size_t DxvkShaderCacheKey::hash() const {
+    DxvkHashState hash;
+    hash.add(this->shader.hash());
+    hash.add(this->version);
+    hash.add(this->options);
+    return hash;
+  }
+
+
+  void DxvkShaderCacheHeader::write(DxvkShaderCacheEntryData& data) const {
+    data.write(magic, sizeof(magic));
+    data.write(version);
+    data.write(dxvkVersion, sizeof(dxvkVersion));
+  }
+
+
+  void DxvkShaderCacheEntryHeader::write(DxvkShaderCacheEntryData& data) const {
+    data.write(uint32_t(key.shader.type()));
+    data.write(key.shader.sha1());
+    data.write(key.version);
+    data.write(key.options);
+    data.write(size);
+    data.write(hash);
+  }
+
+
+  bool DxvkShaderCacheEntryHeader::read(DxvkShaderCacheEntryData& data) {
+    uint32_t stage = 0;
+    Sha1Hash sha1;
+
+    if (!data.read(stage)
+     || !data.read(sha1)
+     || !data.read(key.version)
+     || !data.read(key.options)
+     || !data.read(size)
+     || !data.read(hash))
+      return false;
+
+    key.shader = DxvkShaderKey(VkShaderStageFlagBits(stage), sha1);
+    return true;
+  }
+
+
+  DxvkShaderCache::DxvkShaderCache() {
+    std::lock_guard<std::mutex> lock(g_shaderCacheFileMutex);
+
+    if (!mapCacheFile()) {
+      unmapCacheFile();
+      m_entries.clear();
+
+      Logger::warn("DXVK: Creating new shader cache file");
+
+      // Start with an empty file that only
+      // contains the current header
+      std::ofstream file(getCacheFileName(),
+        std::ios_base::binary |
+        std::ios_base::trunc);
+
+      if (!file && env::createDirectory(getCacheDir())) {
+        file = std::ofstream(getCacheFileName(),
+          std::ios_base::binary |
+          std::ios_base::trunc);
+      }
+
+      DxvkShaderCacheEntryData header = getCurrentHeader();
+      file.write(header.data(), header.size());
+    }
+
+    m_writerThread = dxvk::thread([this] () { writerFunc(); });
+  }
+
+
+  DxvkShaderCache::~DxvkShaderCache() {
+    { std::lock_guard<std::mutex> lock(m_writerLock);
+      m_stopThread = true;
+      m_writerCond.notify_one();
+    }
+
+    m_writerThread.join();
+
+    unmapCacheFile();
+  }
+
+
+  bool DxvkShaderCache::lookup(
+    const DxvkShaderCacheKey&       key,
+          DxvkShaderCacheEntryData& data) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    auto entry = m_entries.find(key);
+
+    // Entries added during this session are only
+    // tracked so that we don't write them twice
+    if (entry == m_entries.end() || !entry->second.data)
+      return false;
+
+    // Verify the checksum the first time an entry is
+    // used rather than hashing the entire file up front
+    if (!entry->second.validated) {
+      Sha1Hash hash = Sha1Hash::compute(
+        entry->second.data, entry->second.size);
+
+      if (hash != entry->second.hash) {
+        Logger::warn(str::format("DXVK: Invalid shader cache entry for ", key.shader.toString()));
+        m_entries.erase(entry);
+        return false;
+      }
+
+      entry->second.validated = true;
+    }
+
+    data = DxvkShaderCacheEntryData(
+      entry->second.data,
+      entry->second.size);
+    return true;
+  }
+
+
+  void DxvkShaderCache::insert(
+    const DxvkShaderCacheKey&       key,
+          DxvkShaderCacheEntryData&& data) {
+    { std::lock_guard<std::mutex> lock(m_mutex);
+
+      Entry entry = { nullptr, 0, Sha1Hash(), false };
+
+      if (!m_entries.insert({ key, entry }).second)
+        return;
+    }
+
+    { std::lock_guard<std::mutex> lock(m_writerLock);
+      m_writerQueue.push({ key, std::move(data) });
+      m_writerCond.notify_one();
+    }
+  }
+
+
+  bool DxvkShaderCache::mapCacheFile() {
+    WCHAR fileName[MAX_PATH];
+    str::tows(getCacheFileName().c_str(), fileName);
+
+    // The writer thread appends to the file while it
+    // is mapped, so we need to allow shared writes
+    m_file = CreateFileW(fileName, GENERIC_READ,
+      FILE_SHARE_READ | FILE_SHARE_WRITE, nullptr,
+      OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+
+    if (m_file == INVALID_HANDLE_VALUE) {
+      Logger::warn("DXVK: No shader cache file found");
+      return false;
+    }
+
+    DxvkShaderCacheEntryData expected = getCurrentHeader();
+
+    LARGE_INTEGER fileSize;
+
+    if (!GetFileSizeEx(m_file, &fileSize)
+     || size_t(fileSize.QuadPart) < expected.size()) {
+      Logger::warn("DXVK: Failed to read shader cache header");
+      return false;
+    }
+
+    m_mapSize = size_t(fileSize.QuadPart);
+    m_mapping = CreateFileMappingW(m_file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+
+    if (m_mapping)
+      m_mapPtr = reinterpret_cast<const char*>(MapViewOfFile(m_mapping, FILE_MAP_READ, 0, 0, 0));
+
+    if (!m_mapPtr) {
+      Logger::warn("DXVK: Failed to map shader cache file");
+      return false;
+    }
+
+    // Translated shaders are only valid for the DXVK
+    // version that created them, discard everything
+    // if the format or version has changed.
+    if (std::memcmp(m_mapPtr, expected.data(), expected.size())) {
+      Logger::warn("DXVK: Shader cache version changed");
+      return false;
+    }
+
+    // Build the lookup table. Later entries replace earlier
+    // ones with the same key, which happens if a corrupted
+    // entry was replaced during a previous run.
+    size_t offset = expected.size();
+
+    while (offset < m_mapSize) {
+      DxvkShaderCacheEntryData data(
+        m_mapPtr + offset, m_mapSize - offset);
+
+      DxvkShaderCacheEntryHeader header;
+
+      if (!header.read(data) || data.readOffset() + header.size > data.size())
+        break;
+
+      Entry entry;
+      entry.data      = m_mapPtr + offset + data.readOffset();
+      entry.size      = header.size;
+      entry.hash      = header.hash;
+      entry.validated = false;
+
+      m_entries[header.key] = entry;
+      offset += data.readOffset() + header.size;
+    }
+
+    // If the application was terminated while writing an entry,
+    // keep all complete entries and cut off the incomplete one
+    // so that new entries get appended at the correct offset.
+    if (offset != m_mapSize) {
+      Logger::warn(str::format("DXVK: Shader cache file truncated, discarding ",
+        m_mapSize - offset, " bytes"));
+
+      unmapCacheFile();
+      m_entries.clear();
+
+      if (!truncateCacheFile(offset)) {
+        Logger::warn("DXVK: Failed to truncate shader cache file");
+        return false;
+      }
+
+      return mapCacheFile();
+    }
+
+    Logger::info(str::format(
+      "DXVK: Read ", m_entries.size(),
+      " shader cache entries"));
+    return true;
+  }
+
+
+  void DxvkShaderCache::unmapCacheFile() {
+    if (m_mapPtr)
+      UnmapViewOfFile(m_mapPtr);
+
+    if (m_mapping)
+      CloseHandle(m_mapping);
+
+    if (m_file != INVALID_HANDLE_VALUE)
+      CloseHandle(m_file);
+
+    m_file    = INVALID_HANDLE_VALUE;
+    m_mapping = nullptr;
+    m_mapPtr  = nullptr;
+    m_mapSize = 0;
+  }
+
+
+  bool DxvkShaderCache::truncateCacheFile(size_t size) {
+    WCHAR fileName[MAX_PATH];
+    str::tows(getCacheFileName().c_str(), fileName);
+
+    HANDLE file = CreateFileW(fileName, GENERIC_WRITE,
+      FILE_SHARE_READ | FILE_SHARE_WRITE, nullptr,
+      OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+
+    if (file == INVALID_HANDLE_VALUE)
+      return false;
+
+    LARGE_INTEGER offset;
+    offset.QuadPart = size;
+
+    bool success = SetFilePointerEx(file, offset, nullptr, FILE_BEGIN)
+                && SetEndOfFile(file);
+
+    CloseHandle(file);
+    return success;
+  }
+
+
+  void DxvkShaderCache::writerFunc() {
+    env::setThreadName("dxvk-shader-writer");
+
+    HANDLE file = INVALID_HANDLE_VALUE;
+
+    while (true) {
+      WriterItem item;
+
+      { std::unique_lock<std::mutex> lock(m_writerLock);
+
+        m_writerCond.wait(lock, [this] () {
+          return m_writerQueue.size()
+              || m_stopThread;
+        });
+
+        if (m_writerQueue.size() == 0)
+          break;
+
+        item = std::move(m_writerQueue.front());
+        m_writerQueue.pop();
+      }
+
+      if (file == INVALID_HANDLE_VALUE) {
+        WCHAR fileName[MAX_PATH];
+        str::tows(getCacheFileName().c_str(), fileName);
+
+        // Append-only access makes every write go to the
+        // current end of the file, even if another handle
+        // has appended data in the meantime
+        file = CreateFileW(fileName, FILE_APPEND_DATA,
+          FILE_SHARE_READ | FILE_SHARE_WRITE, nullptr,
+          OPEN_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+
+        if (file == INVALID_HANDLE_VALUE)
+          continue;
+      }
+
+      DxvkShaderCacheEntryHeader header;
+      header.key  = item.key;
+      header.size = item.data.size();
+      header.hash = item.data.computeHash();
+
+      DxvkShaderCacheEntryData entry;
+      header.write(entry);
+      entry.write(item.data.data(), item.data.size());
+
+      std::lock_guard<std::mutex> lock(g_shaderCacheFileMutex);
+
+      DWORD written = 0;
+
+      if (!WriteFile(file, entry.data(), entry.size(), &written, nullptr)
+       || written != entry.size())
+        Logger::warn("DXVK: Failed to write shader cache entry");
+    }
+
+    if (file != INVALID_HANDLE_VALUE)
+      CloseHandle(file);
+  }
+
+
+  std::string DxvkShaderCache::getCacheFileName() const {
+    std::string path = getCacheDir();
+
+    if (!path.empty() && *path.rbegin() != '/')
+      path += '/';
+    
+    std::string exeName = env::getExeName();
+    auto extp = exeName.find_last_of('.');
+    
+    if (extp != std::string::npos && exeName.substr(extp + 1) == "exe")
+      exeName.erase(extp);
+    
+    path += exeName + ".dxvk-shaders";
+    return path;
+  }
+
+
+  std::string DxvkShaderCache::getCacheDir() const {
+    return env::getEnvVar("DXVK_STATE_CACHE_PATH");
+  }
+
+}
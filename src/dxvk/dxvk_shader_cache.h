@@ -0,0 +1,273 @@
+#pragma once
+
+#include <condition_variable>
+#include <mutex>
+#include <queue>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+
+#include "dxvk_include.h"
+#include "dxvk_shader_key.h"
+
+#include "../util/thread.h"
+
+namespace dxvk {
+
+  /**
+   * \brief Shader cache key
+   *
+   * Identifies a translated shader. In addition
+   * to the shader key, this stores a hash of all
+   * compiler options which affect the generated
+   * SPIR-V code.
+   */
+  struct DxvkShaderCacheKey {
+    DxvkShaderKey shader;
+    uint32_t      version = CurrentVersion;
+    uint64_t      options = 0;
+
+    /// Version of the serialized shader data. Needs to be
+    /// bumped whenever the layout of an entry changes.
+    static constexpr uint32_t CurrentVersion = 2;
+
+    bool eq(const DxvkShaderCacheKey& key) const;
+
+    size_t hash() const;
+  };
+
+
+  /**
+   * \brief Shader cache entry data
+   *
+   * Serialized representation of a translated
+   * shader. Can either own its data when writing
+   * a new entry, or reference data stored in the
+   * memory-mapped cache file when reading.
+   */
+  class DxvkShaderCacheEntryData {
+
+  public:
+
+    DxvkShaderCacheEntryData() { }
+
+    DxvkShaderCacheEntryData(
+      const char*                   data,
+            size_t                  size)
+    : m_view(data), m_size(size) { }
+
+    const char* data() const {
+      return m_view ? m_view : m_data.data();
+    }
+
+    size_t size() const {
+      return m_size;
+    }
+
+    size_t readOffset() const {
+      return m_read;
+    }
+
+    Sha1Hash computeHash() const {
+      return Sha1Hash::compute(data(), size());
+    }
+
+    bool read(void* data, size_t size) {
+      if (m_read + size > m_size)
+        return false;
+
+      std::memcpy(data, this->data() + m_read, size);
+      m_read += size;
+      return true;
+    }
+
+    template<typename T>
+    bool read(T& data) {
+      static_assert(std::is_arithmetic<T>::value || std::is_enum<T>::value,
+        "Structures must be serialized field by field");
+      return read(&data, sizeof(T));
+    }
+
+    template<typename T>
+    bool read(std::vector<T>& data) {
+      static_assert(std::is_arithmetic<T>::value || std::is_enum<T>::value,
+        "Structures must be serialized field by field");
+      uint32_t count = 0;
+
+      if (!read(count) || m_read + count * sizeof(T) > m_size)
+        return false;
+
+      data.resize(count);
+      return read(data.data(), count * sizeof(T));
+    }
+
+    bool read(Sha1Hash& hash) {
+      Sha1Digest digest;
+
+      if (!read(digest.data(), digest.size()))
+        return false;
+
+      hash = Sha1Hash(digest);
+      return true;
+    }
+
+    void write(const void* data, size_t size) {
+      auto bytes = reinterpret_cast<const char*>(data);
+      m_data.insert(m_data.end(), bytes, bytes + size);
+      m_size += size;
+    }
+
+    template<typename T>
+    void write(const T& data) {
+      static_assert(std::is_arithmetic<T>::value || std::is_enum<T>::value,
+        "Structures must be serialized field by field");
+      write(&data, sizeof(T));
+    }
+
+    template<typename T>
+    void write(const std::vector<T>& data) {
+      static_assert(std::is_arithmetic<T>::value || std::is_enum<T>::value,
+        "Structures must be serialized field by field");
+      write(uint32_t(data.size()));
+      write(data.data(), data.size() * sizeof(T));
+    }
+
+    void write(const Sha1Hash& hash) {
+      for (uint32_t i = 0; i < 5; i++)
+        write(hash.dword(i));
+    }
+
+  private:
+
+    const char*       m_view = nullptr;
+    std::vector<char> m_data;
+    size_t            m_size = 0;
+    size_t            m_read = 0;
+
+  };
+
+
+  /**
+   * \brief Shader cache file header
+   *
+   * Stores the cache format version as well as
+   * the DXVK version that generated the file.
+   * Translated code is only valid for the same
+   * version, so mismatching files are discarded.
+   */
+  struct DxvkShaderCacheHeader {
+    char     magic[4]        = { 'D', 'X', 'S', 'C' };
+    uint32_t version         = 2;
+    char     dxvkVersion[32] = { };
+
+    void write(DxvkShaderCacheEntryData& data) const;
+  };
+
+
+  /**
+   * \brief Shader cache entry header
+   *
+   * Precedes the serialized shader data
+   * of each entry in the cache file.
+   */
+  struct DxvkShaderCacheEntryHeader {
+    DxvkShaderCacheKey  key;
+    uint32_t            size;
+    Sha1Hash            hash;
+
+    void write(DxvkShaderCacheEntryData& data) const;
+
+    bool read(DxvkShaderCacheEntryData& data);
+  };
+
+
+  /**
+   * \brief Shader cache
+   *
+   * Persistent cache of translated shaders, stored
+   * next to the state cache file. The file is mapped
+   * into memory on startup, and entries are only
+   * validated once they are looked up. New entries
+   * are appended to the file on a worker thread.
+   *
+   * Multiple devices may use the same file. Each
+   * entry is appended with a single write while
+   * holding a process-wide lock, so that entries
+   * written by different instances never overlap.
+   */
+  class DxvkShaderCache : public RcObject {
+
+  public:
+
+    DxvkShaderCache();
+
+    ~DxvkShaderCache();
+
+    /**
+     * \brief Looks up a translated shader
+     *
+     * \param [in] key Shader cache key
+     * \param [out] data Serialized shader data
+     * \returns \c true if a valid entry was found
+     */
+    bool lookup(
+      const DxvkShaderCacheKey&       key,
+            DxvkShaderCacheEntryData& data);
+
+    /**
+     * \brief Adds a translated shader to the cache
+     *
+     * Does nothing if the shader is already cached.
+     * \param [in] key Shader cache key
+     * \param [in] data Serialized shader data
+     */
+    void insert(
+      const DxvkShaderCacheKey&       key,
+            DxvkShaderCacheEntryData&& data);
+
+  private:
+
+    struct Entry {
+      const char* data;
+      size_t      size;
+      Sha1Hash    hash;
+      bool        validated;
+    };
+
+    struct WriterItem {
+      DxvkShaderCacheKey        key;
+      DxvkShaderCacheEntryData  data;
+    };
+
+    std::mutex                        m_mutex;
+
+    std::unordered_map<
+      DxvkShaderCacheKey, Entry,
+      DxvkHash, DxvkEq>               m_entries;
+
+    HANDLE                            m_file    = INVALID_HANDLE_VALUE;
+    HANDLE                            m_mapping = nullptr;
+    const char*                       m_mapPtr  = nullptr;
+    size_t                            m_mapSize = 0;
+
+    bool                              m_stopThread = false;
+    std::mutex                        m_writerLock;
+    std::condition_variable           m_writerCond;
+    std::queue<WriterItem>            m_writerQueue;
+    dxvk::thread                      m_writerThread;
+
+    bool mapCacheFile();
+
+    void unmapCacheFile();
+
+    bool truncateCacheFile(size_t size);
+
+    void writerFunc();
+
+    std::string getCacheFileName() const;
+
+    std::string getCacheDir() const;
+
+  };
+
+}
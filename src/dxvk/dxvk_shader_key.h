@@ -52,6 +52,12 @@ namespace dxvk {
      */
     VkShaderStageFlags type() const { return m_type; }
 
+    /**
+     * \brief Shader hash
+     * \returns Hash of the original code
+     */
+    Sha1Hash sha1() const { return m_sha1; }
+
     /**
      * \brief Checks whether two keys are equal
      * 
@@ -0,0 +1,198 @@
+#include "../util/util_time.h"
+
+#include "dxvk_device.h"
+#include "dxvk_shader_task.h"
+
+namespace dxvk {
+
+  DxvkShaderTask::~DxvkShaderTask() {
+
+  }
+
+
+  bool DxvkShaderTask::tryRun() {
+    DxvkShaderTaskStatus expected = DxvkShaderTaskStatus::Pending;
+
+    if (!m_status.compare_exchange_strong(expected, DxvkShaderTaskStatus::Running))
+      return false;
+
+    // Written before the status, which
+    // publishes it to other threads
+    m_failed = !this->run();
+
+    { std::lock_guard<std::mutex> lock(m_mutex);
+      m_status.store(DxvkShaderTaskStatus::Done);
+    }
+
+    m_cond.notify_all();
+    return true;
+  }
+
+
+  bool DxvkShaderTask::wait() {
+    if (likely(isDone()))
+      return false;
+
+    // If no worker has picked up the task yet, running it on
+    // the calling thread is faster than waiting for the queue
+    if (!this->tryRun()) {
+      std::unique_lock<std::mutex> lock(m_mutex);
+
+      m_cond.wait(lock, [this] () {
+        return isDone();
+      });
+    }
+
+    return true;
+  }
+
+
+  DxvkShaderTaskQueue::DxvkShaderTaskQueue(const DxvkDevice* device)
+  : m_device(device) {
+
+  }
+
+
+  DxvkShaderTaskQueue::~DxvkShaderTaskQueue() {
+    { std::lock_guard<std::mutex> lock(m_mutex);
+      m_stopped = true;
+      m_cond.notify_all();
+    }
+
+    for (auto& worker : m_workers)
+      worker.join();
+
+    // Tasks that were never started must still be executed
+    // since their owners may not have waited for them yet
+    while (!m_tasks.empty()) {
+      m_tasks.front()->tryRun();
+      m_tasks.pop();
+    }
+
+    uint64_t numWaits = m_waitCount.load();
+
+    if (numWaits) {
+      Logger::info(str::format("DXVK: Waited for ", numWaits,
+        " shader tasks, ", m_waitTicks.load() / 1000, " ms in total"));
+    }
+  }
+
+
+  void DxvkShaderTaskQueue::queueTask(
+    const Rc<DxvkShaderTask>&   task) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    if (unlikely(m_workers.empty()))
+      this->startWorkers();
+
+    m_tasks.push(task);
+    m_taskCount += 1;
+    m_cond.notify_one();
+  }
+
+
+  void DxvkShaderTaskQueue::waitForTask(
+    const Rc<DxvkShaderTask>&   task) {
+    if (likely(task->isDone()))
+      return;
+
+    auto t0 = dxvk::high_resolution_clock::now();
+
+    // If a worker is already running the task, make sure it
+    // does not get starved by the thread that is waiting on it
+    if (!task->tryRun()) {
+      this->boostTask(task);
+      task->wait();
+    }
+
+    auto t1 = dxvk::high_resolution_clock::now();
+    auto td = std::chrono::duration_cast<std::chrono::microseconds>(t1 - t0);
+
+    m_waitCount += 1;
+    m_waitTicks += td.count();
+  }
+
+
+  DxvkShaderTaskStats DxvkShaderTaskQueue::getStats() const {
+    DxvkShaderTaskStats result;
+    result.numQueuedTasks = m_taskCount.load();
+    result.numWaits       = m_waitCount.load();
+    result.waitTicks      = m_waitTicks.load();
+    return result;
+  }
+
+
+  void DxvkShaderTaskQueue::startWorkers() {
+    uint32_t numWorkers = std::max(1u, dxvk::thread::hardware_concurrency() / 4);
+
+    if (m_device->config().numCompilerThreads > 0)
+      numWorkers = m_device->config().numCompilerThreads;
+
+    Logger::info(str::format("DXVK: Using ", numWorkers, " shader translation threads"));
+
+    m_workerTasks.resize(numWorkers);
+
+    for (uint32_t i = 0; i < numWorkers; i++) {
+      m_workers.emplace_back([this, i] () { runWorker(i); });
+      m_workers[i].set_priority(ThreadPriority::Lowest);
+    }
+  }
+
+
+  void DxvkShaderTaskQueue::boostTask(
+    const Rc<DxvkShaderTask>&   task) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    for (uint32_t i = 0; i < m_workerTasks.size(); i++) {
+      WorkerTask& entry = m_workerTasks[i];
+
+      if (entry.task == task && !entry.boosted) {
+        m_workers[i].set_priority(ThreadPriority::Normal);
+        entry.boosted = true;
+      }
+    }
+  }
+
+
+  void DxvkShaderTaskQueue::runWorker(uint32_t index) {
+    env::setThreadName("dxvk-shader");
+
+    while (true) {
+      Rc<DxvkShaderTask> task;
+
+      { std::unique_lock<std::mutex> lock(m_mutex);
+
+        m_cond.wait(lock, [this] () {
+          return m_tasks.size()
+              || m_stopped;
+        });
+
+        if (m_stopped)
+          return;
+
+        task = std::move(m_tasks.front());
+        m_tasks.pop();
+
+        m_workerTasks[index].task = task;
+      }
+
+      // The task may already have been
+      // executed by a waiting thread
+      task->tryRun();
+
+      { std::lock_guard<std::mutex> lock(m_mutex);
+        WorkerTask& entry = m_workerTasks[index];
+
+        if (entry.boosted) {
+          m_workers[index].set_priority(ThreadPriority::Lowest);
+          entry.boosted = false;
+        }
+
+        entry.task = nullptr;
+      }
+
+      m_taskCount -= 1;
+    }
+  }
+
+}
@@ -0,0 +1,181 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <queue>
+#include <vector>
+
+#include "../util/thread.h"
+
+#include "dxvk_include.h"
+
+namespace dxvk {
+
+  class DxvkDevice;
+
+  /**
+   * \brief Shader task status
+   */
+  enum class DxvkShaderTaskStatus : uint32_t {
+    Pending,
+    Running,
+    Done,
+  };
+
+
+  /**
+   * \brief Shader task
+   *
+   * Base class for shader translation work that is
+   * deferred to a worker thread. The task is executed
+   * exactly once, either by a worker or by the first
+   * thread that needs the result before any worker
+   * has picked it up.
+   */
+  class DxvkShaderTask : public RcObject {
+
+  public:
+
+    virtual ~DxvkShaderTask();
+
+    /**
+     * \brief Checks whether the task has completed
+     * \returns \c true if the result is available
+     */
+    bool isDone() const {
+      return m_status.load() == DxvkShaderTaskStatus::Done;
+    }
+
+    /**
+     * \brief Checks whether the task has failed
+     *
+     * Only meaningful once the task is done. A failed
+     * task still provides a result object, but that
+     * does not contain a usable shader.
+     * \returns \c true if the task is done and failed
+     */
+    bool hasFailed() const {
+      return isDone() && m_failed;
+    }
+
+    /**
+     * \brief Runs the task if it has not been started
+     * \returns \c true if the task was run by this call
+     */
+    bool tryRun();
+
+    /**
+     * \brief Waits for the task to complete
+     *
+     * Executes the task on the calling thread if it has
+     * not been started yet, otherwise waits for the thread
+     * that is currently executing it.
+     * \returns \c true if the task was not done yet
+     */
+    bool wait();
+
+  protected:
+
+    /**
+     * \brief Executes the task
+     *
+     * Called exactly once. Implementations must
+     * not throw, errors have to be reported via
+     * the return value instead.
+     * \returns \c false if the task failed
+     */
+    virtual bool run() = 0;
+
+  private:
+
+    std::atomic<DxvkShaderTaskStatus> m_status = { DxvkShaderTaskStatus::Pending };
+    bool                              m_failed = false;
+
+    std::mutex              m_mutex;
+    std::condition_variable m_cond;
+
+  };
+
+
+  /**
+   * \brief Shader task statistics
+   */
+  struct DxvkShaderTaskStats {
+    uint32_t numQueuedTasks;
+    uint64_t numWaits;
+    uint64_t waitTicks;
+  };
+
+
+  /**
+   * \brief Shader task queue
+   *
+   * Runs shader tasks on a set of low-priority worker
+   * threads, which are only created once the first task
+   * gets queued. A worker runs at normal priority while
+   * another thread is waiting for its current task. Also
+   * keeps track of how often a thread had to wait for a
+   * task that was not done yet.
+   */
+  class DxvkShaderTaskQueue {
+
+  public:
+
+    DxvkShaderTaskQueue(const DxvkDevice* device);
+
+    ~DxvkShaderTaskQueue();
+
+    /**
+     * \brief Queues a task for execution
+     * \param [in] task The task to execute
+     */
+    void queueTask(
+      const Rc<DxvkShaderTask>&   task);
+
+    /**
+     * \brief Waits for a task to complete
+     *
+     * If the task is not done yet, this will count
+     * as a stall and the wait time gets recorded.
+     * \param [in] task The task to wait for
+     */
+    void waitForTask(
+      const Rc<DxvkShaderTask>&   task);
+
+    /**
+     * \brief Retrieves statistics
+     * \returns Task queue statistics
+     */
+    DxvkShaderTaskStats getStats() const;
+
+  private:
+
+    struct WorkerTask {
+      Rc<DxvkShaderTask>  task;
+      bool                boosted = false;
+    };
+
+    const DxvkDevice*             m_device;
+
+    std::atomic<uint32_t>         m_taskCount = { 0 };
+    std::atomic<uint64_t>         m_waitCount = { 0 };
+    std::atomic<uint64_t>         m_waitTicks = { 0 };
+
+    bool                          m_stopped   = false;
+    std::mutex                    m_mutex;
+    std::condition_variable       m_cond;
+    std::queue<Rc<DxvkShaderTask>> m_tasks;
+    std::vector<dxvk::thread>     m_workers;
+    std::vector<WorkerTask>       m_workerTasks;
+
+    void startWorkers();
+
+    void boostTask(
+      const Rc<DxvkShaderTask>&   task);
+
+    void runWorker(uint32_t index);
+
+  };
+
+}
\ No newline at end of file
@@ -21,7 +21,7 @@ namespace dxvk {
     if (m_buffer == nullptr)
       m_buffer = createBuffer(MaxBufferSize);
     
-    if (!m_buffer->isInUse())
+    if (isBufferFree(m_buffer))
       m_offset = 0;
     
     m_offset = dxvk::align(m_offset, align);
@@ -32,7 +32,7 @@ namespace dxvk {
       if (m_buffers.size() < MaxBufferCount)
         m_buffers.push(std::move(m_buffer));
 
-      if (!m_buffers.front()->isInUse()) {
+      if (isBufferFree(m_buffers.front())) {
         m_buffer = std::move(m_buffers.front());
         m_buffers.pop();
       } else {
@@ -66,5 +66,12 @@ namespace dxvk {
       VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT |
       VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
   }
+
+
+  bool DxvkStagingDataAlloc::isBufferFree(const Rc<DxvkBuffer>& buffer) {
+    // Slices captured by commands that have not been recorded
+    // yet hold a reference, but do not mark the buffer as used
+    return !buffer->isInUse() && buffer->getRefCount() == 1;
+  }
   
 }
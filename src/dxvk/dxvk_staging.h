@@ -14,6 +14,12 @@ namespace dxvk {
    * Allocates buffer slices for resource uploads,
    * while trying to keep the number of allocations
    * but also the amount of allocated memory low.
+   * 
+   * Buffers are only reused once the GPU is done
+   * with them and no pending command holds a slice,
+   * so the allocator can be used on threads other
+   * than the one recording the commands, as long
+   * as each allocator is only used by one thread.
    */
   class DxvkStagingDataAlloc {
     constexpr static VkDeviceSize MaxBufferSize  = 1 << 25; // 32 MiB
@@ -51,6 +57,8 @@ namespace dxvk {
 
     Rc<DxvkBuffer> createBuffer(VkDeviceSize size);
 
+    static bool isBufferFree(const Rc<DxvkBuffer>& buffer);
+
   };
   
 }
@@ -80,6 +80,24 @@ namespace dxvk {
   };
 
 
+  /**
+   * \brief Memory stream buffer
+   *
+   * Allows reading cache entries from
+   * a memory-mapped range of the file.
+   */
+  class DxvkStateCacheMemoryBuffer : public std::streambuf {
+
+  public:
+
+    DxvkStateCacheMemoryBuffer(const char* data, size_t size) {
+      auto ptr = const_cast<char*>(data);
+      this->setg(ptr, ptr, ptr + size);
+    }
+
+  };
+
+
   template<typename T>
   bool readCacheEntryTyped(std::istream& stream, T& entry) {
     auto data = reinterpret_cast<char*>(&entry);
@@ -121,48 +139,21 @@ namespace dxvk {
           DxvkPipelineManager*  pipeManager,
           DxvkRenderPassPool*   passManager)
   : m_pipeManager(pipeManager),
-    m_passManager(passManager) {
-    bool newFile = !readCacheFile();
-
-    if (newFile) {
-      Logger::warn("DXVK: Creating new state cache file");
-
-      // Start with an empty file
-      std::ofstream file(getCacheFileName(),
-        std::ios_base::binary |
-        std::ios_base::trunc);
-
-      if (!file && env::createDirectory(getCacheDir())) {
-        file = std::ofstream(getCacheFileName(),
-          std::ios_base::binary |
-          std::ios_base::trunc);
-      }
-
-      // Write header with the current version number
-      DxvkStateCacheHeader header;
-
-      auto data = reinterpret_cast<const char*>(&header);
-      auto size = sizeof(header);
-
-      file.write(data, size);
-
-      // Write all valid entries to the cache file in
-      // case we're recovering a corrupted cache file
-      for (auto& e : m_entries)
-        writeCacheEntry(file, e);
-    }
-
-    // Use half the available CPU cores for pipeline compilation
-    uint32_t numCpuCores = dxvk::thread::hardware_concurrency();
-    uint32_t numWorkers  = numCpuCores > 8
-      ? numCpuCores * 3 / 4
-      : numCpuCores * 1 / 2;
-
-    if (numWorkers <  1) numWorkers =  1;
-    if (numWorkers > 16) numWorkers = 16;
-
-    if (device->config().numCompilerThreads > 0)
-      numWorkers = device->config().numCompilerThreads;
+    m_passManager(passManager),
+    m_startTime  (high_resolution_clock::now()) {
+    // Map the cache file and split it into batches of entries,
+    // which will be parsed by the worker threads. If there is
+    // nothing to parse, we can finish loading immediately.
+    m_readerValid = mapCacheFile();
+    m_readerBatchCount = m_readerBatches.size();
+    m_readerPending.store(m_readerBatchCount);
+
+    if (!m_readerBatchCount)
+      finishCacheLoad();
+
+    // The number of workers is shared with the async pipeline
+    // compiler, which takes slots from the state cache workers
+    uint32_t numWorkers = m_pipeManager->getWorkerSlotCount();
     
     Logger::info(str::format("DXVK: Using ", numWorkers, " compiler threads"));
     
@@ -192,6 +183,8 @@ namespace dxvk {
       worker.join();
     
     m_writerThread.join();
+
+    unmapCacheFile();
   }
 
 
@@ -202,22 +195,17 @@ namespace dxvk {
     if (shaders.vs.eq(g_nullShaderKey))
       return;
     
-    // Do not add an entry that is already in the cache
-    auto entries = m_entryMap.equal_range(shaders);
-
-    for (auto e = entries.first; e != entries.second; e++) {
-      const DxvkStateCacheEntry& entry = m_entries[e->second];
-
-      if (entry.format.eq(format) && entry.gpState == state)
-        return;
-    }
+    // Pipelines that are already in the cache are written
+    // again with their usage info, which will be merged
+    // with the existing entry when loading the cache.
+    WriterItem item = { shaders, state,
+      DxvkComputePipelineStateInfo(),
+      format, g_nullHash, getTimeSinceStart(), 1 };
 
     // Queue a job to write this pipeline to the cache
     std::unique_lock<std::mutex> lock(m_writerLock);
 
-    m_writerQueue.push({ shaders, state,
-      DxvkComputePipelineStateInfo(),
-      format, g_nullHash });
+    m_writerQueue.push(item);
     m_writerCond.notify_one();
   }
 
@@ -228,20 +216,15 @@ namespace dxvk {
     if (shaders.cs.eq(g_nullShaderKey))
       return;
 
-    // Do not add an entry that is already in the cache
-    auto entries = m_entryMap.equal_range(shaders);
-
-    for (auto e = entries.first; e != entries.second; e++) {
-      if (m_entries[e->second].cpState == state)
-        return;
-    }
+    WriterItem item = { shaders,
+      DxvkGraphicsPipelineStateInfo(), state,
+      DxvkRenderPassFormat(), g_nullHash,
+      getTimeSinceStart(), 1 };
 
     // Queue a job to write this pipeline to the cache
     std::unique_lock<std::mutex> lock(m_writerLock);
 
-    m_writerQueue.push({ shaders,
-      DxvkGraphicsPipelineStateInfo(), state,
-      DxvkRenderPassFormat(), g_nullHash });
+    m_writerQueue.push(item);
     m_writerCond.notify_one();
   }
 
@@ -272,6 +255,8 @@ namespace dxvk {
        || !getShaderByKey(p->second.cs,  item.cp.cs))
         continue;
       
+      item.priority = getPipelinePriority(p->second);
+
       if (!workerLock)
         workerLock = std::unique_lock<std::mutex>(m_workerLock);
       
@@ -327,118 +312,364 @@ namespace dxvk {
     key.fs  = getShaderKey(item.gp.fs);
     key.cs  = getShaderKey(item.cp.cs);
 
+    // Compile pipelines in the order in which they are needed
+    std::vector<size_t> entryIds;
+
+    auto entries = m_entryMap.equal_range(key);
+
+    for (auto e = entries.first; e != entries.second; e++)
+      entryIds.push_back(e->second);
+
+    std::sort(entryIds.begin(), entryIds.end(),
+      [this] (size_t a, size_t b) {
+        return getEntryPriority(m_entries[a])
+             < getEntryPriority(m_entries[b]);
+      });
+
     if (item.cp.cs == nullptr) {
       auto pipeline = m_pipeManager->createGraphicsPipeline(item.gp);
-      auto entries = m_entryMap.equal_range(key);
 
-      for (auto e = entries.first; e != entries.second; e++) {
-        const auto& entry = m_entries[e->second];
+      for (size_t entryId : entryIds) {
+        const auto& entry = m_entries[entryId];
 
         auto rp = m_passManager->getRenderPass(entry.format);
+
+        m_pipeManager->acquireWorkerSlot(false);
         pipeline->compilePipeline(entry.gpState, rp);
+        m_pipeManager->releaseWorkerSlot();
       }
     } else {
       auto pipeline = m_pipeManager->createComputePipeline(item.cp);
-      auto entries = m_entryMap.equal_range(key);
 
-      for (auto e = entries.first; e != entries.second; e++) {
-        const auto& entry = m_entries[e->second];
+      for (size_t entryId : entryIds) {
+        const auto& entry = m_entries[entryId];
+
+        m_pipeManager->acquireWorkerSlot(false);
         pipeline->compilePipeline(entry.cpState);
+        m_pipeManager->releaseWorkerSlot();
       }
     }
   }
 
 
-  bool DxvkStateCache::readCacheFile() {
+  uint64_t DxvkStateCache::getPipelinePriority(
+    const DxvkStateCacheKey&        key) const {
+    uint64_t priority = ~0ull;
+
+    auto entries = m_entryMap.equal_range(key);
+
+    for (auto e = entries.first; e != entries.second; e++)
+      priority = std::min(priority, getEntryPriority(m_entries[e->second]));
+
+    return priority;
+  }
+
+
+  uint32_t DxvkStateCache::getTimeSinceStart() const {
+    auto time = std::chrono::duration_cast<std::chrono::milliseconds>(
+      high_resolution_clock::now() - m_startTime);
+
+    return uint32_t(std::min<int64_t>(time.count(), ~0u - 1));
+  }
+
+
+  DxvkStateCacheEntry* DxvkStateCache::findEntry(
+    const DxvkStateCacheEntry&      entry) {
+    auto entries = m_entryMap.equal_range(entry.shaders);
+
+    for (auto e = entries.first; e != entries.second; e++) {
+      DxvkStateCacheEntry& cached = m_entries[e->second];
+
+      bool match = entry.shaders.cs.eq(g_nullShaderKey)
+        ? cached.format.eq(entry.format) && cached.gpState == entry.gpState
+        : cached.cpState == entry.cpState;
+
+      if (match)
+        return &cached;
+    }
+
+    return nullptr;
+  }
+
+
+  bool DxvkStateCache::mapCacheFile() {
+    WCHAR fileName[MAX_PATH];
+    str::tows(getCacheFileName().c_str(), fileName);
+
     // Open state file and just fail if it doesn't exist
-    std::ifstream ifile(getCacheFileName(), std::ios_base::binary);
+    m_readerFile = CreateFileW(fileName, GENERIC_READ,
+      FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+      FILE_ATTRIBUTE_NORMAL, nullptr);
 
-    if (!ifile) {
+    if (m_readerFile == INVALID_HANDLE_VALUE) {
       Logger::warn("DXVK: No state cache file found");
       return false;
     }
 
-    // The header stores the state cache version,
-    // we need to regenerate it if it's outdated
-    DxvkStateCacheHeader newHeader;
-    DxvkStateCacheHeader curHeader;
+    LARGE_INTEGER fileSize;
 
-    if (!readCacheHeader(ifile, curHeader)) {
+    if (!GetFileSizeEx(m_readerFile, &fileSize)
+     || size_t(fileSize.QuadPart) < sizeof(DxvkStateCacheHeader)) {
       Logger::warn("DXVK: Failed to read state cache header");
       return false;
     }
 
-    // Struct size hasn't changed between v2 and v4
-    size_t expectedSize = newHeader.entrySize;
+    m_readerMapSize = size_t(fileSize.QuadPart);
+    m_readerMapping = CreateFileMappingW(m_readerFile, nullptr, PAGE_READONLY, 0, 0, nullptr);
 
-    if (curHeader.version <= 4)
-      expectedSize = sizeof(DxvkStateCacheEntryV4);
-    else if (curHeader.version <= 5)
-      expectedSize = sizeof(DxvkStateCacheEntryV5);
-    else if (curHeader.version <= 6)
-      expectedSize = sizeof(DxvkStateCacheEntryV6);
-    else if (curHeader.version <= 7)
-      expectedSize = sizeof(DxvkStateCacheEntry);
+    if (m_readerMapping)
+      m_readerMapPtr = reinterpret_cast<const char*>(MapViewOfFile(m_readerMapping, FILE_MAP_READ, 0, 0, 0));
 
-    if (curHeader.entrySize != expectedSize) {
-      Logger::warn("DXVK: State cache entry size changed");
+    if (!m_readerMapPtr) {
+      Logger::warn("DXVK: Failed to map state cache file");
       return false;
     }
 
-    // Discard caches of unsupported versions
-    if (curHeader.version < 2 || curHeader.version > newHeader.version) {
-      Logger::warn("DXVK: State cache version not supported");
+    // The header stores the state cache version,
+    // we need to regenerate it if it's outdated
+    DxvkStateCacheHeader newHeader;
+    DxvkStateCacheHeader curHeader;
+
+    DxvkStateCacheMemoryBuffer headerBuffer(m_readerMapPtr, sizeof(curHeader));
+    std::istream headerStream(&headerBuffer);
+
+    if (!readCacheHeader(headerStream, curHeader)) {
+      Logger::warn("DXVK: Failed to read state cache header");
       return false;
     }
 
+    if (!checkCacheHeader(curHeader))
+      return false;
+
     // Notify user about format conversion
     if (curHeader.version != newHeader.version)
       Logger::warn(str::format("DXVK: Updating state cache version to v", newHeader.version));
 
+    m_readerVersion = curHeader.version;
+
+    // Split the file into batches of entries. Older versions
+    // use fixed-size entries, newer ones store the size of
+    // each entry in its header, which we can skip quickly.
+    constexpr uint32_t EntriesPerBatch = 256;
+
+    size_t expectedSize = curHeader.entrySize;
+
+    size_t batchStart = sizeof(curHeader);
+    size_t offset     = batchStart;
+    uint32_t count    = 0;
+
+    while (offset < m_readerMapSize) {
+      size_t entrySize = expectedSize;
+
+      if (curHeader.version >= 8) {
+        DxvkStateCacheEntryHeader entryHeader;
+
+        if (offset + sizeof(entryHeader) > m_readerMapSize)
+          break;
+
+        std::memcpy(&entryHeader, m_readerMapPtr + offset, sizeof(entryHeader));
+        entrySize = sizeof(entryHeader) + sizeof(Sha1Hash) + entryHeader.entrySize;
+      }
+
+      offset += entrySize;
+
+      if (++count == EntriesPerBatch && offset < m_readerMapSize) {
+        m_readerBatches.push_back({ m_readerMapPtr + batchStart, offset - batchStart, { }, 0 });
+
+        batchStart = offset;
+        count      = 0;
+      }
+    }
+
+    // The last batch covers the rest of the file, so
+    // that truncated entries are handled by the reader
+    if (batchStart < m_readerMapSize)
+      m_readerBatches.push_back({ m_readerMapPtr + batchStart, m_readerMapSize - batchStart, { }, 0 });
+
+    return true;
+  }
+
+
+  void DxvkStateCache::unmapCacheFile() {
+    if (m_readerMapPtr)
+      UnmapViewOfFile(m_readerMapPtr);
+
+    if (m_readerMapping)
+      CloseHandle(m_readerMapping);
+
+    if (m_readerFile != INVALID_HANDLE_VALUE)
+      CloseHandle(m_readerFile);
+
+    m_readerFile    = INVALID_HANDLE_VALUE;
+    m_readerMapping = nullptr;
+    m_readerMapPtr  = nullptr;
+    m_readerMapSize = 0;
+  }
+
+
+  void DxvkStateCache::processReaderBatches() {
+    size_t index;
+
+    // Compare against the batch count rather than the batch
+    // array, since the array is modified after the last batch
+    // has been parsed while other threads may still be here
+    while ((index = m_readerNextBatch++) < m_readerBatchCount) {
+      readCacheBatch(m_readerBatches[index]);
+
+      // The thread that parses the last batch
+      // adds all entries to the lookup tables
+      if (!(--m_readerPending))
+        finishCacheLoad();
+    }
+  }
+
+
+  void DxvkStateCache::readCacheBatch(
+          ReaderBatch&              batch) const {
+    DxvkStateCacheMemoryBuffer buffer(batch.data, batch.size);
+    std::istream stream(&buffer);
+
     // Read actual cache entries from the file.
     // If we encounter invalid entries, we should
     // regenerate the entire state cache file.
+    while (stream) {
+      DxvkStateCacheEntry entry;
+
+      if (readCacheEntry(m_readerVersion, stream, entry))
+        batch.entries.push_back(entry);
+      else if (stream)
+        batch.numInvalid += 1;
+    }
+  }
+
+
+  void DxvkStateCache::finishCacheLoad() {
     uint32_t numInvalidEntries = 0;
+    uint32_t numMergedEntries  = 0;
 
-    while (ifile) {
-      DxvkStateCacheEntry entry;
+    { std::unique_lock<std::mutex> entryLock(m_entryLock);
+
+      for (auto& batch : m_readerBatches) {
+        for (const auto& entry : batch.entries) {
+          // Pipelines used in previous sessions are stored
+          // multiple times, so we need to merge usage info
+          DxvkStateCacheEntry* cached = findEntry(entry);
+
+          if (cached) {
+            cached->firstUse  = std::min(cached->firstUse, entry.firstUse);
+            cached->useCount += entry.useCount;
+
+            numMergedEntries += 1;
+            continue;
+          }
+
+          size_t entryId = m_entries.size();
+          m_entries.push_back(entry);
+
+          mapPipelineToEntry(entry.shaders, entryId);
+
+          mapShaderToPipeline(entry.shaders.vs,  entry.shaders);
+          mapShaderToPipeline(entry.shaders.tcs, entry.shaders);
+          mapShaderToPipeline(entry.shaders.tes, entry.shaders);
+          mapShaderToPipeline(entry.shaders.gs,  entry.shaders);
+          mapShaderToPipeline(entry.shaders.fs,  entry.shaders);
+          mapShaderToPipeline(entry.shaders.cs,  entry.shaders);
+        }
+
+        numInvalidEntries += batch.numInvalid;
 
-      if (readCacheEntry(curHeader.version, ifile, entry)) {
-        size_t entryId = m_entries.size();
-        m_entries.push_back(entry);
+        // Free parsed entries in place. The batch array itself
+        // must stay intact until the reader threads are joined.
+        batch.entries = std::vector<DxvkStateCacheEntry>();
+      }
 
-        mapPipelineToEntry(entry.shaders, entryId);
+      // Shaders may have been registered while the cache was
+      // being parsed, so compile all pipelines that are ready
+      if (!m_shaderMap.empty()) {
+        std::unique_lock<std::mutex> workerLock(m_workerLock);
+
+        for (auto p = m_entryMap.begin(); p != m_entryMap.end(); ) {
+          WorkerItem item;
+
+          if (getShaderByKey(p->first.vs,  item.gp.vs)
+           && getShaderByKey(p->first.tcs, item.gp.tcs)
+           && getShaderByKey(p->first.tes, item.gp.tes)
+           && getShaderByKey(p->first.gs,  item.gp.gs)
+           && getShaderByKey(p->first.fs,  item.gp.fs)
+           && getShaderByKey(p->first.cs,  item.cp.cs)) {
+            item.priority = getPipelinePriority(p->first);
+            m_workerQueue.push(item);
+          }
+
+          // Skip other entries with the same shaders
+          p = m_entryMap.equal_range(p->first).second;
+        }
 
-        mapShaderToPipeline(entry.shaders.vs,  entry.shaders);
-        mapShaderToPipeline(entry.shaders.tcs, entry.shaders);
-        mapShaderToPipeline(entry.shaders.tes, entry.shaders);
-        mapShaderToPipeline(entry.shaders.gs,  entry.shaders);
-        mapShaderToPipeline(entry.shaders.fs,  entry.shaders);
-        mapShaderToPipeline(entry.shaders.cs,  entry.shaders);
-      } else if (ifile) {
-        numInvalidEntries += 1;
+        m_workerCond.notify_all();
       }
     }
 
-    Logger::info(str::format(
-      "DXVK: Read ", m_entries.size(),
-      " valid state cache entries"));
+    if (m_readerValid) {
+      Logger::info(str::format(
+        "DXVK: Read ", m_entries.size(),
+        " valid state cache entries"));
+    }
 
     if (numInvalidEntries) {
       Logger::warn(str::format(
         "DXVK: Skipped ", numInvalidEntries,
         " invalid state cache entries"));
-      return false;
     }
-    
-    // Rewrite entire state cache if it is outdated
-    return curHeader.version == newHeader.version;
+
+    // The file must be unmapped before we can rewrite it
+    unmapCacheFile();
+
+    // Rewrite entire state cache if it is outdated, and
+    // compact the file if it contains usage updates
+    if (!m_readerValid || numInvalidEntries || numMergedEntries
+     || m_readerVersion != DxvkStateCacheHeader().version)
+      writeCacheFile();
+
+    // Let the writer append new entries
+    { std::unique_lock<std::mutex> lock(m_writerLock);
+      m_loaded.store(true);
+      m_writerCond.notify_one();
+    }
+  }
+
+
+  void DxvkStateCache::writeCacheFile() {
+    Logger::warn("DXVK: Creating new state cache file");
+
+    // Start with an empty file
+    std::ofstream file(getCacheFileName(),
+      std::ios_base::binary |
+      std::ios_base::trunc);
+
+    if (!file && env::createDirectory(getCacheDir())) {
+      file = std::ofstream(getCacheFileName(),
+        std::ios_base::binary |
+        std::ios_base::trunc);
+    }
+
+    // Write header with the current version number
+    DxvkStateCacheHeader header;
+
+    auto data = reinterpret_cast<const char*>(&header);
+    auto size = sizeof(header);
+
+    file.write(data, size);
+
+    // Write all valid entries to the cache file in
+    // case we're recovering a corrupted cache file
+    for (auto& e : m_entries)
+      writeCacheEntry(file, e);
   }
 
 
   bool DxvkStateCache::readCacheHeader(
           std::istream&             stream,
-          DxvkStateCacheHeader&     header) const {
+          DxvkStateCacheHeader&     header) {
     DxvkStateCacheHeader expected;
 
     auto data = reinterpret_cast<char*>(&header);
@@ -456,10 +687,41 @@ namespace dxvk {
   }
 
 
+  bool DxvkStateCache::checkCacheHeader(
+    const DxvkStateCacheHeader&     header) {
+    DxvkStateCacheHeader newHeader;
+
+    // Struct size hasn't changed between v2 and v4
+    size_t expectedSize = newHeader.entrySize;
+
+    if (header.version <= 4)
+      expectedSize = sizeof(DxvkStateCacheEntryV4);
+    else if (header.version <= 5)
+      expectedSize = sizeof(DxvkStateCacheEntryV5);
+    else if (header.version <= 6)
+      expectedSize = sizeof(DxvkStateCacheEntryV6);
+    else if (header.version <= 7)
+      expectedSize = sizeof(DxvkStateCacheEntryV7);
+
+    if (header.entrySize != expectedSize) {
+      Logger::warn("DXVK: State cache entry size changed");
+      return false;
+    }
+
+    // Discard caches of unsupported versions
+    if (header.version < 2 || header.version > newHeader.version) {
+      Logger::warn("DXVK: State cache version not supported");
+      return false;
+    }
+
+    return true;
+  }
+
+
   bool DxvkStateCache::readCacheEntryV7(
           uint32_t                  version,
           std::istream&             stream, 
-          DxvkStateCacheEntry&      entry) const {
+          DxvkStateCacheEntry&      entry) {
     if (version <= 6) {
       DxvkStateCacheEntryV6 v6;
 
@@ -489,7 +751,12 @@ namespace dxvk {
 
       return convertEntryV6(v6, entry);
     } else {
-      return readCacheEntryTyped(stream, entry);
+      DxvkStateCacheEntryV7 v7;
+
+      if (!readCacheEntryTyped(stream, v7))
+        return false;
+
+      return convertEntryV7(v7, entry);
     }
   }
 
@@ -497,7 +764,7 @@ namespace dxvk {
   bool DxvkStateCache::readCacheEntry(
           uint32_t                  version,
           std::istream&             stream, 
-          DxvkStateCacheEntry&      entry) const {
+          DxvkStateCacheEntry&      entry) {
     if (version < 8)
       return readCacheEntryV7(version, stream, entry);
 
@@ -614,13 +881,20 @@ namespace dxvk {
       }
     }
 
+    // Read usage info
+    if (version >= 9) {
+      if (!data.read(entry.firstUse)
+       || !data.read(entry.useCount))
+        return false;
+    }
+
     return true;
   }
 
 
   void DxvkStateCache::writeCacheEntry(
           std::ostream&             stream, 
-          DxvkStateCacheEntry&      entry) const {
+          DxvkStateCacheEntry&      entry) {
     DxvkStateCacheEntryData data;
     VkShaderStageFlags stageMask = 0;
 
@@ -691,6 +965,10 @@ namespace dxvk {
         data.write(sc.specConstants[i]);
     }
 
+    // Write usage info
+    data.write(entry.firstUse);
+    data.write(entry.useCount);
+
     // General layout: header -> hash -> data
     DxvkStateCacheEntryHeader header;
     header.stageMask = uint8_t(stageMask);
@@ -706,7 +984,7 @@ namespace dxvk {
 
 
   bool DxvkStateCache::convertEntryV2(
-          DxvkStateCacheEntryV4&    entry) const {
+          DxvkStateCacheEntryV4&    entry) {
     // Semantics changed:
     // v2: rsDepthClampEnable
     // v3: rsDepthClipEnable
@@ -721,7 +999,7 @@ namespace dxvk {
 
   bool DxvkStateCache::convertEntryV4(
     const DxvkStateCacheEntryV4&    in,
-          DxvkStateCacheEntryV6&    out) const {
+          DxvkStateCacheEntryV6&    out) {
     out.shaders = in.shaders;
     out.format  = in.format;
     out.hash    = in.hash;
@@ -777,7 +1055,7 @@ namespace dxvk {
 
   bool DxvkStateCache::convertEntryV5(
     const DxvkStateCacheEntryV5&    in,
-          DxvkStateCacheEntryV6&    out) const {
+          DxvkStateCacheEntryV6&    out) {
     out.shaders = in.shaders;
     out.gpState = in.gpState;
     out.format  = in.format;
@@ -790,7 +1068,7 @@ namespace dxvk {
 
   bool DxvkStateCache::convertEntryV6(
     const DxvkStateCacheEntryV6&    in,
-          DxvkStateCacheEntry&      out) const {
+          DxvkStateCacheEntry&      out) {
     out.shaders = in.shaders;
     out.format  = in.format;
     out.hash    = in.hash;
@@ -883,9 +1161,24 @@ namespace dxvk {
   }
 
 
+  bool DxvkStateCache::convertEntryV7(
+    const DxvkStateCacheEntryV7&    in,
+          DxvkStateCacheEntry&      out) {
+    out.shaders = in.shaders;
+    out.gpState = in.gpState;
+    out.cpState = in.cpState;
+    out.format  = in.format;
+    out.hash    = in.hash;
+    return true;
+  }
+
+
   void DxvkStateCache::workerFunc() {
     env::setThreadName("dxvk-shader");
 
+    // Parse the cache file before compiling any pipelines
+    processReaderBatches();
+
     while (!m_stopThreads.load()) {
       WorkerItem item;
 
@@ -905,7 +1198,7 @@ namespace dxvk {
         if (m_workerQueue.empty())
           break;
         
-        item = m_workerQueue.front();
+        item = m_workerQueue.top();
         m_workerQueue.pop();
       }
 
@@ -925,7 +1218,7 @@ namespace dxvk {
       { std::unique_lock<std::mutex> lock(m_writerLock);
 
         m_writerCond.wait(lock, [this] () {
-          return m_writerQueue.size()
+          return (m_writerQueue.size() && m_loaded.load())
               || m_stopThreads.load();
         });
 
@@ -10,6 +10,8 @@
 
 #include "dxvk_state_cache_types.h"
 
+#include "../util/util_time.h"
+
 namespace dxvk {
 
   class DxvkDevice;
@@ -22,6 +24,10 @@ namespace dxvk {
    * game, which allows DXVK to compile them ahead
    * of time instead of compiling them on the first
    * draw.
+   *
+   * The cache file is memory-mapped and parsed on the
+   * compiler worker threads, so that device creation
+   * does not have to wait for the cache to be loaded.
    */
   class DxvkStateCache : public RcObject {
 
@@ -79,6 +85,65 @@ namespace dxvk {
       return m_workerBusy.load() > 0;
     }
 
+    /**
+     * \brief Reads cache file header
+     *
+     * \param [in] stream Input stream
+     * \param [out] header Cache file header
+     * \returns \c true if the header magic is valid
+     */
+    static bool readCacheHeader(
+            std::istream&             stream,
+            DxvkStateCacheHeader&     header);
+
+    /**
+     * \brief Checks whether a cache file can be read
+     *
+     * Checks the version and entry size stored
+     * in the header, and logs a warning if the
+     * file is not supported.
+     * \param [in] header Cache file header
+     * \returns \c true if entries can be read
+     */
+    static bool checkCacheHeader(
+      const DxvkStateCacheHeader&     header);
+
+    /**
+     * \brief Reads a single cache entry
+     *
+     * Entries of older versions are converted
+     * to the current version. Fails if the
+     * entry is invalid or corrupted.
+     * \param [in] version Cache file version
+     * \param [in] stream Input stream
+     * \param [out] entry Cache entry
+     * \returns \c true on success
+     */
+    static bool readCacheEntry(
+            uint32_t                  version,
+            std::istream&             stream, 
+            DxvkStateCacheEntry&      entry);
+    
+    /**
+     * \brief Writes a single cache entry
+     *
+     * Always uses the current version.
+     * \param [in] stream Output stream
+     * \param [in] entry Cache entry
+     */
+    static void writeCacheEntry(
+            std::ostream&             stream, 
+            DxvkStateCacheEntry&      entry);
+
+    /**
+     * \brief Validates render pass format
+     *
+     * \param [in] format Render pass format
+     * \returns \c true if all image layouts are valid
+     */
+    static bool validateRenderPassFormat(
+      const DxvkRenderPassFormat&     format);
+
   private:
 
     using WriterItem = DxvkStateCacheEntry;
@@ -86,13 +151,30 @@ namespace dxvk {
     struct WorkerItem {
       DxvkGraphicsPipelineShaders gp;
       DxvkComputePipelineShaders  cp;
+      uint64_t                    priority = 0;
+
+      bool operator < (const WorkerItem& other) const {
+        // The priority queue returns the largest item
+        // first, but we want the lowest priority value
+        return priority > other.priority;
+      }
+    };
+
+    struct ReaderBatch {
+      const char*                       data;
+      size_t                            size;
+      std::vector<DxvkStateCacheEntry>  entries;
+      uint32_t                          numInvalid;
     };
 
     DxvkPipelineManager*              m_pipeManager;
     DxvkRenderPassPool*               m_passManager;
 
+    high_resolution_clock::time_point m_startTime;
+
     std::vector<DxvkStateCacheEntry>  m_entries;
     std::atomic<bool>                 m_stopThreads = { false };
+    std::atomic<bool>                 m_loaded      = { false };
 
     std::mutex                        m_entryLock;
 
@@ -110,7 +192,7 @@ namespace dxvk {
 
     std::mutex                        m_workerLock;
     std::condition_variable           m_workerCond;
-    std::queue<WorkerItem>            m_workerQueue;
+    std::priority_queue<WorkerItem>   m_workerQueue;
     std::atomic<uint32_t>             m_workerBusy;
     std::vector<dxvk::thread>         m_workerThreads;
 
@@ -119,6 +201,17 @@ namespace dxvk {
     std::queue<WriterItem>            m_writerQueue;
     dxvk::thread                      m_writerThread;
 
+    HANDLE                            m_readerFile    = INVALID_HANDLE_VALUE;
+    HANDLE                            m_readerMapping = nullptr;
+    const char*                       m_readerMapPtr  = nullptr;
+    size_t                            m_readerMapSize = 0;
+    bool                              m_readerValid   = false;
+    uint32_t                          m_readerVersion = 0;
+    std::vector<ReaderBatch>          m_readerBatches;
+    size_t                            m_readerBatchCount = 0;
+    std::atomic<size_t>               m_readerNextBatch = { 0 };
+    std::atomic<size_t>               m_readerPending   = { 0 };
+
     DxvkShaderKey getShaderKey(
       const Rc<DxvkShader>&           shader) const;
 
@@ -137,40 +230,50 @@ namespace dxvk {
     void compilePipelines(
       const WorkerItem&               item);
 
-    bool readCacheFile();
+    uint64_t getPipelinePriority(
+      const DxvkStateCacheKey&        key) const;
 
-    bool readCacheHeader(
-            std::istream&             stream,
-            DxvkStateCacheHeader&     header) const;
+    uint32_t getTimeSinceStart() const;
 
-    bool readCacheEntryV7(
-            uint32_t                  version,
-            std::istream&             stream, 
-            DxvkStateCacheEntry&      entry) const;
-    
-    bool readCacheEntry(
+    DxvkStateCacheEntry* findEntry(
+      const DxvkStateCacheEntry&      entry);
+
+    bool mapCacheFile();
+
+    void unmapCacheFile();
+
+    void processReaderBatches();
+
+    void readCacheBatch(
+            ReaderBatch&              batch) const;
+
+    void finishCacheLoad();
+
+    void writeCacheFile();
+
+    static bool readCacheEntryV7(
             uint32_t                  version,
             std::istream&             stream, 
-            DxvkStateCacheEntry&      entry) const;
+            DxvkStateCacheEntry&      entry);
     
-    void writeCacheEntry(
-            std::ostream&             stream, 
-            DxvkStateCacheEntry&      entry) const;
+    static bool convertEntryV2(
+            DxvkStateCacheEntryV4&    entry);
     
-    bool convertEntryV2(
-            DxvkStateCacheEntryV4&    entry) const;
-    
-    bool convertEntryV4(
+    static bool convertEntryV4(
       const DxvkStateCacheEntryV4&    in,
-            DxvkStateCacheEntryV6&    out) const;
+            DxvkStateCacheEntryV6&    out);
     
-    bool convertEntryV5(
+    static bool convertEntryV5(
       const DxvkStateCacheEntryV5&    in,
-            DxvkStateCacheEntryV6&    out) const;
+            DxvkStateCacheEntryV6&    out);
     
-    bool convertEntryV6(
+    static bool convertEntryV6(
       const DxvkStateCacheEntryV6&    in,
-            DxvkStateCacheEntry&      out) const;
+            DxvkStateCacheEntry&      out);
+    
+    static bool convertEntryV7(
+      const DxvkStateCacheEntryV7&    in,
+            DxvkStateCacheEntry&      out);
     
     void workerFunc();
 
@@ -186,8 +289,13 @@ namespace dxvk {
     static VkImageLayout unpackImageLayout(
             uint8_t                   layout);
 
-    static bool validateRenderPassFormat(
-      const DxvkRenderPassFormat&     format);
+    static uint64_t getEntryPriority(
+      const DxvkStateCacheEntry&      entry) {
+      // Order by first use with a granularity of one
+      // second, then by how often a pipeline was used
+      return (uint64_t(entry.firstUse / 1000) << 32)
+           | uint64_t(~entry.useCount);
+    }
 
   };
 
@@ -33,6 +33,12 @@ namespace dxvk {
    * as the full state vector, including its render
    * pass format. This also includes a SHA-1 hash
    * that is used as a check sum to verify integrity.
+   *
+   * The usage info stores the time at which the
+   * pipeline was first used, in milliseconds since
+   * device creation, and the number of sessions in
+   * which it was used. Entries without usage info
+   * are compiled after all other entries.
    */
   struct DxvkStateCacheEntry {
     DxvkStateCacheKey             shaders;
@@ -40,6 +46,8 @@ namespace dxvk {
     DxvkComputePipelineStateInfo  cpState;
     DxvkRenderPassFormat          format;
     Sha1Hash                      hash;
+    uint32_t                      firstUse = ~0u;
+    uint32_t                      useCount = 0;
   };
 
 
@@ -52,7 +60,7 @@ namespace dxvk {
    */
   struct DxvkStateCacheHeader {
     char     magic[4]   = { 'D', 'X', 'V', 'K' };
-    uint32_t version    = 8;
+    uint32_t version    = 9;
     uint32_t entrySize  = 0; /* no longer meaningful */
   };
 
@@ -200,4 +208,16 @@ namespace dxvk {
     Sha1Hash                        hash;
   };
 
+
+  /**
+   * \brief Version 7 state cache entry
+   */
+  struct DxvkStateCacheEntryV7 {
+    DxvkStateCacheKey               shaders;
+    DxvkGraphicsPipelineStateInfo   gpState;
+    DxvkComputePipelineStateInfo    cpState;
+    DxvkRenderPassFormat            format;
+    Sha1Hash                        hash;
+  };
+
 }
@@ -14,12 +14,24 @@ namespace dxvk {
     CmdDrawCalls,             ///< Number of draw calls
     CmdDispatchCalls,         ///< Number of compute calls
     CmdRenderPassCount,       ///< Number of render passes
+    CmdTrackCalls,            ///< Number of resource tracking requests
+    CmdTrackedResources,      ///< Number of resources tracked after deduplication
     PipeCountGraphics,        ///< Number of graphics pipelines
     PipeCountCompute,         ///< Number of compute pipelines
     PipeCompilerBusy,         ///< Boolean indicating compiler activity
+    PipeQueueDepth,           ///< Number of pipelines queued for async compilation
+    PipeSkippedDraws,         ///< Number of draws skipped due to pending pipelines
+    PipeWorkersBusy,          ///< Number of workers currently compiling pipelines
+    PipeWorkerSlots,          ///< Maximum number of concurrent pipeline compiler workers
+    DescriptorCacheHits,      ///< Number of reused descriptor sets
+    DescriptorCacheMisses,    ///< Number of newly written descriptor sets
     QueueSubmitCount,         ///< Number of command buffer submissions
     QueuePresentCount,        ///< Number of present calls / frames
     GpuIdleTicks,             ///< GPU idle time in microseconds
+    SamplerCount,             ///< Number of sampler objects
+    ShaderTaskQueueDepth,     ///< Number of shaders queued for translation
+    ShaderTaskWaits,          ///< Number of times a shader had to be waited for
+    ShaderTaskWaitTicks,      ///< Time spent waiting for shaders in microseconds
     NumCounters,              ///< Number of counters available
   };
   
@@ -345,6 +345,8 @@ namespace dxvk::hud {
       m_gpCount = diffCounters.getCtr(DxvkStatCounter::CmdDrawCalls);
       m_cpCount = diffCounters.getCtr(DxvkStatCounter::CmdDispatchCalls);
       m_rpCount = diffCounters.getCtr(DxvkStatCounter::CmdRenderPassCount);
+      m_trCount = diffCounters.getCtr(DxvkStatCounter::CmdTrackedResources);
+      m_tcCount = diffCounters.getCtr(DxvkStatCounter::CmdTrackCalls);
 
       m_lastUpdate = time;
     }
@@ -389,6 +391,17 @@ namespace dxvk::hud {
       { 1.0f, 1.0f, 1.0f, 1.0f },
       str::format(m_rpCount));
     
+    position.y += 20.0f;
+    renderer.drawText(16.0f,
+      { position.x, position.y },
+      { 0.25f, 0.5f, 1.0f, 1.0f },
+      "Tracked res.:");
+    
+    renderer.drawText(16.0f,
+      { position.x + 192.0f, position.y },
+      { 1.0f, 1.0f, 1.0f, 1.0f },
+      str::format(m_trCount, " / ", m_tcCount));
+    
     position.y += 8.0f;
     return position;
   }
@@ -410,6 +423,11 @@ namespace dxvk::hud {
 
     m_graphicsPipelines = counters.getCtr(DxvkStatCounter::PipeCountGraphics);
     m_computePipelines  = counters.getCtr(DxvkStatCounter::PipeCountCompute);
+    m_shaderWaits       = counters.getCtr(DxvkStatCounter::ShaderTaskWaits);
+    m_workersBusy       = counters.getCtr(DxvkStatCounter::PipeWorkersBusy);
+    m_workerSlots       = counters.getCtr(DxvkStatCounter::PipeWorkerSlots);
+    m_asyncQueue        = counters.getCtr(DxvkStatCounter::PipeQueueDepth);
+    m_skippedDraws      = counters.getCtr(DxvkStatCounter::PipeSkippedDraws);
   }
 
 
@@ -438,6 +456,54 @@ namespace dxvk::hud {
       { 1.0f, 1.0f, 1.0f, 1.0f },
       str::format(m_computePipelines));
 
+    position.y += 20.0f;
+    renderer.drawText(16.0f,
+      { position.x, position.y },
+      { 1.0f, 0.25f, 1.0f, 1.0f },
+      "Compiler workers:");
+
+    renderer.drawText(16.0f,
+      { position.x + 240.0f, position.y },
+      { 1.0f, 1.0f, 1.0f, 1.0f },
+      str::format(m_workersBusy, " / ", m_workerSlots));
+
+    if (m_device->config().enableAsyncPipelines) {
+      position.y += 20.0f;
+      renderer.drawText(16.0f,
+        { position.x, position.y },
+        { 1.0f, 0.25f, 1.0f, 1.0f },
+        "Async queue:");
+
+      renderer.drawText(16.0f,
+        { position.x + 240.0f, position.y },
+        { 1.0f, 1.0f, 1.0f, 1.0f },
+        str::format(m_asyncQueue));
+
+      position.y += 20.0f;
+      renderer.drawText(16.0f,
+        { position.x, position.y },
+        { 1.0f, 0.25f, 1.0f, 1.0f },
+        "Skipped draws:");
+
+      renderer.drawText(16.0f,
+        { position.x + 240.0f, position.y },
+        { 1.0f, 1.0f, 1.0f, 1.0f },
+        str::format(m_skippedDraws));
+    }
+
+    if (m_device->config().enableAsyncShaders) {
+      position.y += 20.0f;
+      renderer.drawText(16.0f,
+        { position.x, position.y },
+        { 1.0f, 0.25f, 1.0f, 1.0f },
+        "Shader waits:");
+
+      renderer.drawText(16.0f,
+        { position.x + 240.0f, position.y },
+        { 1.0f, 1.0f, 1.0f, 1.0f },
+        str::format(m_shaderWaits));
+    }
+
     position.y += 8.0f;
     return position;
   }
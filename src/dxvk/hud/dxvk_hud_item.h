@@ -273,6 +273,8 @@ namespace dxvk::hud {
     uint64_t          m_gpCount = 0;
     uint64_t          m_cpCount = 0;
     uint64_t          m_rpCount = 0;
+    uint64_t          m_trCount = 0;
+    uint64_t          m_tcCount = 0;
 
     dxvk::high_resolution_clock::time_point m_lastUpdate
       = dxvk::high_resolution_clock::now();
@@ -303,6 +305,11 @@ namespace dxvk::hud {
 
     uint64_t m_graphicsPipelines = 0;
     uint64_t m_computePipelines = 0;
+    uint64_t m_shaderWaits = 0;
+    uint64_t m_workersBusy = 0;
+    uint64_t m_workerSlots = 0;
+    uint64_t m_asyncQueue = 0;
+    uint64_t m_skippedDraws = 0;
 
   };
 
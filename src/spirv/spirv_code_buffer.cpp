@@ -1,3 +1,4 @@
+#include <algorithm>
 #include <array>
 #include <cstring>
 
@@ -10,13 +11,13 @@ namespace dxvk {
   
   
   SpirvCodeBuffer::SpirvCodeBuffer(uint32_t size)
-  : m_ptr(size) {
+  : m_size(size) {
     m_code.resize(size);
   }
 
 
   SpirvCodeBuffer::SpirvCodeBuffer(uint32_t size, const uint32_t* data)
-  : m_ptr(size) {
+  : m_size(size) {
     m_code.resize(size);
     std::memcpy(m_code.data(), data, size * sizeof(uint32_t));
   }
@@ -36,14 +37,14 @@ namespace dxvk {
     std::memcpy(reinterpret_cast<char*>(m_code.data()),
       buffer.data(), m_code.size() * sizeof(uint32_t));
     
-    m_ptr = m_code.size();
+    m_size = m_code.size();
   }
   
   
   uint32_t SpirvCodeBuffer::allocId() {
     constexpr size_t BoundIdsOffset = 3;
 
-    if (m_code.size() <= BoundIdsOffset)
+    if (m_size <= BoundIdsOffset)
       return 0;
 
     return m_code[BoundIdsOffset]++;
@@ -52,24 +53,17 @@ namespace dxvk {
 
   void SpirvCodeBuffer::append(const SpirvCodeBuffer& other) {
     if (other.size() != 0) {
-      const size_t size = m_code.size();
-      m_code.resize(size + other.m_code.size());
+      this->reserve(m_size + other.m_size);
       
             uint32_t* dst = this->m_code.data();
       const uint32_t* src = other.m_code.data();
       
-      std::memcpy(dst + size, src, other.size());
-      m_ptr += other.m_code.size();
+      std::memcpy(dst + m_size, src, other.size());
+      m_size += other.m_size;
     }
   }
   
   
-  void SpirvCodeBuffer::putWord(uint32_t word) {
-    m_code.insert(m_code.begin() + m_ptr, word);
-    m_ptr += 1;
-  }
-  
-  
   void SpirvCodeBuffer::putIns(spv::Op opCode, uint16_t wordCount) {
     this->putWord(
         (static_cast<uint32_t>(opCode)    <<  0)
@@ -133,9 +127,33 @@ namespace dxvk {
   
   
   void SpirvCodeBuffer::erase(size_t size) {
-    m_code.erase(
-      m_code.begin() + m_ptr,
-      m_code.begin() + m_ptr + size);
+    if (!m_insert)
+      return;
+    
+    size = std::min(size, m_size - m_ptr);
+    
+    std::memmove(
+      m_code.data() + m_ptr,
+      m_code.data() + m_ptr + size,
+      (m_size - m_ptr - size) * sizeof(uint32_t));
+    
+    m_size -= size;
+  }
+  
+  
+  void SpirvCodeBuffer::beginInsertion(size_t ptr) {
+    this->flushSplice();
+    
+    m_ptr    = ptr;
+    m_insert = ptr < m_size;
+  }
+  
+  
+  void SpirvCodeBuffer::endInsertion() {
+    this->flushSplice();
+    
+    m_ptr    = 0;
+    m_insert = false;
   }
 
 
@@ -148,7 +166,47 @@ namespace dxvk {
   void SpirvCodeBuffer::store(std::ostream& stream) const {
     stream.write(
       reinterpret_cast<const char*>(m_code.data()),
-      sizeof(uint32_t) * m_code.size());
+      sizeof(uint32_t) * m_size);
+  }
+  
+  
+  void SpirvCodeBuffer::reserve(size_t size) {
+    if (size <= m_code.size())
+      return;
+    
+    // Grow geometrically so that appending
+    // words remains amortized constant time
+    size_t newSize = std::max<size_t>(m_code.size() * 2, 256);
+    
+    while (newSize < size)
+      newSize *= 2;
+    
+    m_code.resize(newSize);
+  }
+  
+  
+  void SpirvCodeBuffer::flushSplice() {
+    if (m_splice.empty())
+      return;
+    
+    // Move the tail of the stream out of the way
+    // once and copy all inserted words into place
+    const size_t count = m_splice.size();
+    this->reserve(m_size + count);
+    
+    std::memmove(
+      m_code.data() + m_ptr + count,
+      m_code.data() + m_ptr,
+      (m_size - m_ptr) * sizeof(uint32_t));
+    
+    std::memcpy(
+      m_code.data() + m_ptr,
+      m_splice.data(),
+      count * sizeof(uint32_t));
+    
+    m_size += count;
+    m_ptr  += count;
+    m_splice.clear();
   }
   
 }
\ No newline at end of file
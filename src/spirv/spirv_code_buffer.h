@@ -7,6 +7,8 @@
 
 #include "spirv_instruction.h"
 
+#include "../util/util_likely.h"
+
 namespace dxvk {
   
   /**
@@ -15,6 +17,12 @@ namespace dxvk {
    * Helper class for generating SPIR-V shaders.
    * Stores arbitrary SPIR-V instructions in a
    * format that can be read by Vulkan drivers.
+   * 
+   * Appending words is a plain store into reserved
+   * storage. Words written in insertion mode, see
+   * \ref beginInsertion, are collected separately
+   * and spliced into the stream in one go when the
+   * insertion ends.
    */
   class SpirvCodeBuffer {
     
@@ -43,7 +51,7 @@ namespace dxvk {
      * \returns Code size, in dwords
      */
     uint32_t dwords() const {
-      return m_code.size();
+      return m_size;
     }
     
     /**
@@ -51,7 +59,7 @@ namespace dxvk {
      * \returns Code size, in bytes
      */
     size_t size() const {
-      return m_code.size() * sizeof(uint32_t);
+      return m_size * sizeof(uint32_t);
     }
     
     /**
@@ -63,7 +71,7 @@ namespace dxvk {
      */
     SpirvInstructionIterator begin() {
       return SpirvInstructionIterator(
-        m_code.data(), 0, m_code.size());
+        m_code.data(), 0, m_size);
     }
     
     /**
@@ -99,7 +107,17 @@ namespace dxvk {
      * \brief Appends an 32-bit word to the buffer
      * \param [in] word The word to append
      */
-    void putWord(uint32_t word);
+    void putWord(uint32_t word) {
+      if (unlikely(m_insert)) {
+        m_splice.push_back(word);
+        return;
+      }
+      
+      if (unlikely(m_size == m_code.size()))
+        this->reserve(m_size + 1);
+      
+      m_code[m_size++] = word;
+    }
     
     /**
      * \brief Appends an instruction word to the buffer
@@ -153,7 +171,8 @@ namespace dxvk {
      * \brief Erases given number of dwords
      *
      * Removes data from the code buffer, starting
-     * at the current insertion offset.
+     * at the current insertion offset. Has no effect
+     * if no insertion is currently in progress.
      * \param [in] size Number of words to remove
      */
     void erase(size_t size);
@@ -186,7 +205,9 @@ namespace dxvk {
      * \returns Current instruction pointr
      */
     size_t getInsertionPtr() const {
-      return m_ptr;
+      return m_insert
+        ? m_ptr + m_splice.size()
+        : m_size;
     }
     
     /**
@@ -194,11 +215,11 @@ namespace dxvk {
      * 
      * Sets the insertion pointer to a value that was
      * previously retrieved by \ref getInsertionPtr.
-     * \returns Current instruction pointr
+     * Inserted words only become visible in the
+     * code buffer once \ref endInsertion is called.
+     * \param [in] ptr Insertion pointer
      */
-    void beginInsertion(size_t ptr) {
-      m_ptr = ptr;
-    }
+    void beginInsertion(size_t ptr);
     
     /**
      * \brief Sets insertion pointer to the end
@@ -207,14 +228,20 @@ namespace dxvk {
      * appended to the stream. In other words,
      * this will restore default behaviour.
      */
-    void endInsertion() {
-      m_ptr = m_code.size();
-    }
+    void endInsertion();
     
   private:
     
     std::vector<uint32_t> m_code;
-    size_t m_ptr = 0;
+    size_t                m_size   = 0;
+    
+    std::vector<uint32_t> m_splice;
+    size_t                m_ptr    = 0;
+    bool                  m_insert = false;
+    
+    void reserve(size_t size);
+    
+    void flushSplice();
     
   };
   
@@ -20,11 +20,34 @@ namespace dxvk {
 
     SpirvCompressedBuffer(
       const SpirvCodeBuffer&  code);
+
+    SpirvCompressedBuffer(
+            uint32_t                size,
+            std::vector<uint64_t>&& mask,
+            std::vector<uint64_t>&& code);
     
     ~SpirvCompressedBuffer();
     
     SpirvCodeBuffer decompress() const;
 
+    /**
+     * \brief Uncompressed code size, in dwords
+     * \returns Uncompressed code size
+     */
+    uint32_t dwords() const {
+      return m_size;
+    }
+
+    /**
+     * \brief Compressed data
+     *
+     * Used to store the compressed code
+     * without decompressing it first.
+     * \returns Byte count masks and packed code
+     */
+    const std::vector<uint64_t>& mask() const { return m_mask; }
+    const std::vector<uint64_t>& code() const { return m_code; }
+
   private:
 
     uint32_t              m_size;
@@ -1,9 +1,52 @@
+#include <algorithm>
 #include <cstring>
 
 #include "spirv_module.h"
 
 namespace dxvk {
   
+  SpirvTypeConstKey::SpirvTypeConstKey(
+          spv::Op               op,
+          uint32_t              typeId,
+          uint32_t              argCount,
+    const uint32_t*             argIds)
+  : op(op), typeId(typeId), argCount(argCount) {
+    if (argCount <= MaxInlineArgs)
+      std::copy(argIds, argIds + argCount, inlineArgs.begin());
+    else
+      extArgs.assign(argIds, argIds + argCount);
+  }
+  
+  
+  bool SpirvTypeConstKey::eq(const SpirvTypeConstKey& other) const {
+    return this->op       == other.op
+        && this->typeId   == other.typeId
+        && this->argCount == other.argCount
+        && !std::memcmp(this->args(), other.args(), argCount * sizeof(uint32_t));
+  }
+  
+  
+  size_t SpirvTypeConstKey::hash() const {
+    // FNV-1a over all words, cheap enough for short operand lists
+    size_t result = 2166136261u;
+    
+    auto addWord = [&result] (uint32_t word) {
+      result ^= word;
+      result *= 16777619u;
+    };
+    
+    addWord(uint32_t(op));
+    addWord(typeId);
+    
+    const uint32_t* argIds = args();
+    
+    for (uint32_t i = 0; i < argCount; i++)
+      addWord(argIds[i]);
+    
+    return result;
+  }
+  
+  
   SpirvModule:: SpirvModule() {
     this->instImportGlsl450();
   }
@@ -3520,19 +3563,14 @@ namespace dxvk {
           spv::Op                 op, 
           uint32_t                argCount,
     const uint32_t*               argIds) {
-    // Since the type info is stored in the code buffer,
-    // we can use the code buffer to look up type IDs as
-    // well. Result IDs are always stored as argument 1.
-    for (auto ins : m_typeConstDefs) {
-      bool match = ins.opCode() == op
-                && ins.length() == 2 + argCount;
-      
-      for (uint32_t i = 0; i < argCount && match; i++)
-        match &= ins.arg(2 + i) == argIds[i];
-      
-      if (match)
-        return ins.arg(1);
-    }
+    // Look up the type in the hash table first, scanning
+    // the code buffer would make module generation quadratic
+    SpirvTypeConstKey key(op, 0, argCount, argIds);
+    
+    auto entry = m_typeConstLookup.find(key);
+    
+    if (entry != m_typeConstLookup.end())
+      return entry->second;
     
     // Type not yet declared, create a new one.
     uint32_t resultId = this->allocateId();
@@ -3541,6 +3579,8 @@ namespace dxvk {
     
     for (uint32_t i = 0; i < argCount; i++)
       m_typeConstDefs.putWord(argIds[i]);
+    
+    m_typeConstLookup.insert({ std::move(key), resultId });
     return resultId;
   }
   
@@ -3550,23 +3590,15 @@ namespace dxvk {
           uint32_t                typeId,
           uint32_t                argCount,
     const uint32_t*               argIds) {
-    // Avoid declaring constants multiple times
-    for (auto ins : m_typeConstDefs) {
-      bool match = ins.opCode() == op
-                && ins.length() == 3 + argCount
-                && ins.arg(1)   == typeId;
-      
-      for (uint32_t i = 0; i < argCount && match; i++)
-        match &= ins.arg(3 + i) == argIds[i];
-      
-      if (!match)
-        continue;
-      
-      uint32_t id = ins.arg(2);
-
-      if (m_lateConsts.find(id) == m_lateConsts.end())
-        return id;
-    }
+    // Avoid declaring constants multiple times. Late
+    // constants are never added to the lookup table
+    // since their value may change after the fact.
+    SpirvTypeConstKey key(op, typeId, argCount, argIds);
+    
+    auto entry = m_typeConstLookup.find(key);
+    
+    if (entry != m_typeConstLookup.end())
+      return entry->second;
     
     // Constant not yet declared, make a new one
     uint32_t resultId = this->allocateId();
@@ -3576,6 +3608,8 @@ namespace dxvk {
     
     for (uint32_t i = 0; i < argCount; i++)
       m_typeConstDefs.putWord(argIds[i]);
+    
+    m_typeConstLookup.insert({ std::move(key), resultId });
     return resultId;
   }
   
@@ -1,11 +1,60 @@
 #pragma once
 
+#include <array>
+#include <unordered_map>
 #include <unordered_set>
 
 #include "spirv_code_buffer.h"
 
 namespace dxvk {
   
+  /**
+   * \brief Type or constant declaration key
+   * 
+   * Stores the op code and all operands except
+   * for the result ID of a type or constant
+   * declaration. Used to look up existing
+   * declarations without scanning the module.
+   */
+  struct SpirvTypeConstKey {
+    constexpr static uint32_t MaxInlineArgs = 8;
+    
+    SpirvTypeConstKey(
+            spv::Op               op,
+            uint32_t              typeId,
+            uint32_t              argCount,
+      const uint32_t*             argIds);
+    
+    spv::Op               op;
+    uint32_t              typeId;
+    uint32_t              argCount;
+    
+    // Arguments are stored inline so that looking up
+    // declarations does not allocate memory. Only long
+    // operand lists, e.g. large structs, use the heap.
+    std::array<uint32_t, MaxInlineArgs> inlineArgs;
+    std::vector<uint32_t>               extArgs;
+    
+    const uint32_t* args() const {
+      return argCount <= MaxInlineArgs
+        ? inlineArgs.data()
+        : extArgs.data();
+    }
+    
+    bool eq(const SpirvTypeConstKey& other) const;
+    
+    size_t hash() const;
+  };
+  
+  struct SpirvTypeConstKeyHash {
+    size_t operator () (const SpirvTypeConstKey& key) const { return key.hash(); }
+  };
+  
+  struct SpirvTypeConstKeyEq {
+    bool operator () (const SpirvTypeConstKey& a, const SpirvTypeConstKey& b) const { return a.eq(b); }
+  };
+  
+  
   struct SpirvPhiLabel {
     uint32_t varId         = 0;
     uint32_t labelId       = 0;
@@ -1220,6 +1269,11 @@ namespace dxvk {
     SpirvCodeBuffer m_code;
 
     std::unordered_set<uint32_t> m_lateConsts;
+
+    std::unordered_map<
+      SpirvTypeConstKey, uint32_t,
+      SpirvTypeConstKeyHash,
+      SpirvTypeConstKeyEq> m_typeConstLookup;
     
     uint32_t defType(
             spv::Op                 op, 
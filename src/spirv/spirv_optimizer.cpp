@@ -0,0 +1,1153 @@
+#include <cmath>
+#include <cstring>
+
+#include "spirv_optimizer.h"
+
+namespace dxvk {
+
+  /**
+   * \brief Operand layout
+   *
+   * Describes which operands of an instruction, not
+   * counting the result type and result ID, are IDs.
+   */
+  enum class SpirvOperandLayout : uint32_t {
+    None,       ///< No ID operands
+    AllIds,     ///< All operands are IDs
+    FirstIds,   ///< First n operands are IDs, the rest are literals
+    SkipIds,    ///< First n operands are literals, the rest are IDs
+    LiteralIds, ///< First n operands are IDs, followed by one literal and more IDs
+    Switch,     ///< Selector and default IDs, followed by literal-label pairs
+    EntryPoint, ///< Literal, function ID, name, and interface IDs
+  };
+
+
+  enum class SpirvOpFlag : uint32_t {
+    Known       = 0, ///< Operand layout is known
+    HasType     = 1, ///< Instruction has a result type
+    HasResult   = 2, ///< Instruction has a result ID
+    Pure        = 3, ///< Can be removed if the result is unused
+    Annotation  = 4, ///< Debug info or decoration, does not use its target
+  };
+
+  using SpirvOpFlags = Flags<SpirvOpFlag>;
+
+
+  struct SpirvOpInfo {
+    SpirvOpFlags        flags;
+    SpirvOperandLayout  layout;
+    uint32_t            count;
+  };
+
+
+  static SpirvOpInfo getOpInfo(spv::Op op) {
+    using L = SpirvOperandLayout;
+    using F = SpirvOpFlag;
+
+    const SpirvOpFlags value(F::Known, F::HasType, F::HasResult, F::Pure);
+    const SpirvOpFlags type (F::Known, F::HasResult, F::Pure);
+    const SpirvOpFlags cnst (F::Known, F::HasType, F::HasResult, F::Pure);
+    const SpirvOpFlags call (F::Known, F::HasType, F::HasResult);
+    const SpirvOpFlags stmt (F::Known);
+    const SpirvOpFlags note (F::Known, F::Annotation);
+
+    switch (op) {
+      case spv::OpUndef:
+      case spv::OpConstantTrue:
+      case spv::OpConstantFalse:
+      case spv::OpConstant:
+      case spv::OpConstantNull:
+        return { cnst, L::None, 0 };
+
+      case spv::OpConstantComposite:
+        return { cnst, L::AllIds, 0 };
+
+      case spv::OpSpecConstantTrue:
+      case spv::OpSpecConstantFalse:
+      case spv::OpSpecConstant:
+        return { call, L::None, 0 };
+
+      case spv::OpSpecConstantComposite:
+        return { call, L::AllIds, 0 };
+
+      case spv::OpTypeVoid:
+      case spv::OpTypeBool:
+      case spv::OpTypeInt:
+      case spv::OpTypeFloat:
+      case spv::OpTypeSampler:
+        return { type, L::None, 0 };
+
+      case spv::OpTypeVector:
+      case spv::OpTypeMatrix:
+      case spv::OpTypeImage:
+        return { type, L::FirstIds, 1 };
+
+      case spv::OpTypeSampledImage:
+      case spv::OpTypeArray:
+      case spv::OpTypeRuntimeArray:
+      case spv::OpTypeStruct:
+      case spv::OpTypeFunction:
+        return { type, L::AllIds, 0 };
+
+      case spv::OpTypePointer:
+        return { type, L::SkipIds, 1 };
+
+      case spv::OpCapability:
+      case spv::OpExtension:
+      case spv::OpMemoryModel:
+      case spv::OpSource:
+      case spv::OpSourceExtension:
+      case spv::OpModuleProcessed:
+        return { stmt, L::None, 0 };
+
+      case spv::OpExtInstImport:
+      case spv::OpString:
+        return { SpirvOpFlags(F::Known, F::HasResult), L::None, 0 };
+
+      case spv::OpEntryPoint:
+        return { stmt, L::EntryPoint, 0 };
+
+      case spv::OpExecutionMode:
+        return { stmt, L::FirstIds, 1 };
+
+      case spv::OpName:
+      case spv::OpMemberName:
+      case spv::OpDecorate:
+      case spv::OpMemberDecorate:
+        return { note, L::FirstIds, 1 };
+
+      case spv::OpVariable:
+        // Purity depends on the storage class
+        return { call, L::SkipIds, 1 };
+
+      case spv::OpFunction:
+        return { call, L::SkipIds, 1 };
+
+      case spv::OpFunctionParameter:
+        return { call, L::None, 0 };
+
+      case spv::OpFunctionEnd:
+      case spv::OpReturn:
+      case spv::OpKill:
+      case spv::OpUnreachable:
+      case spv::OpDemoteToHelperInvocationEXT:
+      case spv::OpEmitVertex:
+      case spv::OpEndPrimitive:
+        return { stmt, L::None, 0 };
+
+      case spv::OpLabel:
+        return { SpirvOpFlags(F::Known, F::HasResult), L::None, 0 };
+
+      case spv::OpFunctionCall:
+        return { call, L::AllIds, 0 };
+
+      case spv::OpBranch:
+      case spv::OpReturnValue:
+      case spv::OpEmitStreamVertex:
+      case spv::OpEndStreamPrimitive:
+      case spv::OpControlBarrier:
+      case spv::OpMemoryBarrier:
+      case spv::OpAtomicStore:
+        return { stmt, L::AllIds, 0 };
+
+      case spv::OpBranchConditional:
+        return { stmt, L::FirstIds, 3 };
+
+      case spv::OpSelectionMerge:
+        return { stmt, L::FirstIds, 1 };
+
+      case spv::OpLoopMerge:
+        return { stmt, L::FirstIds, 2 };
+
+      case spv::OpSwitch:
+        return { stmt, L::Switch, 0 };
+
+      case spv::OpStore:
+        return { stmt, L::FirstIds, 2 };
+
+      case spv::OpImageWrite:
+        return { stmt, L::LiteralIds, 3 };
+
+      case spv::OpLoad:
+      case spv::OpCompositeExtract:
+      case spv::OpArrayLength:
+        return { value, L::FirstIds, 1 };
+
+      case spv::OpCompositeInsert:
+      case spv::OpVectorShuffle:
+        return { value, L::FirstIds, 2 };
+
+      case spv::OpExtInst:
+        return { value, L::LiteralIds, 1 };
+
+      case spv::OpImageSampleImplicitLod:
+      case spv::OpImageSampleExplicitLod:
+      case spv::OpImageSampleProjImplicitLod:
+      case spv::OpImageSampleProjExplicitLod:
+      case spv::OpImageFetch:
+      case spv::OpImageRead:
+        return { value, L::LiteralIds, 2 };
+
+      case spv::OpImageSampleDrefImplicitLod:
+      case spv::OpImageSampleDrefExplicitLod:
+      case spv::OpImageSampleProjDrefImplicitLod:
+      case spv::OpImageSampleProjDrefExplicitLod:
+      case spv::OpImageGather:
+      case spv::OpImageDrefGather:
+        return { value, L::LiteralIds, 3 };
+
+      case spv::OpAtomicLoad:
+      case spv::OpAtomicExchange:
+      case spv::OpAtomicCompareExchange:
+      case spv::OpAtomicIIncrement:
+      case spv::OpAtomicIDecrement:
+      case spv::OpAtomicIAdd:
+      case spv::OpAtomicISub:
+      case spv::OpAtomicSMin:
+      case spv::OpAtomicUMin:
+      case spv::OpAtomicSMax:
+      case spv::OpAtomicUMax:
+      case spv::OpAtomicAnd:
+      case spv::OpAtomicOr:
+      case spv::OpAtomicXor:
+      case spv::OpGroupNonUniformElect:
+      case spv::OpGroupNonUniformBallot:
+      case spv::OpGroupNonUniformBroadcastFirst:
+        return { call, L::AllIds, 0 };
+
+      case spv::OpGroupNonUniformBallotBitCount:
+        return { call, L::LiteralIds, 1 };
+
+      case spv::OpCopyObject:
+      case spv::OpConvertFToU:
+      case spv::OpConvertFToS:
+      case spv::OpConvertSToF:
+      case spv::OpConvertUToF:
+      case spv::OpUConvert:
+      case spv::OpSConvert:
+      case spv::OpFConvert:
+      case spv::OpBitcast:
+      case spv::OpSNegate:
+      case spv::OpFNegate:
+      case spv::OpIAdd:
+      case spv::OpFAdd:
+      case spv::OpISub:
+      case spv::OpFSub:
+      case spv::OpIMul:
+      case spv::OpFMul:
+      case spv::OpUDiv:
+      case spv::OpSDiv:
+      case spv::OpFDiv:
+      case spv::OpUMod:
+      case spv::OpSRem:
+      case spv::OpSMod:
+      case spv::OpFRem:
+      case spv::OpFMod:
+      case spv::OpVectorTimesScalar:
+      case spv::OpMatrixTimesScalar:
+      case spv::OpVectorTimesMatrix:
+      case spv::OpMatrixTimesVector:
+      case spv::OpMatrixTimesMatrix:
+      case spv::OpOuterProduct:
+      case spv::OpDot:
+      case spv::OpTranspose:
+      case spv::OpAny:
+      case spv::OpAll:
+      case spv::OpIsNan:
+      case spv::OpIsInf:
+      case spv::OpLogicalEqual:
+      case spv::OpLogicalNotEqual:
+      case spv::OpLogicalOr:
+      case spv::OpLogicalAnd:
+      case spv::OpLogicalNot:
+      case spv::OpSelect:
+      case spv::OpIEqual:
+      case spv::OpINotEqual:
+      case spv::OpUGreaterThan:
+      case spv::OpSGreaterThan:
+      case spv::OpUGreaterThanEqual:
+      case spv::OpSGreaterThanEqual:
+      case spv::OpULessThan:
+      case spv::OpSLessThan:
+      case spv::OpULessThanEqual:
+      case spv::OpSLessThanEqual:
+      case spv::OpFOrdEqual:
+      case spv::OpFUnordEqual:
+      case spv::OpFOrdNotEqual:
+      case spv::OpFUnordNotEqual:
+      case spv::OpFOrdLessThan:
+      case spv::OpFUnordLessThan:
+      case spv::OpFOrdGreaterThan:
+      case spv::OpFUnordGreaterThan:
+      case spv::OpFOrdLessThanEqual:
+      case spv::OpFUnordLessThanEqual:
+      case spv::OpFOrdGreaterThanEqual:
+      case spv::OpFUnordGreaterThanEqual:
+      case spv::OpShiftRightLogical:
+      case spv::OpShiftRightArithmetic:
+      case spv::OpShiftLeftLogical:
+      case spv::OpBitwiseOr:
+      case spv::OpBitwiseXor:
+      case spv::OpBitwiseAnd:
+      case spv::OpNot:
+      case spv::OpBitFieldInsert:
+      case spv::OpBitFieldSExtract:
+      case spv::OpBitFieldUExtract:
+      case spv::OpBitReverse:
+      case spv::OpBitCount:
+      case spv::OpDPdx:
+      case spv::OpDPdy:
+      case spv::OpFwidth:
+      case spv::OpDPdxFine:
+      case spv::OpDPdyFine:
+      case spv::OpFwidthFine:
+      case spv::OpDPdxCoarse:
+      case spv::OpDPdyCoarse:
+      case spv::OpFwidthCoarse:
+      case spv::OpVectorExtractDynamic:
+      case spv::OpVectorInsertDynamic:
+      case spv::OpCompositeConstruct:
+      case spv::OpAccessChain:
+      case spv::OpInBoundsAccessChain:
+      case spv::OpSampledImage:
+      case spv::OpImage:
+      case spv::OpImageQuerySizeLod:
+      case spv::OpImageQuerySize:
+      case spv::OpImageQueryLod:
+      case spv::OpImageQueryLevels:
+      case spv::OpImageQuerySamples:
+      case spv::OpImageTexelPointer:
+      case spv::OpPhi:
+        return { value, L::AllIds, 0 };
+
+      default:
+        return { SpirvOpFlags(), L::None, 0 };
+    }
+  }
+
+
+  static float    asFloat(uint32_t value) { float    f; std::memcpy(&f, &value, 4); return f; }
+  static uint32_t asUint (float    value) { uint32_t u; std::memcpy(&u, &value, 4); return u; }
+
+
+  static bool isFoldableFloat(float value) {
+    // Leave denormals and special values to the driver,
+    // since we do not know the device's float controls
+    return value == 0.0f || std::isnormal(value);
+  }
+
+
+  SpirvOptimizer::SpirvOptimizer(const SpirvCodeBuffer& code)
+  : m_code(code.data(), code.data() + code.dwords()) {
+    this->parse();
+  }
+
+
+  SpirvOptimizer::~SpirvOptimizer() {
+
+  }
+
+
+  void SpirvOptimizer::run() {
+    if (!m_valid)
+      return;
+
+    this->findSimpleVariables();
+    this->forwardStores();
+    this->foldConstants();
+    this->applyReplacements();
+    this->removeDeadStores();
+    this->removeDeadCode();
+    this->removeDeadAnnotations();
+  }
+
+
+  SpirvCodeBuffer SpirvOptimizer::getCode() const {
+    if (!m_valid)
+      return SpirvCodeBuffer(m_code.size(), m_code.data());
+
+    std::vector<uint32_t> code;
+    code.reserve(m_code.size() + m_newDecls.size());
+    code.insert(code.end(), m_code.begin(), m_code.begin() + 5);
+    code[3] = m_bound;
+
+    for (size_t i = 0; i <= m_ins.size(); i++) {
+      if (i == m_firstFunction) {
+        // Only emit constants that are still in use
+        for (size_t j = 0; j < m_newDecls.size(); ) {
+          uint32_t length = m_newDecls[j] >> spv::WordCountShift;
+
+          if (m_uses[m_newDecls[j + 2]])
+            code.insert(code.end(), &m_newDecls[j], &m_newDecls[j] + length);
+
+          j += length;
+        }
+      }
+
+      if (i < m_ins.size() && !m_ins[i].removed) {
+        const uint32_t* words = this->getWords(i);
+        code.insert(code.end(), words, words + m_ins[i].length);
+      }
+    }
+
+    return SpirvCodeBuffer(code.size(), code.data());
+  }
+
+
+  SpirvOptimizerStats SpirvOptimizer::getStats() const {
+    SpirvOptimizerStats stats;
+    stats.dwordsBefore       = m_code.size();
+    stats.instructionsBefore = m_ins.size();
+
+    if (!m_valid) {
+      stats.dwordsAfter       = stats.dwordsBefore;
+      stats.instructionsAfter = stats.instructionsBefore;
+      return stats;
+    }
+
+    stats.dwordsAfter = 5;
+
+    for (const auto& ins : m_ins) {
+      if (!ins.removed) {
+        stats.dwordsAfter       += ins.length;
+        stats.instructionsAfter += 1;
+      }
+    }
+
+    for (size_t j = 0; j < m_newDecls.size(); j += m_newDecls[j] >> spv::WordCountShift) {
+      if (m_uses[m_newDecls[j + 2]]) {
+        stats.dwordsAfter       += m_newDecls[j] >> spv::WordCountShift;
+        stats.instructionsAfter += 1;
+      }
+    }
+
+    return stats;
+  }
+
+
+  void SpirvOptimizer::parse() {
+    if (m_code.size() < 5 || m_code[0] != spv::MagicNumber)
+      return;
+
+    m_bound = m_code[3];
+
+    size_t offset = 5;
+
+    while (offset < m_code.size()) {
+      uint32_t length = m_code[offset] >> spv::WordCountShift;
+
+      if (!length || offset + length > m_code.size())
+        return;
+
+      m_ins.push_back({ uint32_t(offset), length, false });
+      offset += length;
+    }
+
+    m_defs      .resize(m_bound, 0);
+    m_replace   .resize(m_bound, 0);
+    m_pinned    .resize(m_bound, false);
+    m_simpleVars.resize(m_bound, false);
+    m_types     .resize(m_bound, { spv::OpNop, 0, false });
+    m_constants .resize(m_bound, { 0, 0, false });
+    m_uses      .resize(m_bound, 0);
+
+    m_firstFunction = m_ins.size();
+
+    for (size_t i = 0; i < m_ins.size(); i++) {
+      const uint32_t* words  = this->getWords(i);
+      const uint32_t  length = m_ins[i].length;
+
+      spv::Op     op   = this->getOp(i);
+      SpirvOpInfo info = getOpInfo(op);
+
+      if (op == spv::OpFunction && m_firstFunction == m_ins.size())
+        m_firstFunction = i;
+
+      if (!info.flags.test(SpirvOpFlag::Known)) {
+        // We cannot tell IDs and literals apart, so
+        // treat every word as a potential ID reference
+        for (uint32_t j = 1; j < length; j++) {
+          if (words[j] < m_bound)
+            m_pinned[words[j]] = true;
+        }
+
+        continue;
+      }
+
+      if (info.flags.test(SpirvOpFlag::HasResult)) {
+        uint32_t resultIndex = info.flags.test(SpirvOpFlag::HasType) ? 2 : 1;
+
+        if (resultIndex >= length || words[resultIndex] >= m_bound)
+          return;
+
+        m_defs[words[resultIndex]] = i + 1;
+      }
+
+      switch (op) {
+        case spv::OpTypeInt:
+          if (length >= 4)
+            m_types[words[1]] = { op, words[2], words[3] != 0 };
+          break;
+
+        case spv::OpTypeFloat:
+          if (length >= 3)
+            m_types[words[1]] = { op, words[2], false };
+          break;
+
+        case spv::OpTypeBool:
+          m_types[words[1]] = { op, 1, false };
+          break;
+
+        case spv::OpConstant:
+        case spv::OpConstantTrue:
+        case spv::OpConstantFalse: {
+          uint32_t value = 0;
+
+          if (words[1] >= m_bound)
+            break;
+
+          if (op == spv::OpConstant) {
+            // Only handle 32-bit scalar constants
+            if (length != 4)
+              break;
+
+            value = words[3];
+          } else {
+            value = op == spv::OpConstantTrue ? 1 : 0;
+          }
+
+          m_constants[words[2]] = { words[1], value, true };
+          m_constantLookup.insert({ (uint64_t(words[1]) << 32) | value, words[2] });
+        } break;
+
+        default:
+          break;
+      }
+    }
+
+    m_valid = true;
+  }
+
+
+  void SpirvOptimizer::findSimpleVariables() {
+    for (size_t i = 0; i < m_ins.size(); i++) {
+      const uint32_t* words = this->getWords(i);
+
+      if (this->getOp(i) == spv::OpVariable && m_ins[i].length >= 4) {
+        spv::StorageClass storage = spv::StorageClass(words[3]);
+
+        if (storage == spv::StorageClassFunction
+         || storage == spv::StorageClassPrivate)
+          m_simpleVars[words[2]] = true;
+      }
+    }
+
+    // A variable is only simple if it is accessed
+    // directly and exclusively via loads and stores
+    for (size_t i = 0; i < m_ins.size(); i++) {
+      spv::Op op     = this->getOp(i);
+      uint32_t length = m_ins[i].length;
+
+      SpirvOpInfo info = getOpInfo(op);
+
+      if (!info.flags.test(SpirvOpFlag::Known)) {
+        const uint32_t* words = this->getWords(i);
+
+        for (uint32_t j = 1; j < length; j++) {
+          if (words[j] < m_bound)
+            m_simpleVars[words[j]] = false;
+        }
+      } else if (!info.flags.test(SpirvOpFlag::Annotation)) {
+        this->forEachIdOperand(i, [&] (uint32_t& id, uint32_t index) {
+          bool isAccess = (op == spv::OpLoad  && index == 3 && length == 4)
+                       || (op == spv::OpStore && index == 1 && length == 3);
+
+          if (!isAccess)
+            m_simpleVars[id] = false;
+        });
+      }
+    }
+  }
+
+
+  void SpirvOptimizer::forwardStores() {
+    std::vector<KnownValue> values(m_bound, { 0, 0 });
+    uint32_t generation = 1;
+
+    for (size_t i = m_firstFunction; i < m_ins.size(); i++) {
+      uint32_t* words = this->getWords(i);
+
+      switch (this->getOp(i)) {
+        case spv::OpLabel:
+        case spv::OpFunctionCall:
+          // Start of a new block, or a function that
+          // might write any of the private variables
+          generation += 1;
+          break;
+
+        case spv::OpStore:
+          if (m_ins[i].length == 3 && words[1] < m_bound && m_simpleVars[words[1]])
+            values[words[1]] = { generation, this->resolve(words[2]) };
+          break;
+
+        case spv::OpLoad:
+          if (m_ins[i].length == 4 && words[3] < m_bound && m_simpleVars[words[3]]) {
+            KnownValue& value = values[words[3]];
+
+            if (value.generation == generation && value.valueId != words[2] && !m_pinned[words[2]]) {
+              m_replace[words[2]] = value.valueId;
+              m_ins[i].removed = true;
+            } else {
+              value = { generation, words[2] };
+            }
+          }
+          break;
+
+        default:
+          break;
+      }
+    }
+  }
+
+
+  void SpirvOptimizer::foldConstants() {
+    for (size_t i = m_firstFunction; i < m_ins.size(); i++) {
+      if (!m_ins[i].removed)
+        this->foldInstruction(i);
+    }
+  }
+
+
+  void SpirvOptimizer::applyReplacements() {
+    for (size_t i = 0; i < m_ins.size(); i++) {
+      if (m_ins[i].removed)
+        continue;
+
+      SpirvOpInfo info = getOpInfo(this->getOp(i));
+
+      if (info.flags.test(SpirvOpFlag::Known)
+      && !info.flags.test(SpirvOpFlag::Annotation)) {
+        this->forEachIdOperand(i, [this] (uint32_t& id, uint32_t) {
+          id = this->resolve(id);
+        });
+      }
+    }
+  }
+
+
+  void SpirvOptimizer::removeDeadStores() {
+    std::vector<bool> loaded(m_bound, false);
+
+    for (size_t i = m_firstFunction; i < m_ins.size(); i++) {
+      if (m_ins[i].removed || this->getOp(i) != spv::OpLoad || m_ins[i].length < 4)
+        continue;
+
+      uint32_t varId = this->getWords(i)[3];
+
+      if (varId < m_bound)
+        loaded[varId] = true;
+    }
+
+    for (size_t i = m_firstFunction; i < m_ins.size(); i++) {
+      if (m_ins[i].removed || this->getOp(i) != spv::OpStore || m_ins[i].length < 3)
+        continue;
+
+      uint32_t varId = this->getWords(i)[1];
+
+      if (varId < m_bound && m_simpleVars[varId] && !loaded[varId])
+        m_ins[i].removed = true;
+    }
+  }
+
+
+  void SpirvOptimizer::removeDeadCode() {
+    std::fill(m_uses.begin(), m_uses.end(), 0);
+    m_uses.resize(m_bound, 0);
+
+    for (size_t i = 0; i < m_ins.size(); i++) {
+      if (m_ins[i].removed)
+        continue;
+
+      SpirvOpInfo info = getOpInfo(this->getOp(i));
+
+      if (!info.flags.test(SpirvOpFlag::Known)) {
+        const uint32_t* words = this->getWords(i);
+
+        for (uint32_t j = 1; j < m_ins[i].length; j++) {
+          if (words[j] < m_bound)
+            m_uses[words[j]] += 1;
+        }
+      } else if (!info.flags.test(SpirvOpFlag::Annotation)) {
+        this->forEachIdOperand(i, [this] (uint32_t& id, uint32_t) {
+          m_uses[id] += 1;
+        });
+      }
+    }
+
+    // Constants created by the folding pass keep their
+    // types alive, even if they end up being unused
+    for (size_t j = 0; j < m_newDecls.size(); j += m_newDecls[j] >> spv::WordCountShift)
+      m_uses[m_newDecls[j + 1]] += 1;
+
+    auto isRemovable = [this] (size_t insId) {
+      SpirvOpInfo info = getOpInfo(this->getOp(insId));
+
+      if (m_ins[insId].removed || !info.flags.test(SpirvOpFlag::HasResult))
+        return false;
+
+      if (this->getOp(insId) == spv::OpVariable) {
+        spv::StorageClass storage = spv::StorageClass(this->getWords(insId)[3]);
+        return storage == spv::StorageClassFunction
+            || storage == spv::StorageClassPrivate;
+      }
+
+      return info.flags.test(SpirvOpFlag::Pure);
+    };
+
+    auto getResultId = [this] (size_t insId) {
+      SpirvOpInfo info = getOpInfo(this->getOp(insId));
+      return this->getWords(insId)[info.flags.test(SpirvOpFlag::HasType) ? 2 : 1];
+    };
+
+    std::vector<size_t> worklist;
+
+    for (size_t i = 0; i < m_ins.size(); i++) {
+      if (isRemovable(i) && !m_uses[getResultId(i)])
+        worklist.push_back(i);
+    }
+
+    while (!worklist.empty()) {
+      size_t insId = worklist.back();
+      worklist.pop_back();
+
+      if (m_ins[insId].removed)
+        continue;
+
+      m_ins[insId].removed = true;
+
+      this->forEachIdOperand(insId, [&] (uint32_t& id, uint32_t) {
+        if (--m_uses[id])
+          return;
+
+        uint32_t defId = m_defs[id];
+
+        if (defId && isRemovable(defId - 1))
+          worklist.push_back(defId - 1);
+      });
+    }
+  }
+
+
+  void SpirvOptimizer::removeDeadAnnotations() {
+    for (size_t i = 0; i < m_firstFunction; i++) {
+      SpirvOpInfo info = getOpInfo(this->getOp(i));
+
+      if (!m_ins[i].removed
+       && info.flags.test(SpirvOpFlag::Annotation)
+       && this->isRemoved(this->getWords(i)[1]))
+        m_ins[i].removed = true;
+    }
+  }
+
+
+  bool SpirvOptimizer::foldInstruction(size_t insId) {
+    const uint32_t* words  = this->getWords(insId);
+    const uint32_t  length = m_ins[insId].length;
+
+    spv::Op op = this->getOp(insId);
+
+    SpirvOpInfo info = getOpInfo(op);
+
+    if (!info.flags.test(SpirvOpFlag::HasType)
+     || !info.flags.test(SpirvOpFlag::Pure)
+     || length < 4 || m_pinned[words[2]])
+      return false;
+
+    uint32_t resultId = 0;
+
+    if (op == spv::OpSelect) {
+      uint32_t condId = this->resolve(words[3]);
+
+      if (!this->isConstant(condId) || m_types[m_constants[condId].typeId].op != spv::OpTypeBool)
+        return false;
+
+      resultId = this->resolve(m_constants[condId].value ? words[4] : words[5]);
+    } else if (op == spv::OpCompositeExtract) {
+      resultId = this->resolve(words[3]);
+
+      for (uint32_t i = 4; i < length; i++) {
+        uint32_t defId = resultId < m_bound ? m_defs[resultId] : 0;
+
+        if (!defId || this->getOp(defId - 1) != spv::OpConstantComposite)
+          return false;
+
+        const uint32_t* composite = this->getWords(defId - 1);
+
+        if (words[i] >= m_ins[defId - 1].length - 3)
+          return false;
+
+        resultId = this->resolve(composite[3 + words[i]]);
+      }
+    } else {
+      uint32_t value = 0;
+
+      if (!this->foldScalar(words, length, value))
+        return false;
+
+      resultId = this->getConstant(words[1], value);
+    }
+
+    if (resultId == words[2])
+      return false;
+
+    m_replace[words[2]] = resultId;
+    m_ins[insId].removed = true;
+    return true;
+  }
+
+
+  bool SpirvOptimizer::foldScalar(
+    const uint32_t*             ins,
+          uint32_t              length,
+          uint32_t&             result) const {
+    spv::Op op = spv::Op(ins[0] & spv::OpCodeMask);
+
+    if (ins[1] >= m_types.size())
+      return false;
+
+    ScalarType dstType = m_types[ins[1]];
+
+    // Only 32-bit scalars and booleans are folded, the
+    // arithmetic below does not handle any other widths
+    auto isFoldable = [] (const ScalarType& type) {
+      return type.op == spv::OpTypeBool
+         || (type.op != spv::OpNop && type.width == 32);
+    };
+
+    if (!isFoldable(dstType) || length > 5)
+      return false;
+
+    uint32_t   args[2]  = { 0, 0 };
+    ScalarType types[2] = { };
+
+    for (uint32_t i = 3; i < length; i++) {
+      uint32_t id = this->resolve(ins[i]);
+
+      if (!this->isConstant(id))
+        return false;
+
+      args [i - 3] = m_constants[id].value;
+      types[i - 3] = m_types[m_constants[id].typeId];
+
+      if (!isFoldable(types[i - 3]))
+        return false;
+    }
+
+    uint32_t argCount = length - 3;
+
+    bool isInt   = dstType .op == spv::OpTypeInt   && types[0].op == spv::OpTypeInt;
+    bool isFloat = dstType .op == spv::OpTypeFloat && types[0].op == spv::OpTypeFloat;
+    bool isBool  = dstType .op == spv::OpTypeBool;
+
+    uint32_t a = args[0];
+    uint32_t b = args[1];
+
+    switch (op) {
+      case spv::OpBitcast:
+        if (argCount != 1 || types[0].op == spv::OpTypeBool || dstType.op == spv::OpTypeBool)
+          return false;
+        result = a;
+        return true;
+
+      case spv::OpIAdd:       if (!isInt || argCount != 2) return false; result = a + b; return true;
+      case spv::OpISub:       if (!isInt || argCount != 2) return false; result = a - b; return true;
+      case spv::OpIMul:       if (!isInt || argCount != 2) return false; result = a * b; return true;
+      case spv::OpBitwiseAnd: if (!isInt || argCount != 2) return false; result = a & b; return true;
+      case spv::OpBitwiseOr:  if (!isInt || argCount != 2) return false; result = a | b; return true;
+      case spv::OpBitwiseXor: if (!isInt || argCount != 2) return false; result = a ^ b; return true;
+      case spv::OpNot:        if (!isInt || argCount != 1) return false; result = ~a;    return true;
+      case spv::OpSNegate:    if (!isInt || argCount != 1) return false; result = 0u - a; return true;
+
+      case spv::OpUDiv:
+      case spv::OpUMod:
+        if (!isInt || argCount != 2 || !b)
+          return false;
+        result = op == spv::OpUDiv ? a / b : a % b;
+        return true;
+
+      case spv::OpShiftLeftLogical:
+      case spv::OpShiftRightLogical:
+      case spv::OpShiftRightArithmetic:
+        // Shifting by the bit width or more is undefined
+        if (!isInt || argCount != 2 || b >= 32)
+          return false;
+
+        if (op == spv::OpShiftLeftLogical)
+          result = a << b;
+        else if (op == spv::OpShiftRightLogical)
+          result = a >> b;
+        else
+          result = uint32_t(int32_t(a) >> b);
+        return true;
+
+      case spv::OpFNegate:
+        if (!isFloat || argCount != 1)
+          return false;
+        result = a ^ 0x80000000u;
+        return true;
+
+      case spv::OpFAdd:
+      case spv::OpFSub:
+      case spv::OpFMul: {
+        if (!isFloat || argCount != 2)
+          return false;
+
+        float fa = asFloat(a);
+        float fb = asFloat(b);
+
+        float fr = op == spv::OpFAdd ? fa + fb
+                 : op == spv::OpFSub ? fa - fb
+                 :                     fa * fb;
+
+        if (!isFoldableFloat(fa) || !isFoldableFloat(fb) || !isFoldableFloat(fr))
+          return false;
+
+        result = asUint(fr);
+      } return true;
+
+      case spv::OpLogicalAnd:
+      case spv::OpLogicalOr:
+      case spv::OpLogicalEqual:
+      case spv::OpLogicalNotEqual:
+      case spv::OpLogicalNot:
+        if (!isBool || types[0].op != spv::OpTypeBool)
+          return false;
+
+        if (op == spv::OpLogicalNot) {
+          if (argCount != 1)
+            return false;
+          result = !a;
+        } else {
+          if (argCount != 2)
+            return false;
+          result = op == spv::OpLogicalAnd   ? (a && b)
+                 : op == spv::OpLogicalOr    ? (a || b)
+                 : op == spv::OpLogicalEqual ? (a == b)
+                 :                             (a != b);
+        }
+        return true;
+
+      case spv::OpIEqual:
+      case spv::OpINotEqual:
+      case spv::OpULessThan:
+      case spv::OpULessThanEqual:
+      case spv::OpUGreaterThan:
+      case spv::OpUGreaterThanEqual:
+      case spv::OpSLessThan:
+      case spv::OpSLessThanEqual:
+      case spv::OpSGreaterThan:
+      case spv::OpSGreaterThanEqual: {
+        if (!isBool || argCount != 2 || types[0].op != spv::OpTypeInt || types[1].op != spv::OpTypeInt)
+          return false;
+
+        int32_t sa = int32_t(a);
+        int32_t sb = int32_t(b);
+
+        switch (op) {
+          case spv::OpIEqual:             result = a == b; break;
+          case spv::OpINotEqual:          result = a != b; break;
+          case spv::OpULessThan:          result = a <  b; break;
+          case spv::OpULessThanEqual:     result = a <= b; break;
+          case spv::OpUGreaterThan:       result = a >  b; break;
+          case spv::OpUGreaterThanEqual:  result = a >= b; break;
+          case spv::OpSLessThan:          result = sa <  sb; break;
+          case spv::OpSLessThanEqual:     result = sa <= sb; break;
+          case spv::OpSGreaterThan:       result = sa >  sb; break;
+          case spv::OpSGreaterThanEqual:  result = sa >= sb; break;
+          default: return false;
+        }
+      } return true;
+
+      case spv::OpFOrdEqual:
+      case spv::OpFOrdNotEqual:
+      case spv::OpFOrdLessThan:
+      case spv::OpFOrdLessThanEqual:
+      case spv::OpFOrdGreaterThan:
+      case spv::OpFOrdGreaterThanEqual: {
+        if (!isBool || argCount != 2 || types[0].op != spv::OpTypeFloat || types[1].op != spv::OpTypeFloat)
+          return false;
+
+        float fa = asFloat(a);
+        float fb = asFloat(b);
+
+        if (std::isnan(fa) || std::isnan(fb)) {
+          result = 0;
+          return true;
+        }
+
+        switch (op) {
+          case spv::OpFOrdEqual:            result = fa == fb; break;
+          case spv::OpFOrdNotEqual:         result = fa != fb; break;
+          case spv::OpFOrdLessThan:         result = fa <  fb; break;
+          case spv::OpFOrdLessThanEqual:    result = fa <= fb; break;
+          case spv::OpFOrdGreaterThan:      result = fa >  fb; break;
+          case spv::OpFOrdGreaterThanEqual: result = fa >= fb; break;
+          default: return false;
+        }
+      } return true;
+
+      default:
+        return false;
+    }
+  }
+
+
+  uint32_t SpirvOptimizer::getConstant(
+          uint32_t              typeId,
+          uint32_t              value) {
+    uint64_t key = (uint64_t(typeId) << 32) | value;
+
+    auto entry = m_constantLookup.find(key);
+
+    if (entry != m_constantLookup.end())
+      return entry->second;
+
+    uint32_t id = m_bound++;
+
+    m_defs      .push_back(0);
+    m_replace   .push_back(0);
+    m_pinned    .push_back(false);
+    m_simpleVars.push_back(false);
+    m_types     .push_back({ spv::OpNop, 0, false });
+    m_constants .push_back({ typeId, value, true });
+
+    if (m_types[typeId].op == spv::OpTypeBool) {
+      spv::Op op = value ? spv::OpConstantTrue : spv::OpConstantFalse;
+      m_newDecls.insert(m_newDecls.end(), { op | (3u << spv::WordCountShift), typeId, id });
+    } else {
+      m_newDecls.insert(m_newDecls.end(), { spv::OpConstant | (4u << spv::WordCountShift), typeId, id, value });
+    }
+
+    m_constantLookup.insert({ key, id });
+    return id;
+  }
+
+
+  uint32_t SpirvOptimizer::resolve(
+          uint32_t              id) const {
+    while (id < m_replace.size() && m_replace[id])
+      id = m_replace[id];
+
+    return id;
+  }
+
+
+  bool SpirvOptimizer::isConstant(
+          uint32_t              id) const {
+    return id < m_constants.size() && m_constants[id].defined;
+  }
+
+
+  bool SpirvOptimizer::isRemoved(
+          uint32_t              id) const {
+    if (id >= m_defs.size() || !m_defs[id])
+      return false;
+
+    return m_ins[m_defs[id] - 1].removed;
+  }
+
+
+  spv::Op SpirvOptimizer::getOp(
+          size_t                insId) const {
+    return spv::Op(m_code[m_ins[insId].offset] & spv::OpCodeMask);
+  }
+
+
+  const uint32_t* SpirvOptimizer::getWords(
+          size_t                insId) const {
+    return &m_code[m_ins[insId].offset];
+  }
+
+
+  uint32_t* SpirvOptimizer::getWords(
+          size_t                insId) {
+    return &m_code[m_ins[insId].offset];
+  }
+
+
+  template<typename Fn>
+  void SpirvOptimizer::forEachIdOperand(
+          size_t                insId,
+          Fn&&                  fn) {
+    uint32_t* words  = this->getWords(insId);
+    uint32_t  length = m_ins[insId].length;
+
+    SpirvOpInfo info = getOpInfo(this->getOp(insId));
+
+    // Result types are IDs as well
+    uint32_t first = 1;
+
+    if (info.flags.test(SpirvOpFlag::HasType)) {
+      if (first < length && words[first] < m_bound)
+        fn(words[first], first);
+      first += 1;
+    }
+
+    if (info.flags.test(SpirvOpFlag::HasResult))
+      first += 1;
+
+    auto visit = [&] (uint32_t index) {
+      if (index < length && words[index] < m_bound)
+        fn(words[index], index);
+    };
+
+    switch (info.layout) {
+      case SpirvOperandLayout::None:
+        break;
+
+      case SpirvOperandLayout::AllIds:
+        for (uint32_t i = first; i < length; i++)
+          visit(i);
+        break;
+
+      case SpirvOperandLayout::FirstIds:
+        for (uint32_t i = first; i < first + info.count; i++)
+          visit(i);
+        break;
+
+      case SpirvOperandLayout::SkipIds:
+        for (uint32_t i = first + info.count; i < length; i++)
+          visit(i);
+        break;
+
+      case SpirvOperandLayout::LiteralIds:
+        for (uint32_t i = first; i < length; i++) {
+          if (i != first + info.count)
+            visit(i);
+        }
+        break;
+
+      case SpirvOperandLayout::Switch:
+        visit(first);
+        visit(first + 1);
+
+        for (uint32_t i = first + 3; i < length; i += 2)
+          visit(i);
+        break;
+
+      case SpirvOperandLayout::EntryPoint: {
+        visit(first + 1);
+
+        // Skip the null-terminated name string
+        uint32_t i = first + 2;
+
+        while (i < length && (words[i] & 0xFF000000u))
+          i += 1;
+
+        for (i += 1; i < length; i++)
+          visit(i);
+      } break;
+    }
+  }
+
+}
@@ -0,0 +1,166 @@
+#pragma once
+
+#include <unordered_map>
+#include <vector>
+
+#include "spirv_code_buffer.h"
+
+namespace dxvk {
+
+  /**
+   * \brief SPIR-V optimizer statistics
+   *
+   * Code size and instruction count of
+   * a module before and after optimization.
+   */
+  struct SpirvOptimizerStats {
+    uint32_t dwordsBefore       = 0;
+    uint32_t dwordsAfter        = 0;
+    uint32_t instructionsBefore = 0;
+    uint32_t instructionsAfter  = 0;
+  };
+
+
+  /**
+   * \brief SPIR-V optimizer
+   *
+   * Performs a few simple optimizations on the code
+   * generated by the shader compilers, so that drivers
+   * have less work to do when creating pipelines:
+   *
+   * - Forwards stored values to loads of private and
+   *   function variables within the same basic block,
+   *   if the variable is only ever loaded or stored.
+   * - Folds scalar operations on 32-bit constants, and
+   *   extracts from and selects on constant operands.
+   * - Removes stores to variables that are never read.
+   * - Removes unused instructions without side effects,
+   *   as well as unused types and constants.
+   *
+   * Instructions that the optimizer does not know are
+   * left untouched, and IDs they reference are never
+   * replaced or removed.
+   */
+  class SpirvOptimizer {
+
+  public:
+
+    SpirvOptimizer(const SpirvCodeBuffer& code);
+
+    ~SpirvOptimizer();
+
+    /**
+     * \brief Runs all optimization passes
+     */
+    void run();
+
+    /**
+     * \brief Retrieves optimized code
+     * \returns Optimized SPIR-V module
+     */
+    SpirvCodeBuffer getCode() const;
+
+    /**
+     * \brief Retrieves optimization statistics
+     * \returns Code size before and after
+     */
+    SpirvOptimizerStats getStats() const;
+
+  private:
+
+    struct Instruction {
+      uint32_t offset;
+      uint32_t length;
+      bool     removed;
+    };
+
+    struct ScalarType {
+      spv::Op  op;
+      uint32_t width;
+      bool     isSigned;
+    };
+
+    struct Constant {
+      uint32_t typeId;
+      uint32_t value;
+      bool     defined;
+    };
+
+    struct KnownValue {
+      uint32_t generation;
+      uint32_t valueId;
+    };
+
+    std::vector<uint32_t>     m_code;
+    std::vector<Instruction>  m_ins;
+
+    uint32_t                  m_bound         = 0;
+    size_t                    m_firstFunction = 0;
+    bool                      m_valid         = false;
+
+    std::vector<uint32_t>     m_defs;
+    std::vector<uint32_t>     m_replace;
+    std::vector<bool>         m_pinned;
+    std::vector<bool>         m_simpleVars;
+    std::vector<ScalarType>   m_types;
+    std::vector<Constant>     m_constants;
+    std::vector<uint32_t>     m_uses;
+
+    std::unordered_map<uint64_t, uint32_t> m_constantLookup;
+
+    std::vector<uint32_t>     m_newDecls;
+
+    void parse();
+
+    void findSimpleVariables();
+
+    void forwardStores();
+
+    void foldConstants();
+
+    void applyReplacements();
+
+    void removeDeadStores();
+
+    void removeDeadCode();
+
+    void removeDeadAnnotations();
+
+    bool foldInstruction(
+            size_t                insId);
+
+    bool foldScalar(
+      const uint32_t*             ins,
+            uint32_t              length,
+            uint32_t&             result) const;
+
+    uint32_t getConstant(
+            uint32_t              typeId,
+            uint32_t              value);
+
+    uint32_t resolve(
+            uint32_t              id) const;
+
+    bool isConstant(
+            uint32_t              id) const;
+
+    bool isRemoved(
+            uint32_t              id) const;
+
+    spv::Op getOp(
+            size_t                insId) const;
+
+    const uint32_t* getWords(
+            size_t                insId) const;
+
+    uint32_t*       getWords(
+            size_t                insId);
+
+    template<typename Fn>
+    void forEachIdOperand(
+            size_t                insId,
+            Fn&&                  fn);
+
+  };
+
+}
\ No newline at end of file
@@ -27,6 +27,14 @@ namespace dxvk {
       return --m_refCount;
     }
     
+    /**
+     * \brief Queries reference count
+     * \returns Current reference count
+     */
+    uint32_t getRefCount() const {
+      return m_refCount.load();
+    }
+    
   private:
     
     std::atomic<uint32_t> m_refCount = { 0u };
@@ -0,0 +1,79 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+
+#include "../util_bit.h"
+
+namespace dxvk::sync {
+
+  /**
+   * \brief Event count
+   *
+   * Notification primitive for lock-free data
+   * structures. Waiting threads spin on their
+   * condition for a short while before blocking,
+   * and notifying threads only take the lock if
+   * there actually is a blocked thread to wake up.
+   */
+  class EventCount {
+    constexpr static uint32_t SpinCount = 256;
+  public:
+
+    EventCount() { }
+    ~EventCount() { }
+
+    EventCount             (const EventCount&) = delete;
+    EventCount& operator = (const EventCount&) = delete;
+
+    /**
+     * \brief Waits for a condition
+     *
+     * Returns as soon as \c pred returns \c true. The
+     * predicate must only depend on atomic state that
+     * is modified before \ref notify is called.
+     * \param [in] pred Condition to wait for
+     */
+    template<typename Pred>
+    void wait(const Pred& pred) {
+      for (uint32_t i = 0; i < SpinCount; i++) {
+        if (likely(pred()))
+          return;
+
+        _mm_pause();
+      }
+
+      std::unique_lock<std::mutex> lock(m_mutex);
+      m_waiters.fetch_add(1, std::memory_order_relaxed);
+      std::atomic_thread_fence(std::memory_order_seq_cst);
+
+      m_cond.wait(lock, pred);
+      m_waiters.fetch_sub(1, std::memory_order_relaxed);
+    }
+
+    /**
+     * \brief Wakes up all waiting threads
+     *
+     * Must be called after the state that waiting
+     * threads depend on has been updated. Does not
+     * take the lock if no thread is blocked.
+     */
+    void notify() {
+      std::atomic_thread_fence(std::memory_order_seq_cst);
+
+      if (m_waiters.load(std::memory_order_relaxed)) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_cond.notify_all();
+      }
+    }
+
+  private:
+
+    std::atomic<uint32_t>   m_waiters = { 0u };
+    std::mutex              m_mutex;
+    std::condition_variable m_cond;
+
+  };
+
+}
@@ -1,5 +1,10 @@
 #include "util_matrix.h"
 
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#define DXVK_MATRIX_SSE
+#include <xmmintrin.h>
+#endif
+
 namespace dxvk {
 
   // Identity
@@ -57,9 +62,47 @@ namespace dxvk {
     return mat;
   }
 
+#ifdef DXVK_MATRIX_SSE
+  // Vector4 has no alignment guarantees, so we
+  // have to use unaligned loads and stores here
+  static inline __m128 loadVector(const Vector4& v) {
+    return _mm_loadu_ps(v.data);
+  }
+
+  static inline void storeVector(Vector4& dst, __m128 v) {
+    _mm_storeu_ps(dst.data, v);
+  }
+
+  template<int I>
+  static inline __m128 splatVector(__m128 v) {
+    return _mm_shuffle_ps(v, v, _MM_SHUFFLE(I, I, I, I));
+  }
+
+#endif
+
   Matrix4 Matrix4::operator*(const Matrix4& m2) const {
     const Matrix4& m1 = *this;
 
+#ifdef DXVK_MATRIX_SSE
+    const __m128 srcA0 = loadVector(m1[0]);
+    const __m128 srcA1 = loadVector(m1[1]);
+    const __m128 srcA2 = loadVector(m1[2]);
+    const __m128 srcA3 = loadVector(m1[3]);
+
+    Matrix4 result;
+
+    for (uint32_t i = 0; i < 4; i++) {
+      const __m128 srcB = loadVector(m2[i]);
+
+      __m128 sum = _mm_mul_ps(srcA0, splatVector<0>(srcB));
+      sum = _mm_add_ps(sum, _mm_mul_ps(srcA1, splatVector<1>(srcB)));
+      sum = _mm_add_ps(sum, _mm_mul_ps(srcA2, splatVector<2>(srcB)));
+      sum = _mm_add_ps(sum, _mm_mul_ps(srcA3, splatVector<3>(srcB)));
+      storeVector(result[i], sum);
+    }
+
+    return result;
+#else
     const Vector4 srcA0 = { m1[0] };
     const Vector4 srcA1 = { m1[1] };
     const Vector4 srcA2 = { m1[2] };
@@ -76,11 +119,26 @@ namespace dxvk {
     result[2] = srcA0 * srcB2[0] + srcA1 * srcB2[1] + srcA2 * srcB2[2] + srcA3 * srcB2[3];
     result[3] = srcA0 * srcB3[0] + srcA1 * srcB3[1] + srcA2 * srcB3[2] + srcA3 * srcB3[3];
     return result;
+#endif
   }
 
   Vector4 Matrix4::operator*(const Vector4& v) const {
     const Matrix4& m = *this;
 
+#ifdef DXVK_MATRIX_SSE
+    const __m128 src = loadVector(v);
+
+    const __m128 mul0 = _mm_mul_ps(loadVector(m[0]), splatVector<0>(src));
+    const __m128 mul1 = _mm_mul_ps(loadVector(m[1]), splatVector<1>(src));
+    const __m128 mul2 = _mm_mul_ps(loadVector(m[2]), splatVector<2>(src));
+    const __m128 mul3 = _mm_mul_ps(loadVector(m[3]), splatVector<3>(src));
+
+    Vector4 result;
+    storeVector(result, _mm_add_ps(
+      _mm_add_ps(mul0, mul1),
+      _mm_add_ps(mul2, mul3)));
+    return result;
+#else
     const Vector4 mul0 = { m[0] * v[0] };
     const Vector4 mul1 = { m[1] * v[1] };
     const Vector4 mul2 = { m[2] * v[2] };
@@ -90,6 +148,7 @@ namespace dxvk {
     const Vector4 add1 = { mul2 + mul3 };
 
     return add0 + add1;
+#endif
   }
 
   Matrix4 Matrix4::operator*(float scalar) const {
@@ -121,10 +180,24 @@ namespace dxvk {
   Matrix4 transpose(const Matrix4& m) {
     Matrix4 result;
 
+#ifdef DXVK_MATRIX_SSE
+    __m128 row0 = loadVector(m[0]);
+    __m128 row1 = loadVector(m[1]);
+    __m128 row2 = loadVector(m[2]);
+    __m128 row3 = loadVector(m[3]);
+
+    _MM_TRANSPOSE4_PS(row0, row1, row2, row3);
+
+    storeVector(result[0], row0);
+    storeVector(result[1], row1);
+    storeVector(result[2], row2);
+    storeVector(result[3], row3);
+#else
     for (uint32_t i = 0; i < 4; i++) {
       for (uint32_t j = 0; j < 4; j++)
         result[i][j] = m.data[j][i];
     }
+#endif
     return result;
   }
 
@@ -181,8 +254,80 @@ namespace dxvk {
     return (dot0.x + dot0.y) + (dot0.z + dot0.w);
   }
 
+#ifdef DXVK_MATRIX_SSE
+  // Computes one of the six 2x2 sub-determinant vectors used by
+  // the inverse, for columns A and B. Matches coefXX in the
+  // scalar version, i.e. lane 0 and 1 are rows 2 and 3, lane 2
+  // is rows 1 and 3, and lane 3 is rows 1 and 2.
+  template<int A, int B>
+  static inline __m128 inverseFactor(__m128 row1, __m128 row2, __m128 row3) {
+    __m128 swpA = _mm_shuffle_ps(row3, row2, _MM_SHUFFLE(A, A, A, A));
+    __m128 swpB = _mm_shuffle_ps(row3, row2, _MM_SHUFFLE(B, B, B, B));
+
+    __m128 vecA = _mm_shuffle_ps(row2, row1, _MM_SHUFFLE(A, A, A, A));
+    __m128 vecB = _mm_shuffle_ps(swpB, swpB, _MM_SHUFFLE(2, 0, 0, 0));
+    __m128 vecC = _mm_shuffle_ps(swpA, swpA, _MM_SHUFFLE(2, 0, 0, 0));
+    __m128 vecD = _mm_shuffle_ps(row2, row1, _MM_SHUFFLE(B, B, B, B));
+
+    return _mm_sub_ps(_mm_mul_ps(vecA, vecB), _mm_mul_ps(vecC, vecD));
+  }
+
+  // Returns { m[1][I], m[0][I], m[0][I], m[0][I] }
+  template<int I>
+  static inline __m128 inverseVector(__m128 row0, __m128 row1) {
+    __m128 tmp = _mm_shuffle_ps(row1, row0, _MM_SHUFFLE(I, I, I, I));
+    return _mm_shuffle_ps(tmp, tmp, _MM_SHUFFLE(2, 2, 2, 0));
+  }
+#endif
+
   Matrix4 inverse(const Matrix4& m)
   {
+#ifdef DXVK_MATRIX_SSE
+    // Same algorithm and order of operations as the
+    // scalar code below, so results are identical
+    __m128 row0 = loadVector(m[0]);
+    __m128 row1 = loadVector(m[1]);
+    __m128 row2 = loadVector(m[2]);
+    __m128 row3 = loadVector(m[3]);
+
+    __m128 fac0 = inverseFactor<2, 3>(row1, row2, row3);
+    __m128 fac1 = inverseFactor<1, 3>(row1, row2, row3);
+    __m128 fac2 = inverseFactor<1, 2>(row1, row2, row3);
+    __m128 fac3 = inverseFactor<0, 3>(row1, row2, row3);
+    __m128 fac4 = inverseFactor<0, 2>(row1, row2, row3);
+    __m128 fac5 = inverseFactor<0, 1>(row1, row2, row3);
+
+    __m128 vec0 = inverseVector<0>(row0, row1);
+    __m128 vec1 = inverseVector<1>(row0, row1);
+    __m128 vec2 = inverseVector<2>(row0, row1);
+    __m128 vec3 = inverseVector<3>(row0, row1);
+
+    __m128 signA = _mm_setr_ps(+1.0f, -1.0f, +1.0f, -1.0f);
+    __m128 signB = _mm_setr_ps(-1.0f, +1.0f, -1.0f, +1.0f);
+
+    __m128 inv0 = _mm_mul_ps(signA, _mm_add_ps(_mm_sub_ps(_mm_mul_ps(vec1, fac0), _mm_mul_ps(vec2, fac1)), _mm_mul_ps(vec3, fac2)));
+    __m128 inv1 = _mm_mul_ps(signB, _mm_add_ps(_mm_sub_ps(_mm_mul_ps(vec0, fac0), _mm_mul_ps(vec2, fac3)), _mm_mul_ps(vec3, fac4)));
+    __m128 inv2 = _mm_mul_ps(signA, _mm_add_ps(_mm_sub_ps(_mm_mul_ps(vec0, fac1), _mm_mul_ps(vec1, fac3)), _mm_mul_ps(vec3, fac5)));
+    __m128 inv3 = _mm_mul_ps(signB, _mm_add_ps(_mm_sub_ps(_mm_mul_ps(vec0, fac2), _mm_mul_ps(vec1, fac4)), _mm_mul_ps(vec2, fac5)));
+
+    // First column of the inverse, dotted with the first row
+    __m128 col01 = _mm_shuffle_ps(inv0, inv1, _MM_SHUFFLE(0, 0, 0, 0));
+    __m128 col23 = _mm_shuffle_ps(inv2, inv3, _MM_SHUFFLE(0, 0, 0, 0));
+    __m128 col0  = _mm_shuffle_ps(col01, col23, _MM_SHUFFLE(2, 0, 2, 0));
+
+    __m128 dot0 = _mm_mul_ps(row0, col0);
+    __m128 dot1 = _mm_add_ps(dot0, _mm_shuffle_ps(dot0, dot0, _MM_SHUFFLE(2, 3, 0, 1)));
+    __m128 dot2 = _mm_add_ss(dot1, _mm_movehl_ps(dot1, dot1));
+
+    __m128 rcp = _mm_div_ps(_mm_set1_ps(1.0f), splatVector<0>(dot2));
+
+    Matrix4 result;
+    storeVector(result[0], _mm_mul_ps(inv0, rcp));
+    storeVector(result[1], _mm_mul_ps(inv1, rcp));
+    storeVector(result[2], _mm_mul_ps(inv2, rcp));
+    storeVector(result[3], _mm_mul_ps(inv3, rcp));
+    return result;
+#else
     float coef00    = m[2][2] * m[3][3] - m[3][2] * m[2][3];
     float coef02    = m[1][2] * m[3][3] - m[3][2] * m[1][3];
     float coef03    = m[1][2] * m[2][3] - m[2][2] * m[1][3];
@@ -229,6 +374,7 @@ namespace dxvk {
     float dot1      = (dot0.x + dot0.y) + (dot0.z + dot0.w);
 
     return inverse * (1.0f / dot1);
+#endif
   }
 
   Matrix4 hadamardProduct(const Matrix4& a, const Matrix4& b) {
@@ -34,6 +34,11 @@ namespace dxvk::vk {
     m_device(device), m_owned(owned) { }
   
   
+  DeviceLoader::DeviceLoader(bool owned, VkDevice device, PFN_vkGetDeviceProcAddr getDeviceProcAddr)
+  : m_getDeviceProcAddr(getDeviceProcAddr),
+    m_device(device), m_owned(owned) { }
+  
+  
   PFN_vkVoidFunction DeviceLoader::sym(const char* name) const {
     return m_getDeviceProcAddr(m_device, name);
   }
@@ -53,6 +58,8 @@ namespace dxvk::vk {
   
   DeviceFn::DeviceFn(bool owned, VkInstance instance, VkDevice device)
   : DeviceLoader(owned, instance, device) { }
+  DeviceFn::DeviceFn(bool owned, VkDevice device, PFN_vkGetDeviceProcAddr getDeviceProcAddr)
+  : DeviceLoader(owned, device, getDeviceProcAddr) { }
   DeviceFn::~DeviceFn() {
     if (m_owned)
       this->vkDestroyDevice(m_device, nullptr);
@@ -42,6 +42,7 @@ namespace dxvk::vk {
    */
   struct DeviceLoader : public RcObject {
     DeviceLoader(bool owned, VkInstance instance, VkDevice device);
+    DeviceLoader(bool owned, VkDevice device, PFN_vkGetDeviceProcAddr getDeviceProcAddr);
     PFN_vkVoidFunction sym(const char* name) const;
     VkDevice device() const { return m_device; }
   protected:
@@ -156,6 +157,7 @@ namespace dxvk::vk {
    */
   struct DeviceFn : DeviceLoader {
     DeviceFn(bool owned, VkInstance instance, VkDevice device);
+    DeviceFn(bool owned, VkDevice device, PFN_vkGetDeviceProcAddr getDeviceProcAddr);
     ~DeviceFn();
     
     VULKAN_FN(vkDestroyDevice);
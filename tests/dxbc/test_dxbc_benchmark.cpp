@@ -0,0 +1,136 @@
+#include <iterator>
+#include <fstream>
+#include <sstream>
+
+#include "../../src/dxbc/dxbc_module.h"
+#include "../../src/dxvk/dxvk_shader.h"
+
+#include "../../src/util/util_time.h"
+
+#include <shellapi.h>
+#include <windows.h>
+#include <windowsx.h>
+
+namespace dxvk {
+  Logger Logger::s_instance("dxbc-benchmark.log");
+}
+
+using namespace dxvk;
+
+struct ShaderFile {
+  std::string       name;
+  std::vector<char> code;
+};
+
+Rc<DxbcShex> findShexChunk(const ShaderFile& file) {
+  DxbcReader reader(file.code.data(), file.code.size());
+  DxbcHeader header(reader);
+  
+  for (uint32_t i = 0; i < header.numChunks(); i++) {
+    auto chunkReader = reader.clone(header.chunkOffset(i));
+    auto tag         = chunkReader.readTag();
+    auto chunkLength = chunkReader.readu32();
+    
+    chunkReader = chunkReader.clone(8);
+    chunkReader = chunkReader.resize(chunkLength);
+    
+    if ((tag == "SHDR") || (tag == "SHEX"))
+      return new DxbcShex(chunkReader);
+  }
+  
+  throw DxvkError(str::format(file.name, ": No SHDR/SHEX chunk"));
+}
+
+int WINAPI WinMain(HINSTANCE hInstance,
+                   HINSTANCE hPrevInstance,
+                   LPSTR lpCmdLine,
+                   int nCmdShow) {
+  int     argc = 0;
+  LPWSTR* argv = CommandLineToArgvW(
+    GetCommandLineW(), &argc);  
+  
+  if (argc < 3) {
+    Logger::err("Usage: dxbc-benchmark iterations input1.dxbc [input2.dxbc ...]");
+    return 1;
+  }
+  
+  try {
+    uint32_t iterations = std::max(std::stoi(str::fromws(argv[1])), 1);
+    
+    std::vector<ShaderFile> shaders;
+    
+    for (int i = 2; i < argc; i++) {
+      ShaderFile file;
+      file.name = str::fromws(argv[i]);
+      
+      std::ifstream ifile(file.name, std::ios::binary);
+      ifile.ignore(std::numeric_limits<std::streamsize>::max());
+      std::streamsize length = ifile.gcount();
+      ifile.clear();
+      
+      ifile.seekg(0, std::ios_base::beg);
+      file.code.resize(length);
+      ifile.read(file.code.data(), length);
+      
+      shaders.push_back(std::move(file));
+    }
+    
+    DxbcModuleInfo moduleInfo;
+    moduleInfo.options.useSubgroupOpsForAtomicCounters = true;
+    moduleInfo.options.useDemoteToHelperInvocation = true;
+    moduleInfo.options.minSsboAlignment = 4;
+    moduleInfo.xfb = nullptr;
+    
+    auto totalTime  = std::chrono::microseconds(0);
+    auto decodeTime = std::chrono::microseconds(0);
+    
+    for (const auto& file : shaders) {
+      // Measure decoding separately, since the analyzer and
+      // the compiler both consume the decoded instructions
+      Rc<DxbcShex> shex = findShexChunk(file);
+      size_t insCount = 0;
+      
+      auto d0 = high_resolution_clock::now();
+      
+      for (uint32_t i = 0; i < iterations; i++) {
+        DxbcInstructionList instructions(shex->slice());
+        insCount = instructions.size();
+      }
+      
+      auto d1 = high_resolution_clock::now();
+      auto dd = std::chrono::duration_cast<std::chrono::microseconds>(d1 - d0);
+      decodeTime += dd;
+      
+      auto t0 = high_resolution_clock::now();
+      size_t codeSize = 0;
+      
+      for (uint32_t i = 0; i < iterations; i++) {
+        DxbcReader reader(file.code.data(), file.code.size());
+        DxbcModule module(reader);
+        
+        Rc<DxvkShader> shader = module.compile(moduleInfo, file.name);
+        
+        std::ostringstream stream;
+        shader->dump(stream);
+        codeSize = stream.str().size();
+      }
+      
+      auto t1 = high_resolution_clock::now();
+      auto td = std::chrono::duration_cast<std::chrono::microseconds>(t1 - t0);
+      totalTime += td;
+      
+      Logger::info(str::format(file.name, ": ",
+        td.count() / iterations, " us per iteration (",
+        dd.count() / iterations, " us decoding ", insCount, " instructions), ",
+        codeSize, " bytes of SPIR-V"));
+    }
+    
+    Logger::info(str::format("Total: ", totalTime.count() / iterations,
+      " us per iteration (", decodeTime.count() / iterations,
+      " us decoding) for ", shaders.size(), " shaders"));
+    return 0;
+  } catch (const DxvkError& e) {
+    Logger::err(e.message());
+    return 1;
+  }
+}
@@ -0,0 +1,308 @@
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+#include "../../src/dxbc/dxbc_module.h"
+#include "../../src/dxso/dxso_module.h"
+#include "../../src/dxso/dxso_modinfo.h"
+#include "../../src/dxvk/dxvk_shader.h"
+
+#include "../../src/util/thread.h"
+#include "../../src/util/util_time.h"
+
+#include <windows.h>
+#include <psapi.h>
+
+namespace dxvk {
+  Logger Logger::s_instance("shader-batch.log");
+}
+
+using namespace dxvk;
+
+enum class ShaderFileType {
+  Dxbc,
+  Dxso,
+};
+
+struct ShaderFile {
+  std::string       name;
+  ShaderFileType    type;
+  std::vector<char> code;
+};
+
+// Comment tokens store their length in 15 bits, which
+// is more than any other instruction can consume
+constexpr uint32_t DxsoEndToken         = 0x0000FFFF;
+constexpr uint32_t DxsoMaxSkippedTokens = 0x8000 + 16;
+
+struct ShaderResult {
+  uint64_t          timeUs    = 0;
+  size_t            spirvSize = 0;
+  std::string       error;
+};
+
+
+std::vector<ShaderFile> loadShaders(const std::string& dir) {
+  std::vector<ShaderFile> files;
+
+  WIN32_FIND_DATAA findData;
+  HANDLE findHandle = FindFirstFileA(str::format(dir, "/*").c_str(), &findData);
+
+  if (findHandle == INVALID_HANDLE_VALUE)
+    throw DxvkError(str::format("Failed to open directory ", dir));
+
+  do {
+    if (findData.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY)
+      continue;
+
+    std::string name = findData.cFileName;
+    ShaderFile file;
+
+    auto hasExt = [&name] (const char* ext) {
+      size_t len = std::strlen(ext);
+      return name.size() > len && !name.compare(name.size() - len, len, ext);
+    };
+
+    if (hasExt(".dxbc"))
+      file.type = ShaderFileType::Dxbc;
+    else if (hasExt(".dxso"))
+      file.type = ShaderFileType::Dxso;
+    else
+      continue;
+
+    std::ifstream ifile(str::format(dir, "/", name), std::ios::binary);
+    ifile.ignore(std::numeric_limits<std::streamsize>::max());
+    std::streamsize length = ifile.gcount();
+    ifile.clear();
+
+    ifile.seekg(0, std::ios_base::beg);
+    file.code.resize(length);
+    ifile.read(file.code.data(), length);
+
+    file.name = std::move(name);
+    files.push_back(std::move(file));
+  } while (FindNextFileA(findHandle, &findData));
+
+  FindClose(findHandle);
+
+  std::sort(files.begin(), files.end(),
+    [] (const ShaderFile& a, const ShaderFile& b) {
+      return a.name < b.name;
+    });
+
+  return files;
+}
+
+
+DxsoModuleInfo getDxsoModuleInfo() {
+  DxsoModuleInfo moduleInfo;
+  moduleInfo.options.useDemoteToHelperInvocation   = true;
+  moduleInfo.options.useSubgroupOpsForEarlyDiscard = true;
+  moduleInfo.options.strictConstantCopies          = false;
+  moduleInfo.options.d3d9FloatEmulation            = true;
+  moduleInfo.options.strictPow                     = true;
+  moduleInfo.options.shaderModel                   = 3;
+  moduleInfo.options.invariantPosition             = false;
+  return moduleInfo;
+}
+
+
+DxbcModuleInfo getDxbcModuleInfo() {
+  DxbcModuleInfo moduleInfo;
+  moduleInfo.options.useSubgroupOpsForAtomicCounters = true;
+  moduleInfo.options.useDemoteToHelperInvocation     = true;
+  moduleInfo.options.useSubgroupOpsForEarlyDiscard   = true;
+  moduleInfo.options.minSsboAlignment                = 4;
+  moduleInfo.tess = nullptr;
+  moduleInfo.xfb  = nullptr;
+  return moduleInfo;
+}
+
+
+D3D9ConstantLayout getDxsoConstantLayout(DxsoProgramType type) {
+  // Matches the hardware vertex processing
+  // layout used by the D3D9 device
+  D3D9ConstantLayout layout;
+  layout.floatCount   = type == DxsoProgramTypes::VertexShader ? 256 : 224;
+  layout.intCount     = 16;
+  layout.boolCount    = 16;
+  layout.bitmaskCount = 1;
+  return layout;
+}
+
+
+size_t getSpirvSize(const Rc<DxvkShader>& shader) {
+  if (shader == nullptr)
+    return 0;
+
+  std::ostringstream stream;
+  shader->dump(stream);
+  return stream.str().size();
+}
+
+
+ShaderResult translateShader(const ShaderFile& file) {
+  ShaderResult result;
+
+  auto t0 = high_resolution_clock::now();
+
+  try {
+    std::vector<Rc<DxvkShader>> shaders;
+
+    if (file.type == ShaderFileType::Dxbc) {
+      DxbcReader reader(file.code.data(), file.code.size());
+      DxbcModule module(reader);
+
+      shaders.push_back(module.compile(getDxbcModuleInfo(), file.name));
+    } else {
+      // The DXSO reader is not bounded, so copy the bytecode into
+      // a buffer that is padded with end tokens. A truncated file
+      // will then always hit an end token instead of reading past
+      // the buffer, since no instruction or comment skips more
+      // tokens than the padding contains.
+      std::vector<uint32_t> code((file.code.size() + 3) / 4
+        + DxsoMaxSkippedTokens, DxsoEndToken);
+      std::memcpy(code.data(), file.code.data(), file.code.size());
+
+      DxsoReader reader(reinterpret_cast<const char*>(code.data()));
+      DxsoModule module(reader);
+
+      DxsoAnalysisInfo analysis = module.analyze();
+
+      if (analysis.bytecodeByteLength > file.code.size())
+        throw DxvkError("Shader bytecode exceeds file size");
+
+      auto permutations = module.compile(getDxsoModuleInfo(), file.name,
+        analysis, getDxsoConstantLayout(module.info().type()));
+
+      shaders.insert(shaders.end(), permutations.begin(), permutations.end());
+    }
+
+    auto t1 = high_resolution_clock::now();
+    result.timeUs = std::chrono::duration_cast<std::chrono::microseconds>(t1 - t0).count();
+
+    for (const auto& shader : shaders)
+      result.spirvSize += getSpirvSize(shader);
+  } catch (const DxvkError& e) {
+    result.error = e.message();
+  }
+
+  return result;
+}
+
+
+std::string escapeJson(const std::string& str) {
+  std::string result;
+
+  for (char c : str) {
+    if (c == '"' || c == '\\')
+      result.push_back('\\');
+
+    if (uint8_t(c) >= 0x20)
+      result.push_back(c);
+  }
+
+  return result;
+}
+
+
+int main(int argc, char** argv) {
+  uint32_t    threadCount = dxvk::thread::hardware_concurrency();
+  std::string outputName;
+  std::string inputDir;
+
+  for (int i = 1; i < argc; i++) {
+    std::string arg = argv[i];
+
+    if (arg == "-j" && i + 1 < argc)
+      threadCount = std::max(std::stoi(argv[++i]), 1);
+    else if (arg == "-o" && i + 1 < argc)
+      outputName = argv[++i];
+    else
+      inputDir = arg;
+  }
+
+  if (inputDir.empty()) {
+    std::cerr << "Usage: shader-batch [-j threads] [-o output.json] directory" << std::endl;
+    return 1;
+  }
+
+  try {
+    std::vector<ShaderFile>   files = loadShaders(inputDir);
+    std::vector<ShaderResult> results(files.size());
+
+    std::atomic<size_t> nextFile = { 0 };
+
+    auto t0 = high_resolution_clock::now();
+
+    std::vector<dxvk::thread> threads;
+
+    for (uint32_t i = 0; i < std::max(threadCount, 1u); i++) {
+      threads.emplace_back([&] {
+        size_t index;
+
+        while ((index = nextFile++) < files.size())
+          results[index] = translateShader(files[index]);
+      });
+    }
+
+    for (auto& t : threads)
+      t.join();
+
+    auto t1 = high_resolution_clock::now();
+    auto wallTimeUs = std::chrono::duration_cast<std::chrono::microseconds>(t1 - t0).count();
+
+    PROCESS_MEMORY_COUNTERS memCounters = { };
+    memCounters.cb = sizeof(memCounters);
+    GetProcessMemoryInfo(GetCurrentProcess(), &memCounters, sizeof(memCounters));
+
+    uint64_t totalTimeUs    = 0;
+    size_t   totalSpirvSize = 0;
+    uint32_t failedCount    = 0;
+
+    std::stringstream json;
+    json << "{\n  \"shaders\": [";
+
+    for (size_t i = 0; i < files.size(); i++) {
+      totalTimeUs    += results[i].timeUs;
+      totalSpirvSize += results[i].spirvSize;
+
+      json << (i ? ",\n" : "\n")
+           << "    { \"name\": \"" << escapeJson(files[i].name) << "\""
+           << ", \"type\": \"" << (files[i].type == ShaderFileType::Dxbc ? "dxbc" : "dxso") << "\""
+           << ", \"inputSize\": " << files[i].code.size()
+           << ", \"spirvSize\": " << results[i].spirvSize
+           << ", \"timeUs\": " << results[i].timeUs;
+
+      if (!results[i].error.empty()) {
+        json << ", \"error\": \"" << escapeJson(results[i].error) << "\"";
+        failedCount += 1;
+      }
+
+      json << " }";
+    }
+
+    json << "\n  ],\n"
+         << "  \"threads\": " << threadCount << ",\n"
+         << "  \"shaderCount\": " << files.size() << ",\n"
+         << "  \"failedCount\": " << failedCount << ",\n"
+         << "  \"totalTimeUs\": " << totalTimeUs << ",\n"
+         << "  \"wallTimeUs\": " << wallTimeUs << ",\n"
+         << "  \"spirvSize\": " << totalSpirvSize << ",\n"
+         << "  \"peakMemory\": " << memCounters.PeakWorkingSetSize << "\n"
+         << "}\n";
+
+    if (!outputName.empty())
+      std::ofstream(outputName, std::ios::trunc) << json.str();
+    else
+      std::cout << json.str();
+
+    return failedCount ? 2 : 0;
+  } catch (const DxvkError& e) {
+    std::cerr << e.message() << std::endl;
+    return 1;
+  }
+}
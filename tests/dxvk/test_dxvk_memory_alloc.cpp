@@ -0,0 +1,341 @@
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <unordered_map>
+
+#include "../../src/dxvk/dxvk_memory.h"
+
+#include "../../src/util/thread.h"
+#include "../../src/util/util_time.h"
+
+#include <shellapi.h>
+#include <windows.h>
+#include <windowsx.h>
+
+namespace dxvk {
+  Logger Logger::s_instance("dxvk-memory-alloc.log");
+}
+
+using namespace dxvk;
+
+// Stands in for the Vulkan device so that the real memory
+// allocator can be stressed without a driver. Hands out
+// unique memory handles and remembers their sizes.
+struct StubDevice {
+  std::mutex                              mutex;
+  std::unordered_map<uint64_t, VkDeviceSize> objects;
+
+  uint64_t                                nextHandle = 0;
+  uint64_t                                allocCount = 0;
+  VkDeviceSize                            allocBytes = 0;
+  uint32_t                                errorCount = 0;
+};
+
+static StubDevice g_device;
+
+
+static uint64_t getHandleId(VkDeviceMemory memory) {
+  uint64_t id = 0;
+  std::memcpy(&id, &memory, sizeof(memory));
+  return id;
+}
+
+
+static VkDeviceMemory getHandle(uint64_t id) {
+  VkDeviceMemory memory = VK_NULL_HANDLE;
+  std::memcpy(&memory, &id, sizeof(memory));
+  return memory;
+}
+
+
+VKAPI_ATTR VkResult VKAPI_CALL stubAllocateMemory(
+        VkDevice                    device,
+  const VkMemoryAllocateInfo*       pAllocateInfo,
+  const VkAllocationCallbacks*      pAllocator,
+        VkDeviceMemory*             pMemory) {
+  std::lock_guard<std::mutex> lock(g_device.mutex);
+
+  uint64_t id = ++g_device.nextHandle;
+  g_device.objects.insert({ id, pAllocateInfo->allocationSize });
+  g_device.allocCount += 1;
+  g_device.allocBytes += pAllocateInfo->allocationSize;
+
+  *pMemory = getHandle(id);
+  return VK_SUCCESS;
+}
+
+
+VKAPI_ATTR void VKAPI_CALL stubFreeMemory(
+        VkDevice                    device,
+        VkDeviceMemory              memory,
+  const VkAllocationCallbacks*      pAllocator) {
+  std::lock_guard<std::mutex> lock(g_device.mutex);
+
+  if (!g_device.objects.erase(getHandleId(memory))) {
+    Logger::err("Freed unknown memory object");
+    g_device.errorCount += 1;
+  }
+}
+
+
+VKAPI_ATTR PFN_vkVoidFunction VKAPI_CALL stubGetDeviceProcAddr(
+        VkDevice                    device,
+  const char*                       pName) {
+  if (!std::strcmp(pName, "vkAllocateMemory"))
+    return reinterpret_cast<PFN_vkVoidFunction>(&stubAllocateMemory);
+
+  if (!std::strcmp(pName, "vkFreeMemory"))
+    return reinterpret_cast<PFN_vkVoidFunction>(&stubFreeMemory);
+
+  return nullptr;
+}
+
+
+struct Range {
+  uint64_t      memory;
+  VkDeviceSize  offset;
+  VkDeviceSize  length;
+};
+
+
+constexpr uint32_t MemoryTypeCount = 4;
+
+
+static DxvkMemoryAllocator* createAllocator() {
+  Rc<vk::DeviceFn> vkd = new vk::DeviceFn(
+    false, VK_NULL_HANDLE, &stubGetDeviceProcAddr);
+
+  VkPhysicalDeviceProperties devProps = { };
+  devProps.limits.bufferImageGranularity = 1024;
+
+  VkPhysicalDeviceMemoryProperties memProps = { };
+  memProps.memoryHeapCount = 1;
+  memProps.memoryHeaps[0].size  = VkDeviceSize(64) << 30;
+  memProps.memoryHeaps[0].flags = VK_MEMORY_HEAP_DEVICE_LOCAL_BIT;
+  memProps.memoryTypeCount = MemoryTypeCount;
+
+  for (uint32_t i = 0; i < MemoryTypeCount; i++) {
+    memProps.memoryTypes[i].propertyFlags = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT;
+    memProps.memoryTypes[i].heapIndex     = 0;
+  }
+
+  return new DxvkMemoryAllocator(vkd, devProps, memProps);
+}
+
+
+static DxvkMemory allocMemory(
+        DxvkMemoryAllocator&        allocator,
+        VkDeviceSize                size,
+        VkDeviceSize                align,
+        uint32_t                    typeBits,
+        float                       priority) {
+  VkMemoryRequirements req;
+  req.size            = size;
+  req.alignment       = align;
+  req.memoryTypeBits  = typeBits;
+
+  VkMemoryDedicatedRequirements dedReq = { };
+  dedReq.sType = VK_STRUCTURE_TYPE_MEMORY_DEDICATED_REQUIREMENTS;
+
+  VkMemoryDedicatedAllocateInfoKHR dedInfo = { };
+  dedInfo.sType = VK_STRUCTURE_TYPE_MEMORY_DEDICATED_ALLOCATE_INFO;
+
+  return allocator.alloc(&req, dedReq, dedInfo,
+    VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, priority);
+}
+
+
+static uint32_t checkRanges(std::vector<Range>& ranges) {
+  uint32_t errors = 0;
+
+  std::sort(ranges.begin(), ranges.end(),
+    [] (const Range& a, const Range& b) {
+      return a.memory < b.memory
+         || (a.memory == b.memory && a.offset < b.offset);
+    });
+
+  std::lock_guard<std::mutex> lock(g_device.mutex);
+
+  for (size_t i = 0; i < ranges.size(); i++) {
+    const Range& r = ranges[i];
+    auto object = g_device.objects.find(r.memory);
+
+    if (object == g_device.objects.end()) {
+      Logger::err(str::format("Range in unknown memory object ", r.memory));
+      errors += 1;
+    } else if (r.offset + r.length > object->second) {
+      Logger::err(str::format("Range ", r.offset, ":", r.length,
+        " exceeds memory object of size ", object->second));
+      errors += 1;
+    }
+
+    if (i > 0) {
+      const Range& p = ranges[i - 1];
+
+      if (p.memory == r.memory && p.offset + p.length > r.offset) {
+        Logger::err(str::format("Ranges ", p.offset, ":", p.length,
+          " and ", r.offset, ":", r.length, " overlap"));
+        errors += 1;
+      }
+    }
+  }
+
+  return errors;
+}
+
+
+static uint32_t runExactFitTest() {
+  std::unique_ptr<DxvkMemoryAllocator> allocator(createAllocator());
+
+  const VkDeviceSize size = 64 << 10;
+
+  DxvkMemory a = allocMemory(*allocator, size, size, 1, 0.0f);
+  DxvkMemory b = allocMemory(*allocator, size, size, 1, 0.0f);
+  DxvkMemory c = allocMemory(*allocator, size, size, 1, 0.0f);
+
+  VkDeviceSize offset = b.offset();
+  b = DxvkMemory();
+
+  // A hole that exactly fits an aligned allocation
+  // must be reused instead of splitting a new block
+  DxvkMemory d = allocMemory(*allocator, size, size, 1, 0.0f);
+
+  if (d.memory() != a.memory() || d.offset() != offset) {
+    Logger::err(str::format("Exact fit: Expected offset ", offset, ", got ", d.offset()));
+    return 1;
+  }
+
+  return 0;
+}
+
+
+static void runThread(
+        DxvkMemoryAllocator&        allocator,
+        std::vector<DxvkMemory>&    live,
+        std::atomic<uint32_t>&      errors,
+        uint32_t                    seed,
+        uint32_t                    iterations) {
+  std::mt19937 rng(seed);
+
+  for (uint32_t i = 0; i < iterations; i++) {
+    // Keep a few thousand allocations alive to fragment
+    // the chunks, similar to streaming resource loads
+    if (live.size() < 4096 || (rng() & 1)) {
+      VkDeviceSize size  = VkDeviceSize(256 + rng() % (1 << 18));
+      VkDeviceSize align = VkDeviceSize(256) << (rng() % 5);
+
+      uint32_t typeBits = 1u << (rng() % MemoryTypeCount);
+      float    priority = (rng() & 1) ? 0.5f : 0.0f;
+
+      DxvkMemory memory = allocMemory(allocator, size, align, typeBits, priority);
+
+      if (memory.offset() % align || memory.length() < size)
+        errors += 1;
+
+      live.push_back(std::move(memory));
+    } else {
+      size_t index = rng() % live.size();
+
+      if (index + 1 != live.size())
+        live[index] = std::move(live.back());
+
+      live.pop_back();
+    }
+  }
+}
+
+
+static uint32_t runStressTest(
+        uint32_t                    threadCount,
+        uint32_t                    iterations) {
+  std::unique_ptr<DxvkMemoryAllocator> allocator(createAllocator());
+
+  std::vector<std::vector<DxvkMemory>> live(threadCount);
+  std::vector<dxvk::thread> threads;
+  std::atomic<uint32_t> errors = { 0u };
+
+  auto t0 = high_resolution_clock::now();
+
+  for (uint32_t i = 0; i < threadCount; i++) {
+    threads.emplace_back([&allocator, &live, &errors, i, iterations] {
+      runThread(*allocator, live[i], errors, i + 1, iterations);
+    });
+  }
+
+  for (auto& t : threads)
+    t.join();
+
+  auto t1 = high_resolution_clock::now();
+  auto td = std::chrono::duration_cast<std::chrono::microseconds>(t1 - t0);
+
+  if (errors.load())
+    Logger::err(str::format(errors.load(), " allocations were misaligned or too small"));
+
+  // All allocations that are still alive
+  // must be disjoint within their memory
+  std::vector<Range> ranges;
+
+  for (const auto& list : live) {
+    for (const auto& memory : list)
+      ranges.push_back({ getHandleId(memory.memory()), memory.offset(), memory.length() });
+  }
+
+  errors += checkRanges(ranges);
+  live.clear();
+
+  if (allocator->getMemoryStats(0).memoryUsed != 0) {
+    Logger::err("Memory still in use after freeing all allocations");
+    errors += 1;
+  }
+
+  uint64_t opCount = uint64_t(threadCount) * iterations;
+
+  Logger::info(str::format("Stress test: ",
+    td.count() / 1000, " ms, ",
+    (td.count() * 1000) / opCount, " ns per operation, ",
+    g_device.allocCount, " chunks (",
+    g_device.allocBytes >> 20, " MB) allocated"));
+
+  return errors.load();
+}
+
+
+int WINAPI WinMain(HINSTANCE hInstance,
+                   HINSTANCE hPrevInstance,
+                   LPSTR lpCmdLine,
+                   int nCmdShow) {
+  int     argc = 0;
+  LPWSTR* argv = CommandLineToArgvW(
+    GetCommandLineW(), &argc);
+
+  uint32_t iterations  = 1000000;
+  uint32_t threadCount = 4;
+
+  if (argc > 1) iterations  = std::max(std::stoi(str::fromws(argv[1])), 1);
+  if (argc > 2) threadCount = std::max(std::stoi(str::fromws(argv[2])), 1);
+
+  Logger::info(str::format("Running ", iterations, " operations on ",
+    threadCount, " threads, ", MemoryTypeCount, " memory types"));
+
+  uint32_t errors = runExactFitTest()
+                  + runStressTest(threadCount, iterations);
+
+  // All chunks are freed along with the allocator
+  if (!g_device.objects.empty()) {
+    Logger::err(str::format(g_device.objects.size(), " memory objects leaked"));
+    errors += 1;
+  }
+
+  errors += g_device.errorCount;
+
+  if (errors) {
+    Logger::err(str::format("Memory allocator test failed with ", errors, " errors"));
+    return 1;
+  }
+
+  Logger::info("Memory allocator test passed");
+  return 0;
+}
@@ -0,0 +1,183 @@
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <unordered_map>
+
+#include "../../src/dxvk/dxvk_state_cache.h"
+
+namespace dxvk {
+  Logger Logger::s_instance("dxvk-cache-merge.log");
+}
+
+using namespace dxvk;
+
+struct CacheFileStats {
+  std::string name;
+  uint32_t    version    = 0;
+  size_t      fileSize   = 0;
+  uint32_t    numEntries = 0;
+  uint32_t    numInvalid = 0;
+  bool        supported  = false;
+};
+
+
+size_t getFileSize(const std::string& name) {
+  std::ifstream file(name, std::ios_base::binary | std::ios_base::ate);
+  return file ? size_t(file.tellg()) : 0;
+}
+
+
+bool isSameEntry(
+  const DxvkStateCacheEntry&  a,
+  const DxvkStateCacheEntry&  b) {
+  static const DxvkShaderKey nullShaderKey;
+
+  return a.shaders.cs.eq(nullShaderKey)
+    ? a.format.eq(b.format) && a.gpState == b.gpState
+    : a.cpState == b.cpState;
+}
+
+
+bool readCacheFile(
+        CacheFileStats&                   stats,
+        std::vector<DxvkStateCacheEntry>& entries) {
+  std::ifstream file(stats.name, std::ios_base::binary);
+  stats.fileSize = getFileSize(stats.name);
+
+  DxvkStateCacheHeader header;
+
+  if (!file || !DxvkStateCache::readCacheHeader(file, header)
+   || !DxvkStateCache::checkCacheHeader(header))
+    return false;
+
+  stats.version   = header.version;
+  stats.supported = true;
+
+  while (file) {
+    DxvkStateCacheEntry entry;
+
+    if (DxvkStateCache::readCacheEntry(header.version, file, entry)) {
+      // Older versions do not validate the render
+      // pass format when reading, so do it here
+      bool valid = !entry.shaders.cs.eq(DxvkShaderKey())
+        || DxvkStateCache::validateRenderPassFormat(entry.format);
+
+      if (valid) {
+        entries.push_back(entry);
+        stats.numEntries += 1;
+      } else {
+        stats.numInvalid += 1;
+      }
+    } else if (file) {
+      stats.numInvalid += 1;
+    }
+  }
+
+  return true;
+}
+
+
+int main(int argc, char** argv) {
+  if (argc < 3) {
+    std::cerr << "Usage: dxvk-cache-merge output.dxvk-cache input1.dxvk-cache [input2.dxvk-cache ...]" << std::endl;
+    return 1;
+  }
+
+  std::vector<CacheFileStats>       inputs;
+  std::vector<DxvkStateCacheEntry>  entries;
+
+  for (int i = 2; i < argc; i++) {
+    CacheFileStats stats;
+    stats.name = argv[i];
+
+    if (!readCacheFile(stats, entries))
+      std::cerr << stats.name << ": Failed to read cache file, skipping" << std::endl;
+
+    inputs.push_back(stats);
+  }
+
+  // Remove duplicates, keeping the first occurrence
+  // and merging the usage info of all occurrences
+  std::unordered_multimap<
+    DxvkStateCacheKey, size_t,
+    DxvkHash, DxvkEq> entryMap;
+
+  std::vector<DxvkStateCacheEntry> uniqueEntries;
+  uint32_t numDuplicates = 0;
+
+  for (const auto& entry : entries) {
+    auto range = entryMap.equal_range(entry.shaders);
+    DxvkStateCacheEntry* found = nullptr;
+
+    for (auto e = range.first; e != range.second && !found; e++) {
+      if (isSameEntry(uniqueEntries[e->second], entry))
+        found = &uniqueEntries[e->second];
+    }
+
+    if (found) {
+      found->firstUse  = std::min(found->firstUse, entry.firstUse);
+      found->useCount += entry.useCount;
+
+      numDuplicates += 1;
+      continue;
+    }
+
+    entryMap.insert({ entry.shaders, uniqueEntries.size() });
+    uniqueEntries.push_back(entry);
+  }
+
+  // Sort entries by their shaders, so that all pipelines
+  // using the same set of shaders are stored together
+  std::stable_sort(uniqueEntries.begin(), uniqueEntries.end(),
+    [] (const DxvkStateCacheEntry& a, const DxvkStateCacheEntry& b) {
+      return std::memcmp(&a.shaders, &b.shaders, sizeof(a.shaders)) < 0;
+    });
+
+  // Write the compacted file using the current version
+  std::string outputName = argv[1];
+  std::ofstream file(outputName, std::ios_base::binary | std::ios_base::trunc);
+
+  if (!file) {
+    std::cerr << outputName << ": Failed to open output file" << std::endl;
+    return 1;
+  }
+
+  DxvkStateCacheHeader header;
+  file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+  for (auto& entry : uniqueEntries)
+    DxvkStateCache::writeCacheEntry(file, entry);
+
+  file.close();
+
+  // Report statistics for each input and the output
+  size_t   totalSize    = 0;
+  uint32_t totalEntries = 0;
+  uint32_t totalInvalid = 0;
+
+  for (const auto& stats : inputs) {
+    std::cout << stats.name << ": ";
+
+    if (stats.supported) {
+      std::cout << "v" << stats.version << ", "
+                << stats.numEntries << " entries, "
+                << stats.numInvalid << " invalid, "
+                << stats.fileSize << " bytes" << std::endl;
+    } else {
+      std::cout << "not supported" << std::endl;
+    }
+
+    totalSize    += stats.fileSize;
+    totalEntries += stats.numEntries;
+    totalInvalid += stats.numInvalid;
+  }
+
+  std::cout << "Input:  " << totalEntries << " entries, "
+            << totalInvalid << " invalid, "
+            << numDuplicates << " duplicates, "
+            << totalSize << " bytes" << std::endl;
+
+  std::cout << "Output: " << uniqueEntries.size() << " entries, "
+            << getFileSize(outputName) << " bytes (v" << header.version << ")" << std::endl;
+  return 0;
+}
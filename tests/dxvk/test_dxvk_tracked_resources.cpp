@@ -0,0 +1,119 @@
+#include <random>
+#include <set>
+
+#include "../../src/dxvk/dxvk_lifetime.h"
+
+#include "../../src/util/util_time.h"
+
+#include <shellapi.h>
+#include <windows.h>
+#include <windowsx.h>
+
+namespace dxvk {
+  Logger Logger::s_instance("dxvk-tracked-resources.log");
+}
+
+using namespace dxvk;
+
+// The set never dereferences resource pointers, so
+// fake pointers with heap-like alignment will do.
+static DxvkResource* getResource(uint32_t index) {
+  return reinterpret_cast<DxvkResource*>(uintptr_t(0x10000) + uintptr_t(index) * 16);
+}
+
+
+static uint32_t runCrossCheck(
+        uint32_t                    seed,
+        uint32_t                    iterations) {
+  std::mt19937 rng(seed);
+
+  DxvkTrackedResourceSet set;
+  std::set<std::pair<DxvkResource*, DxvkAccess>> ref;
+
+  uint32_t errors = 0;
+
+  for (uint32_t i = 0; i < iterations; i++) {
+    // Occasionally clear the set like a command list reset,
+    // and vary the number of resources so that the set has
+    // to grow past its initial capacity
+    if (!(rng() % 4096)) {
+      set.clear();
+      ref.clear();
+    }
+
+    uint32_t resourceCount = 1u << (4 + rng() % 12);
+
+    DxvkResource* resource = getResource(rng() % resourceCount);
+    DxvkAccess    access   = DxvkAccess(rng() % 3);
+
+    bool expected = ref.insert({ resource, access }).second;
+    bool actual   = set.insert(resource, access);
+
+    if (expected != actual) {
+      Logger::err(str::format("Cross check: Mismatch for resource ",
+        reinterpret_cast<uintptr_t>(resource), " at iteration ", i));
+      errors += 1;
+    }
+  }
+
+  return errors;
+}
+
+
+static void runBenchmark(
+        uint32_t                    resourceCount,
+        uint32_t                    iterations) {
+  std::mt19937 rng(1);
+
+  DxvkTrackedResourceSet set;
+  std::vector<DxvkResource*> resources(iterations);
+
+  for (uint32_t i = 0; i < iterations; i++)
+    resources[i] = getResource(rng() % resourceCount);
+
+  // Emulates a command list that tracks the same small
+  // set of resources many times, e.g. across draws
+  auto t0 = high_resolution_clock::now();
+
+  uint32_t inserted = 0;
+
+  for (uint32_t i = 0; i < iterations; i++)
+    inserted += set.insert(resources[i], DxvkAccess::Read) ? 1 : 0;
+
+  auto t1 = high_resolution_clock::now();
+  auto td = std::chrono::duration_cast<std::chrono::microseconds>(t1 - t0);
+
+  Logger::info(str::format("Benchmark: ", resourceCount, " resources, ",
+    (td.count() * 1000) / iterations, " ns per insert, ",
+    inserted, " of ", iterations, " inserted"));
+}
+
+
+int WINAPI WinMain(HINSTANCE hInstance,
+                   HINSTANCE hPrevInstance,
+                   LPSTR lpCmdLine,
+                   int nCmdShow) {
+  int     argc = 0;
+  LPWSTR* argv = CommandLineToArgvW(
+    GetCommandLineW(), &argc);
+
+  uint32_t iterations = 1000000;
+
+  if (argc > 1) iterations = std::max(std::stoi(str::fromws(argv[1])), 1);
+
+  uint32_t errors = 0;
+
+  for (uint32_t seed = 1; seed <= 4; seed++)
+    errors += runCrossCheck(seed, iterations);
+
+  runBenchmark(64,    iterations);
+  runBenchmark(4096,  iterations);
+
+  if (errors) {
+    Logger::err(str::format("Tracked resource test failed with ", errors, " errors"));
+    return 1;
+  }
+
+  Logger::info("Tracked resource test passed");
+  return 0;
+}
@@ -0,0 +1,100 @@
+#include <random>
+
+#include "../../src/spirv/spirv_module.h"
+
+#include "../../src/util/util_time.h"
+
+#include <shellapi.h>
+#include <windows.h>
+#include <windowsx.h>
+
+namespace dxvk {
+  Logger Logger::s_instance("spirv-module-benchmark.log");
+}
+
+using namespace dxvk;
+
+// Emulates the type and constant declarations made by
+// the shader compilers, which mostly hit declarations
+// that already exist in the module.
+static uint32_t buildModule(std::mt19937& rng, uint32_t declCount) {
+  SpirvModule module;
+
+  uint32_t f32Type = module.defFloatType(32);
+  uint32_t i32Type = module.defIntType(32, 1);
+
+  uint32_t result = 0;
+
+  for (uint32_t i = 0; i < declCount; i++) {
+    switch (rng() % 6) {
+      case 0:
+        result += module.consti32(int32_t(rng() % 64));
+        break;
+
+      case 1:
+        result += module.constf32(float(rng() % 16));
+        break;
+
+      case 2:
+        result += module.constvec4f32(0.0f, 1.0f, float(rng() % 4), 1.0f);
+        break;
+
+      case 3:
+        result += module.defVectorType(
+          (rng() & 1) ? f32Type : i32Type, 2 + rng() % 3);
+        break;
+
+      case 4:
+        result += module.defPointerType(
+          module.defVectorType(f32Type, 4),
+          (rng() & 1) ? spv::StorageClassInput : spv::StorageClassOutput);
+        break;
+
+      case 5: {
+        // Structs with many members, e.g. I/O blocks
+        std::array<uint32_t, 12> members;
+        members.fill(module.defVectorType(f32Type, 4));
+        result += module.defStructType(2 + rng() % 10, members.data());
+      } break;
+    }
+  }
+
+  return result;
+}
+
+
+int WINAPI WinMain(HINSTANCE hInstance,
+                   HINSTANCE hPrevInstance,
+                   LPSTR lpCmdLine,
+                   int nCmdShow) {
+  int     argc = 0;
+  LPWSTR* argv = CommandLineToArgvW(
+    GetCommandLineW(), &argc);
+
+  uint32_t moduleCount = 1000;
+  uint32_t declCount   = 2000;
+
+  if (argc > 1) moduleCount = std::max(std::stoi(str::fromws(argv[1])), 1);
+  if (argc > 2) declCount   = std::max(std::stoi(str::fromws(argv[2])), 1);
+
+  std::mt19937 rng(1);
+
+  auto t0 = high_resolution_clock::now();
+
+  uint32_t result = 0;
+
+  for (uint32_t i = 0; i < moduleCount; i++)
+    result += buildModule(rng, declCount);
+
+  auto t1 = high_resolution_clock::now();
+  auto td = std::chrono::duration_cast<std::chrono::microseconds>(t1 - t0);
+
+  uint64_t declTotal = uint64_t(moduleCount) * declCount;
+
+  Logger::info(str::format(moduleCount, " modules, ",
+    declCount, " declarations each: ",
+    td.count() / 1000, " ms, ",
+    (td.count() * 1000) / declTotal, " ns per declaration",
+    " (checksum ", result, ")"));
+  return 0;
+}
@@ -0,0 +1,574 @@
+#include <array>
+#include <fstream>
+#include <iostream>
+#include <limits>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+#include "../../src/spirv/spirv_module.h"
+#include "../../src/spirv/spirv_optimizer.h"
+
+#include <shellapi.h>
+#include <windows.h>
+#include <windowsx.h>
+
+namespace dxvk {
+  Logger Logger::s_instance("spirv-optimizer.log");
+}
+
+using namespace dxvk;
+
+/**
+ * \brief Basic structural validation
+ *
+ * Checks that all result IDs are defined exactly once
+ * and within the ID bound, that all operands of common
+ * instructions are defined, and that every block ends
+ * in a terminator. This is not a replacement for
+ * spirv-val, use the dumped files for that.
+ */
+static std::string validateModule(SpirvCodeBuffer code) {
+  if (code.dwords() < 5 || code.data()[0] != spv::MagicNumber)
+    return "Invalid header";
+
+  uint32_t bound = code.data()[3];
+
+  std::unordered_set<uint32_t> defined;
+  std::vector<std::pair<uint32_t, uint32_t>> uses;
+
+  bool inBlock = false;
+
+  for (auto ins : code) {
+    spv::Op op = ins.opCode();
+
+    if (!ins.length())
+      return "Zero-length instruction";
+
+    uint32_t resultId = 0;
+    uint32_t operandStart = 0;
+    uint32_t operandEnd   = 0;
+
+    switch (op) {
+      case spv::OpTypeVoid:
+      case spv::OpTypeBool:
+      case spv::OpTypeInt:
+      case spv::OpTypeFloat:
+      case spv::OpLabel:
+      case spv::OpExtInstImport:
+        resultId = ins.arg(1);
+        break;
+
+      case spv::OpTypeVector:
+        resultId = ins.arg(1);
+        operandStart = 2;
+        operandEnd   = 3;
+        break;
+
+      case spv::OpTypePointer:
+        resultId = ins.arg(1);
+        operandStart = 3;
+        operandEnd   = 4;
+        break;
+
+      case spv::OpTypeFunction:
+      case spv::OpTypeStruct:
+      case spv::OpTypeArray:
+        resultId = ins.arg(1);
+        operandStart = 2;
+        operandEnd   = ins.length();
+        break;
+
+      case spv::OpConstant:
+      case spv::OpConstantTrue:
+      case spv::OpConstantFalse:
+      case spv::OpSpecConstant:
+      case spv::OpSpecConstantTrue:
+      case spv::OpSpecConstantFalse:
+      case spv::OpUndef:
+      case spv::OpFunctionParameter:
+        resultId = ins.arg(2);
+        operandStart = 1;
+        operandEnd   = 2;
+        break;
+
+      case spv::OpVariable:
+      case spv::OpFunction:
+        resultId = ins.arg(2);
+        uses.push_back({ ins.arg(1), ins.offset() });
+        operandStart = 4;
+        operandEnd   = ins.length();
+        break;
+
+      case spv::OpLoad:
+      case spv::OpCompositeExtract:
+        resultId = ins.arg(2);
+        uses.push_back({ ins.arg(1), ins.offset() });
+        operandStart = 3;
+        operandEnd   = 4;
+        break;
+
+      case spv::OpStore:
+        operandStart = 1;
+        operandEnd   = 3;
+        break;
+
+      case spv::OpConstantComposite:
+      case spv::OpCompositeConstruct:
+      case spv::OpIAdd:
+      case spv::OpISub:
+      case spv::OpIMul:
+      case spv::OpFAdd:
+      case spv::OpFSub:
+      case spv::OpFMul:
+      case spv::OpFDiv:
+      case spv::OpBitwiseAnd:
+      case spv::OpBitwiseOr:
+      case spv::OpBitwiseXor:
+      case spv::OpShiftLeftLogical:
+      case spv::OpShiftRightLogical:
+      case spv::OpShiftRightArithmetic:
+      case spv::OpIEqual:
+      case spv::OpINotEqual:
+      case spv::OpULessThan:
+      case spv::OpSLessThan:
+      case spv::OpFOrdLessThan:
+      case spv::OpLogicalAnd:
+      case spv::OpLogicalOr:
+      case spv::OpLogicalNot:
+      case spv::OpSelect:
+      case spv::OpFOrdGreaterThan:
+      case spv::OpBitcast:
+      case spv::OpConvertUToF:
+      case spv::OpAccessChain:
+      case spv::OpFunctionCall:
+        resultId = ins.arg(2);
+        operandStart = 1;
+        operandEnd   = ins.length();
+        break;
+
+      case spv::OpBranch:
+      case spv::OpReturnValue:
+        operandStart = 1;
+        operandEnd   = ins.length();
+        break;
+
+      case spv::OpBranchConditional:
+        operandStart = 1;
+        operandEnd   = 4;
+        break;
+
+      case spv::OpSelectionMerge:
+        operandStart = 1;
+        operandEnd   = 2;
+        break;
+
+      default:
+        break;
+    }
+
+    if (resultId) {
+      if (resultId >= bound)
+        return str::format("ID ", resultId, " exceeds bound ", bound);
+
+      if (!defined.insert(resultId).second)
+        return str::format("ID ", resultId, " defined more than once");
+    }
+
+    for (uint32_t i = operandStart; i < operandEnd && i < ins.length(); i++) {
+      if (op == spv::OpCompositeExtract && i > 3)
+        break;
+
+      uses.push_back({ ins.arg(i), ins.offset() });
+    }
+
+    // Check that blocks are properly terminated
+    if (op == spv::OpLabel) {
+      if (inBlock)
+        return str::format("Unterminated block before ", ins.arg(1));
+      inBlock = true;
+    }
+
+    if (op == spv::OpBranch
+     || op == spv::OpBranchConditional
+     || op == spv::OpSwitch
+     || op == spv::OpReturn
+     || op == spv::OpReturnValue
+     || op == spv::OpKill
+     || op == spv::OpUnreachable)
+      inBlock = false;
+
+    if (op == spv::OpFunctionEnd && inBlock)
+      return "Unterminated block at end of function";
+  }
+
+  for (const auto& use : uses) {
+    if (!defined.count(use.first) && use.first < bound) {
+      // Forward references to labels and functions are
+      // legal, those are defined by the time we get here
+      return str::format("Undefined ID ", use.first, " used at offset ", use.second);
+    }
+
+    if (use.first >= bound)
+      return str::format("Operand ", use.first, " exceeds bound ", bound);
+  }
+
+  return std::string();
+}
+
+
+static uint32_t countOps(SpirvCodeBuffer code, spv::Op op) {
+  uint32_t count = 0;
+
+  for (auto ins : code) {
+    if (ins.opCode() == op)
+      count += 1;
+  }
+
+  return count;
+}
+
+
+/**
+ * \brief Builds a small pixel shader
+ *
+ * Contains a private variable that is only read back
+ * within the same block, foldable integer and float
+ * arithmetic, a select and an extract with constant
+ * operands, and some code that is never used.
+ */
+static SpirvCodeBuffer buildTestModule() {
+  SpirvModule m;
+  m.enableCapability(spv::CapabilityShader);
+  m.setMemoryModel(spv::AddressingModelLogical, spv::MemoryModelGLSL450);
+
+  uint32_t voidType  = m.defVoidType();
+  uint32_t boolType  = m.defBoolType();
+  uint32_t uintType  = m.defIntType(32, 0);
+  uint32_t floatType = m.defFloatType(32);
+  uint32_t vec4Type  = m.defVectorType(floatType, 4);
+
+  uint32_t uintPtrPrivate  = m.defPointerType(uintType,  spv::StorageClassPrivate);
+  uint32_t floatPtrFunc    = m.defPointerType(floatType, spv::StorageClassFunction);
+  uint32_t vec4PtrOutput   = m.defPointerType(vec4Type,  spv::StorageClassOutput);
+
+  uint32_t outVar  = m.newVar(vec4PtrOutput,  spv::StorageClassOutput);
+  uint32_t privVar = m.newVar(uintPtrPrivate, spv::StorageClassPrivate);
+  m.decorateLocation(outVar, 0);
+  m.setDebugName(outVar,  "o0");
+  m.setDebugName(privVar, "r0");
+
+  uint32_t entryId = m.allocateId();
+  m.addEntryPoint(entryId, spv::ExecutionModelFragment, "main", 1, &outVar);
+  m.setExecutionMode(entryId, spv::ExecutionModeOriginUpperLeft);
+
+  m.functionBegin(voidType, entryId, m.defFunctionType(voidType, 0, nullptr), spv::FunctionControlMaskNone);
+  m.opLabel(m.allocateId());
+
+  uint32_t funcVar = m.newVar(floatPtrFunc, spv::StorageClassFunction);
+  uint32_t deadVar = m.newVar(floatPtrFunc, spv::StorageClassFunction);
+  m.setDebugName(deadVar, "dead");
+
+  // r0 = 3 + 4; r1 = r0 * 2
+  m.opStore(privVar, m.opIAdd(uintType, m.constu32(3), m.constu32(4)));
+  uint32_t r0 = m.opLoad(uintType, privVar);
+  uint32_t r1 = m.opIMul(uintType, r0, m.constu32(2));
+  m.opStore(privVar, r1);
+
+  // Float math and a select on a constant condition
+  uint32_t f0 = m.opFAdd(floatType, m.constf32(1.5f), m.constf32(2.0f));
+  m.opStore(funcVar, f0);
+
+  uint32_t sel = m.opSelect(floatType,
+    m.opULessThan(boolType, m.opLoad(uintType, privVar), m.constu32(16)),
+    m.opLoad(floatType, funcVar), m.constf32(0.0f));
+
+  // Extract from a constant vector
+  uint32_t vec = m.constvec4f32(1.0f, 2.0f, 3.0f, 4.0f);
+  uint32_t idx = 2;
+  uint32_t ext = m.opCompositeExtract(floatType, vec, 1, &idx);
+
+  // Unused code and a store to a variable that is never read
+  m.opFMul(floatType, sel, ext);
+  m.opStore(deadVar, ext);
+
+  std::array<uint32_t, 4> components = { sel, ext, sel, ext };
+  m.opStore(outVar, m.opCompositeConstruct(vec4Type, components.size(), components.data()));
+
+  m.opReturn();
+  m.functionEnd();
+  return m.compile();
+}
+
+
+/**
+ * \brief Builds a shader with control flow
+ *
+ * Stores a value to a function variable in a
+ * conditional block and loads it in the merge
+ * block, which must not be forwarded.
+ */
+static SpirvCodeBuffer buildBlockModule() {
+  SpirvModule m;
+  m.enableCapability(spv::CapabilityShader);
+  m.setMemoryModel(spv::AddressingModelLogical, spv::MemoryModelGLSL450);
+
+  uint32_t voidType  = m.defVoidType();
+  uint32_t boolType  = m.defBoolType();
+  uint32_t uintType  = m.defIntType(32, 0);
+  uint32_t floatType = m.defFloatType(32);
+  uint32_t vec4Type  = m.defVectorType(floatType, 4);
+
+  uint32_t floatPtrInput = m.defPointerType(floatType, spv::StorageClassInput);
+  uint32_t floatPtrFunc  = m.defPointerType(floatType, spv::StorageClassFunction);
+  uint32_t vec4PtrOutput = m.defPointerType(vec4Type,  spv::StorageClassOutput);
+
+  uint32_t inVar  = m.newVar(floatPtrInput, spv::StorageClassInput);
+  uint32_t outVar = m.newVar(vec4PtrOutput, spv::StorageClassOutput);
+  m.decorateLocation(inVar,  0);
+  m.decorateLocation(outVar, 0);
+
+  std::array<uint32_t, 2> interfaces = { inVar, outVar };
+
+  uint32_t entryId = m.allocateId();
+  m.addEntryPoint(entryId, spv::ExecutionModelFragment, "main", interfaces.size(), interfaces.data());
+  m.setExecutionMode(entryId, spv::ExecutionModeOriginUpperLeft);
+
+  m.functionBegin(voidType, entryId, m.defFunctionType(voidType, 0, nullptr), spv::FunctionControlMaskNone);
+  m.opLabel(m.allocateId());
+
+  uint32_t funcVar = m.newVar(floatPtrFunc, spv::StorageClassFunction);
+  m.opStore(funcVar, m.constf32(0.0f));
+
+  uint32_t cond = m.opFOrdGreaterThan(boolType,
+    m.opLoad(floatType, inVar), m.constf32(0.5f));
+
+  uint32_t trueLabel  = m.allocateId();
+  uint32_t mergeLabel = m.allocateId();
+
+  m.opSelectionMerge(mergeLabel, spv::SelectionControlMaskNone);
+  m.opBranchConditional(cond, trueLabel, mergeLabel);
+
+  // The store in this block must not be
+  // forwarded to the load in the merge block
+  m.opLabel(trueLabel);
+  m.opStore(funcVar, m.opConvertUtoF(floatType,
+    m.opIAdd(uintType, m.constu32(1), m.constu32(2))));
+  m.opBranch(mergeLabel);
+
+  m.opLabel(mergeLabel);
+  uint32_t value = m.opLoad(floatType, funcVar);
+
+  std::array<uint32_t, 4> components = { value, value, value, value };
+  m.opStore(outVar, m.opCompositeConstruct(vec4Type, components.size(), components.data()));
+
+  m.opReturn();
+  m.functionEnd();
+  return m.compile();
+}
+
+
+/**
+ * \brief Builds a shader using 16-bit integers
+ *
+ * The constant arithmetic must not be folded
+ * since the optimizer only handles 32-bit types.
+ */
+static SpirvCodeBuffer buildInt16Module() {
+  SpirvModule m;
+  m.enableCapability(spv::CapabilityShader);
+  m.enableCapability(spv::CapabilityInt16);
+  m.setMemoryModel(spv::AddressingModelLogical, spv::MemoryModelGLSL450);
+
+  uint32_t voidType   = m.defVoidType();
+  uint32_t ushortType = m.defIntType(16, 0);
+  uint32_t floatType  = m.defFloatType(32);
+  uint32_t vec4Type   = m.defVectorType(floatType, 4);
+
+  uint32_t vec4PtrOutput = m.defPointerType(vec4Type, spv::StorageClassOutput);
+
+  uint32_t outVar = m.newVar(vec4PtrOutput, spv::StorageClassOutput);
+  m.decorateLocation(outVar, 0);
+
+  uint32_t entryId = m.allocateId();
+  m.addEntryPoint(entryId, spv::ExecutionModelFragment, "main", 1, &outVar);
+  m.setExecutionMode(entryId, spv::ExecutionModeOriginUpperLeft);
+
+  // There are no helpers for 16-bit constants
+  uint32_t a = m.lateConst32(ushortType);
+  uint32_t b = m.lateConst32(ushortType);
+
+  uint32_t aValue = 0xFFFF;
+  uint32_t bValue = 0x0001;
+
+  m.setLateConst(a, &aValue);
+  m.setLateConst(b, &bValue);
+
+  m.functionBegin(voidType, entryId, m.defFunctionType(voidType, 0, nullptr), spv::FunctionControlMaskNone);
+  m.opLabel(m.allocateId());
+
+  uint32_t value = m.opConvertUtoF(floatType, m.opIAdd(ushortType, a, b));
+
+  std::array<uint32_t, 4> components = { value, value, value, value };
+  m.opStore(outVar, m.opCompositeConstruct(vec4Type, components.size(), components.data()));
+
+  m.opReturn();
+  m.functionEnd();
+  return m.compile();
+}
+
+
+static bool runTest(
+  const std::string&      name,
+  const std::string&      outputPath,
+  const SpirvCodeBuffer&  input,
+        SpirvCodeBuffer&  output) {
+  std::string error = validateModule(input);
+
+  if (!error.empty()) {
+    Logger::err(str::format(name, ": Input invalid: ", error));
+    return false;
+  }
+
+  SpirvOptimizer optimizer(input);
+  optimizer.run();
+
+  output = optimizer.getCode();
+  SpirvOptimizerStats stats = optimizer.getStats();
+
+  error = validateModule(output);
+
+  if (!error.empty()) {
+    Logger::err(str::format(name, ": Output invalid: ", error));
+    return false;
+  }
+
+  if (stats.dwordsAfter != output.dwords()) {
+    Logger::err(str::format(name, ": Size mismatch: ", stats.dwordsAfter, " vs ", output.dwords()));
+    return false;
+  }
+
+  Logger::info(str::format(name, ": ",
+    stats.dwordsBefore, " -> ", stats.dwordsAfter, " dwords, ",
+    stats.instructionsBefore, " -> ", stats.instructionsAfter, " instructions"));
+
+  std::ofstream ofile(outputPath, std::ios::binary);
+  output.store(ofile);
+  return true;
+}
+
+
+struct ExpectedOpCount {
+  spv::Op  op;
+  uint32_t count;
+};
+
+
+struct BuiltinTest {
+  const char*                   name;
+  SpirvCodeBuffer             (*build)();
+  std::vector<ExpectedOpCount>  expected;
+};
+
+
+static bool runBuiltinTests(const std::string& outputDir) {
+  const std::array<BuiltinTest, 3> tests = {{
+    // Everything except the output store and the
+    // composite construct should have been folded
+    { "builtin", &buildTestModule, {
+      { spv::OpLoad,               0 },
+      { spv::OpIAdd,               0 },
+      { spv::OpIMul,               0 },
+      { spv::OpFAdd,               0 },
+      { spv::OpFMul,               0 },
+      { spv::OpSelect,             0 },
+      { spv::OpCompositeExtract,   0 },
+      { spv::OpVariable,           1 },
+      { spv::OpStore,              1 },
+    }},
+
+    // Constants get folded in any block, but loads
+    // are only forwarded within the same block
+    { "blocks", &buildBlockModule, {
+      { spv::OpLoad,               2 },
+      { spv::OpIAdd,               0 },
+      { spv::OpStore,              3 },
+      { spv::OpBranchConditional,  1 },
+    }},
+
+    { "int16", &buildInt16Module, {
+      { spv::OpIAdd,               1 },
+      { spv::OpConvertUToF,        1 },
+    }},
+  }};
+
+  bool success = true;
+
+  for (const auto& test : tests) {
+    std::string outputPath = str::format(test.name, ".opt.spv");
+
+    if (!outputDir.empty())
+      outputPath = str::format(outputDir, "/", outputPath);
+
+    SpirvCodeBuffer output;
+
+    if (!runTest(test.name, outputPath, test.build(), output)) {
+      success = false;
+      continue;
+    }
+
+    for (const auto& e : test.expected) {
+      uint32_t count = countOps(output, e.op);
+
+      if (count != e.count) {
+        Logger::err(str::format(test.name, ": Expected ", e.count, " instances of op ", uint32_t(e.op), ", got ", count));
+        success = false;
+      }
+    }
+  }
+
+  return success;
+}
+
+
+int WINAPI WinMain(HINSTANCE hInstance,
+                   HINSTANCE hPrevInstance,
+                   LPSTR lpCmdLine,
+                   int nCmdShow) {
+  int     argc = 0;
+  LPWSTR* argv = CommandLineToArgvW(
+    GetCommandLineW(), &argc);
+
+  std::string outputDir;
+  std::vector<std::string> fileNames;
+
+  for (int i = 1; i < argc; i++) {
+    std::string arg = str::fromws(argv[i]);
+
+    if (arg == "--output-dir" && i + 1 < argc)
+      outputDir = str::fromws(argv[++i]);
+    else
+      fileNames.push_back(arg);
+  }
+
+  bool success = runBuiltinTests(outputDir);
+
+  // Optimize any additional modules passed on the command line
+  // and write the results to <file>.opt.spv for spirv-val
+  for (const auto& fileName : fileNames) {
+    std::ifstream ifile(fileName, std::ios::binary);
+
+    if (!ifile) {
+      Logger::err(str::format("Failed to open ", fileName));
+      success = false;
+      continue;
+    }
+
+    SpirvCodeBuffer code(ifile);
+    SpirvCodeBuffer output;
+    success &= runTest(fileName, fileName + ".opt.spv", code, output);
+  }
+
+  Logger::info(success ? "All tests passed" : "Some tests failed");
+  return success ? 0 : 1;
+}